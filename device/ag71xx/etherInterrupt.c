@@ -21,21 +21,29 @@ extern int resdefer;
 /**
  * @ingroup etherspecific
  *
- * Receive packet interrupt handler.
+ * Move received packets from the Rx ring to the input queue.
+ *
+ * @param ethptr
+ *      Ethernet control block
+ * @param nicptr
+ *      device registers
+ * @param budget
+ *      maximum number of packets to take
+ * @return number of packets taken off the ring
  */
-void rxPackets(struct ether *ethptr, struct ag71xx *nicptr)
+int rxPackets(struct ether *ethptr, struct ag71xx *nicptr, int budget)
 {
     struct dmaDescriptor *dmaptr;
     struct ethPktBuffer *pkt = NULL;
     int head = 0;
+    int count = 0;
 
-    while (1)
+    while (count < budget)
     {
         head = ethptr->rxHead % ETH_RX_RING_ENTRIES;
         dmaptr = &ethptr->rxRing[head];
         if (dmaptr->control & ETH_DESC_CTRL_EMPTY)
         {
-            nicptr->rxStatus = RX_STAT_RECVD;
             break;
         }
 
@@ -57,10 +65,31 @@ void rxPackets(struct ether *ethptr, struct ag71xx *nicptr)
         }
 
         ethptr->rxHead++;
+        count++;
         // Clear Rx interrupt.
         nicptr->rxStatus = RX_STAT_RECVD;
-        // FIXME
-        break;
+    }
+
+    return count;
+}
+
+/* Implementation of etherPoll() for the ag71xx; see the documentation for this
+ * function in ether.h.  */
+void etherPoll(struct ether *ethptr)
+{
+    struct ag71xx *nicptr = ethptr->csr;
+
+    ethptr->rxpolls++;
+    if (rxPackets(ethptr, nicptr, ETH_RX_BUDGET) < ETH_RX_BUDGET)
+    {
+        /* Ring is drained, go back to Rx interrupts */
+        ethptr->rxpoll = FALSE;
+        ethptr->interruptMask |= IRQ_RX_PKTRECV;
+        nicptr->interruptMask = ethptr->interruptMask;
+    }
+    else
+    {
+        ethptr->rxbudget++;
     }
 }
 
@@ -154,7 +183,11 @@ interrupt etherInterrupt(void)
     if (status & IRQ_RX_PKTRECV)
     {
         ethptr->rxirq++;
-        rxPackets(ethptr, nicptr);
+        /* Mask Rx interrupts and poll the ring until it drains */
+        ethptr->rxpoll = TRUE;
+        ethptr->interruptMask &= ~IRQ_RX_PKTRECV;
+        nicptr->interruptMask = ethptr->interruptMask;
+        etherPoll(ethptr);
     }
 
     if (status & IRQ_RX_OVERFLOW)
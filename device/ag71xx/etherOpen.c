@@ -93,6 +93,7 @@ devcall etherOpen(device *devptr)
     nicptr->rxControl = RX_CTRL_RXE;
 
     ethptr->state = ETH_STATE_UP;
+    ethptr->rxpoll = FALSE;
     /* enable interrupts */
     nicptr->interruptMask = ethptr->interruptMask;
 
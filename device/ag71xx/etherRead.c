@@ -43,6 +43,13 @@ devcall etherRead(device *devptr, void *buf, uint len)
         return SYSERR;
     }
 
+    /* Under load Rx interrupts are masked, so take more packets off the
+     * ring before waiting */
+    while ((0 == ethptr->icount) && ethptr->rxpoll)
+    {
+        etherPoll(ethptr);
+    }
+
     wait(ethptr->isema);
 
     pkt = ethptr->in[ethptr->istart];
@@ -175,6 +175,9 @@ void etherStat(ushort minor)
     fprintf(stdout, "  Rx Control   0x%08X", nicptr->rxControl);
     fprintf(stdout, "  Rx DMA       0x%08X", nicptr->rxDMA);
     fprintf(stdout, "  Rx Status    0x%08X\n", nicptr->rxStatus);
+    fprintf(stdout, "  Rx Polls       %8lu", ethptr->rxpolls);
+    fprintf(stdout, "  Rx Budget Hit  %8lu", ethptr->rxbudget);
+    fprintf(stdout, "  Rx Polling     %8s\n", ethptr->rxpoll ? "YES" : "NO");
 
     fprintf(stdout, "\n");
 }
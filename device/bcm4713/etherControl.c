@@ -179,6 +179,10 @@ devcall etherControl(device *devptr, int func, long arg1, long arg2)
     case NET_GET_MTU:
         return ETH_MTU;
 
+/* Gather write of a frame given as segments. */
+    case NET_SEND_SG:
+        return etherWritev(devptr, (const struct netseg *)arg1, arg2);
+
     default:
         return SYSERR;
     }
@@ -20,9 +20,21 @@ extern int resdefer;
 
 /**
  * @ingroup etherspecific
+ *
+ * Move received packets from the Rx ring to the input queues of the
+ * physical device and its vlans.
+ *
+ * @param ethptr
+ *      Ethernet control block of the physical device
+ * @param nicptr
+ *      device registers
+ * @param budget
+ *      maximum number of packets to take
+ * @return number of packets taken off the ring
  */
-void rxPackets(struct ether *ethptr, struct bcm4713 *nicptr)
+int rxPackets(struct ether *ethptr, struct bcm4713 *nicptr, int budget)
 {
+    int count = 0;
     ulong head = 0, tail = 0;
     struct ethPktBuffer *pkt = NULL;
     struct rxHeader *rh = NULL;
@@ -36,7 +48,7 @@ void rxPackets(struct ether *ethptr, struct bcm4713 *nicptr)
     /* rxHead indicates where we last left off pulling received      */
     /*  packets off of the ring.                                     */
     head = ethptr->rxHead;
-    while (head != tail)
+    while ((head != tail) && (count < budget))
     {
         pkt = ethptr->rxBufs[head];
         rh = (struct rxHeader *)pkt->buf;
@@ -77,8 +89,34 @@ void rxPackets(struct ether *ethptr, struct bcm4713 *nicptr)
         ethptr->rxTail = (ethptr->rxTail + 1) % ethptr->rxRingSize;
         nicptr->dmaRxLast = ethptr->rxTail * sizeof(struct dmaDescriptor);
         head = (head + 1) % ethptr->rxRingSize;
+        count++;
     }
     ethptr->rxHead = head;
+
+    return count;
+}
+
+/* Implementation of etherPoll() for the bcm4713; see the documentation for
+ * this function in ether.h.  */
+void etherPoll(struct ether *ethptr)
+{
+    struct bcm4713 *nicptr = ethptr->csr;
+
+    /* Acknowledge Rx first, so a packet that arrives after the ring is read
+     * raises an interrupt once Rx interrupts are unmasked */
+    nicptr->interruptStatus = ISTAT_RX;
+    ethptr->rxpolls++;
+    if (rxPackets(ethptr, nicptr, ETH_RX_BUDGET) < ETH_RX_BUDGET)
+    {
+        /* Ring is drained, go back to Rx interrupts */
+        ethptr->rxpoll = FALSE;
+        ethptr->interruptMask |= ISTAT_RX;
+        nicptr->interruptMask = ethptr->interruptMask;
+    }
+    else
+    {
+        ethptr->rxbudget++;
+    }
 }
 
 /**
@@ -157,7 +195,11 @@ interrupt etherInterrupt(void)
     if (status & ISTAT_RX)
     {
         ethptr->rxirq++;
-        rxPackets(ethptr, nicptr);
+        /* Mask Rx interrupts and poll the ring until it drains */
+        ethptr->rxpoll = TRUE;
+        ethptr->interruptMask &= ~ISTAT_RX;
+        nicptr->interruptMask = ethptr->interruptMask;
+        etherPoll(ethptr);
         /* Set Rx timeout to 0 */
         nicptr->gpTimer = 0;
     }
@@ -177,8 +219,9 @@ interrupt etherInterrupt(void)
         }
     }
 
-    /* signal the card with the interrupts we handled */
-    nicptr->interruptStatus = status;
+    /* signal the card with the interrupts we handled; etherPoll() has
+     * already acknowledged Rx */
+    nicptr->interruptStatus = status & ~ISTAT_RX;
 
     if (--resdefer > 0)
     {
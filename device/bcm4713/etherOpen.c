@@ -92,6 +92,7 @@ devcall etherOpen(device *devptr)
     nicptr->enetControl |= ENET_CTRL_ENABLE;
 
     ethptr->state = ETH_STATE_UP;
+    ethptr->rxpoll = FALSE;
     nicptr->interruptMask = ethptr->interruptMask;
 
     restore(im);
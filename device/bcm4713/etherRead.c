@@ -21,6 +21,7 @@ devcall etherRead(device *devptr, void *buf, uint len)
 {
     irqmask im;
     struct ether *ethptr;
+    struct ether *phyptr;
     struct ethPktBuffer *pkt;
     struct rxHeader *rh;
     struct vlanPkt *lanptr;
@@ -43,6 +44,14 @@ devcall etherRead(device *devptr, void *buf, uint len)
         return SYSERR;
     }
 
+    /* Under load Rx interrupts are masked, so take more packets off the
+     * physical device's ring before waiting */
+    phyptr = &ethertab[ethptr->phy->minor];
+    while ((0 == ethptr->icount) && phyptr->rxpoll)
+    {
+        etherPoll(phyptr);
+    }
+
     wait(ethptr->isema);
 
     pkt = ethptr->in[ethptr->istart];
@@ -208,6 +208,9 @@ void etherStat(ushort minor)
     printf("  Rx Alignment   %8u", nicptr->rxAlign);
     printf("  Rx Symbol Err  %8u", nicptr->rxSymbol);
     printf("  Rx Pause       %8u\n", nicptr->rxPause);
+    printf("  Rx Polls       %8lu", ethptr->rxpolls);
+    printf("  Rx Budget Hit  %8lu", ethptr->rxbudget);
+    printf("  Rx Polling     %8s\n", ethptr->rxpoll ? "YES" : "NO");
     printf("  Rx Non-Pause   %8u", nicptr->rxNonPause);
 
     tmp = nicptr->dmaRxLast / sizeof(struct dmaDescriptor);
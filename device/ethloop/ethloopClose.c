@@ -31,6 +31,15 @@ devcall ethloopClose(device *devptr)
         return SYSERR;
     }
 
+    /* free any packets still waiting to be read */
+    while (elpptr->count > 0)
+    {
+        netFreebuf(elpptr->buffer[elpptr->index]);
+        elpptr->buffer[elpptr->index] = NULL;
+        elpptr->index = (elpptr->index + 1) % ELOOP_NBUF;
+        elpptr->count--;
+    }
+
     /* free the semaphores */
     semfree(elpptr->sem);
     semfree(elpptr->hsem);
@@ -32,6 +32,9 @@ devcall ethloopControl(device *devptr, int func, long arg1, long arg2)
     char *buf;
     char *hold;
     int holdlen;
+    struct packet *pkt;
+    struct packet **pkts;
+    int n;
 
     elpptr = &elooptab[devptr->minor];
 
@@ -82,6 +85,58 @@ devcall ethloopControl(device *devptr, int func, long arg1, long arg2)
         restore(im);
         return ELOOP_MTU;
 
+/* Hand the next received packet to the caller without copying it. */
+    case NET_RECV_PKT:
+        if (elpptr->flags & ELOOP_FLAG_RXREAD)
+        {
+            restore(im);
+            return SYSERR;
+        }
+        /* Wait until the buffer has a packet */
+        wait(elpptr->sem);
+        pkt = elpptr->buffer[elpptr->index];
+        elpptr->buffer[elpptr->index] = NULL;
+        elpptr->pktlen[elpptr->index] = 0;
+        elpptr->count--;
+        elpptr->index = (elpptr->index + 1) % ELOOP_NBUF;
+        restore(im);
+        *((struct packet **)arg1) = pkt;
+        return pkt->len;
+
+/* Hand up every queued packet, up to arg2, without copying them. */
+    case NET_RECV_BURST:
+        if ((arg2 < 1) || (elpptr->flags & ELOOP_FLAG_RXREAD))
+        {
+            restore(im);
+            return SYSERR;
+        }
+        pkts = (struct packet **)arg1;
+        /* Wait until the buffer has a packet, then take the rest of the
+         * queue without waiting again */
+        wait(elpptr->sem);
+        n = 0;
+        while (TRUE)
+        {
+            pkts[n++] = elpptr->buffer[elpptr->index];
+            elpptr->buffer[elpptr->index] = NULL;
+            elpptr->pktlen[elpptr->index] = 0;
+            elpptr->count--;
+            elpptr->index = (elpptr->index + 1) % ELOOP_NBUF;
+            if ((n >= arg2) || (semcount(elpptr->sem) < 1))
+            {
+                break;
+            }
+            /* Another packet is queued, so this does not block */
+            wait(elpptr->sem);
+        }
+        restore(im);
+        return n;
+
+/* Gather write of a frame given as segments. */
+    case NET_SEND_SG:
+        restore(im);
+        return ethloopWritev(devptr, (const struct netseg *)arg1, arg2);
+
 /* Get next packet off hold queue */
     case ELOOP_CTRL_GETHOLD:
         buf = (char *)arg1;
@@ -3,10 +3,10 @@
  */
 /* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
 
-#include <bufpool.h>
 #include <device.h>
 #include <ethloop.h>
 #include <interrupt.h>
+#include <network.h>
 #include <stddef.h>
 #include <string.h>
 
@@ -33,7 +33,7 @@ devcall ethloopRead(device *devptr, void *buf, uint len)
 {
     struct ethloop *elpptr;
     irqmask im;
-    char *pkt;
+    struct packet *pkt;
     int pktlen;
 
     elpptr = &elooptab[devptr->minor];
@@ -61,8 +61,8 @@ devcall ethloopRead(device *devptr, void *buf, uint len)
         pktlen = len;
     }
 
-    memcpy(buf, pkt, pktlen);
-    buffree(pkt);
+    memcpy(buf, pkt->data, pktlen);
+    netFreebuf(pkt);
 
     return pktlen;
 }
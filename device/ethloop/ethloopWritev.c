@@ -0,0 +1,153 @@
+/**
+ * @file     ethloopWritev.c
+ */
+/* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
+
+#include <bufpool.h>
+#include <device.h>
+#include <ethloop.h>
+#include <interrupt.h>
+#include <network.h>
+#include <stddef.h>
+#include <string.h>
+
+static void ethloopGather(void *, const struct netseg *, uint);
+
+/**
+ * @ingroup ethloop
+ *
+ * Write a frame given as a list of segments to an Ethernet Loopback device.
+ * The segments are copied before this function returns.  On success, the
+ * frame will be available to be read by a subsequent call to ethloopRead().
+ *
+ * @param devptr
+ *      Pointer to the device table entry for the ethloop.
+ *
+ * @param segs
+ *      Segments of the frame, in order.
+ *
+ * @param nsegs
+ *      Number of segments in @p segs.
+ *
+ * @return
+ *      On success, returns the number of bytes written, which will be the
+ *      total length of the segments.  On failure, returns SYSERR.
+ */
+devcall ethloopWritev(device *devptr, const struct netseg *segs, uint nsegs)
+{
+    struct ethloop *elpptr;
+    irqmask im;
+    int index;
+    struct packet *pkt;
+    char *hold;
+    uint len = 0;
+    uint i;
+
+    elpptr = &elooptab[devptr->minor];
+
+    for (i = 0; i < nsegs; i++)
+    {
+        len += segs[i].len;
+    }
+
+    /* Make sure the packet isn't too small or too large  */
+    if ((len < ELOOP_LINKHDRSIZE) || (len > ELOOP_BUFSIZE))
+    {
+        return SYSERR;
+    }
+
+    im = disable();
+
+    /* Make sure the ethloop is actually open  */
+    if (ELOOP_STATE_ALLOC != elpptr->state)
+    {
+        restore(im);
+        return SYSERR;
+    }
+
+    /* Drop packet if drop flags(s) are set */
+    if (elpptr->flags & (ELOOP_FLAG_DROPNXT | ELOOP_FLAG_DROPALL))
+    {
+        elpptr->flags &= ~ELOOP_FLAG_DROPNXT;
+        restore(im);
+        return len;
+    }
+
+    /* Hold next packet if the appropriate flag is set */
+    if (elpptr->flags & ELOOP_FLAG_HOLDNXT)
+    {
+        /* Allocate buffer space.  This is blocking, so it can only fail if
+         * the pool ID was corrupted.  */
+        hold = (char *)bufget(elpptr->poolid);
+        if (SYSERR == (int)hold)
+        {
+            restore(im);
+            return SYSERR;
+        }
+
+        /* Copy supplied segments into allocated buffer */
+        ethloopGather(hold, segs, nsegs);
+
+        elpptr->flags &= ~ELOOP_FLAG_HOLDNXT;
+        if (elpptr->hold != NULL)
+        {
+            buffree(elpptr->hold);
+        }
+        elpptr->hold = hold;
+        elpptr->holdlen = len;
+        restore(im);
+        signal(elpptr->hsem);
+        return len;
+    }
+
+    /* Copy the frame straight into a network packet buffer, so the reader can
+     * take it with NET_RECV_PKT without copying it again.  This is blocking,
+     * so it can only fail if the pool ID was corrupted.  */
+    pkt = netGetbuf();
+    if (SYSERR == (int)pkt)
+    {
+        restore(im);
+        return SYSERR;
+    }
+    ethloopGather(pkt->data, segs, nsegs);
+    pkt->len = len;
+    pkt->linkhdr = pkt->data;
+    pkt->curr = pkt->data;
+
+    /* Ensure there is room in the input queue */
+    if (elpptr->count >= ELOOP_NBUF)
+    {
+        netFreebuf(pkt);
+        restore(im);
+        return SYSERR;
+    }
+
+    index = (elpptr->count + elpptr->index) % ELOOP_NBUF;
+
+    /* Add to buffer */
+    elpptr->buffer[index] = pkt;
+    elpptr->pktlen[index] = len;
+    elpptr->count++;
+
+    /* Increment count of packets written */
+    elpptr->nout++;
+
+    restore(im);
+
+    signal(elpptr->sem);
+
+    return len;
+}
+
+/* Copy segments one after another into a buffer. */
+static void ethloopGather(void *buf, const struct netseg *segs, uint nsegs)
+{
+    uchar *dst = buf;
+    uint i;
+
+    for (i = 0; i < nsegs; i++)
+    {
+        memcpy(dst, segs[i].data, segs[i].len);
+        dst += segs[i].len;
+    }
+}
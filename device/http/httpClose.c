@@ -31,7 +31,12 @@ devcall httpClose(device *devptr)
     }
 
     httpFree(devptr);
-    semfree(webptr->closeall);
+
+    /* Only an opened device has a close semaphore */
+    if (NULL != webptr->phw)
+    {
+        semfree(webptr->closeall);
+    }
 
     /* Free memory associated with device malloc calls if necessary */
     if (NULL != webptr->content)
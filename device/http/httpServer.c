@@ -18,7 +18,8 @@ thread killHttpServer(uint, tid_typ, uint);
 thread httpServer(int, int);
 
 /**
- * HTTP server kick start thread
+ * HTTP server kick start thread.  Opens the listening TCP device, whose
+ * backlog holds connections arriving while every server thread is busy.
  * @return OK or SYSERR
  */
 thread httpServerKickStart(int netDescrp)
@@ -27,6 +28,7 @@ thread httpServerKickStart(int netDescrp)
     char thrname[TNMLEN];
     int tid;
     int cursem;
+    struct netif *nif;
 
     cursem = activeXWeb;
     /* Only one active web server at a time */
@@ -37,6 +39,16 @@ thread httpServerKickStart(int netDescrp)
         return SYSERR;
     }
 
+    /* Look up the network descriptor */
+    nif = netLookup(netDescrp);
+    if (SYSERR == (int)nif)
+    {
+        fprintf(stderr, "%s is not associated with an active network",
+                devtab[netDescrp].name);
+        fprintf(stderr, " interface.\n");
+        return SYSERR;
+    }
+
     /* Allocate TCP device */
     tcpdev = tcpAlloc();
     if (isbadtcp(tcpdev))
@@ -45,6 +57,17 @@ thread httpServerKickStart(int netDescrp)
         return SYSERR;
     }
 
+    /* Listen, returning at once since there is a backlog */
+    if ((SYSERR == control(tcpdev, TCP_CTRL_BACKLOG, HTTP_BACKLOG, 0))
+        || (SYSERR == (long)open(tcpdev, &nif->ip, NULL, HTTP_LOCAL_PORT,
+                                 NULL, TCP_PASSIVE)))
+    {
+        fprintf(stderr, "tcpOpen SYSERR, devnum: %d\n", tcpdev);
+        close(tcpdev);
+        return SYSERR;
+    }
+    httplisten = tcpdev;
+
     sprintf(thrname, "XWeb_%d", (devtab[tcpdev].minor));
     tid = create((void *)httpServer, INITSTK, INITPRIO, thrname,
                  2, netDescrp, tcpdev);
@@ -55,17 +78,15 @@ thread httpServerKickStart(int netDescrp)
 
 /**
  * HTTP server thread
- * @param host IP address of interface on which to listen
- * @param gentcpdev the allocated tcp device for general listening
+ * @param netDescrp network interface on which the server listens
+ * @param listendev the listening tcp device to accept connections from
  * @return OK or SYSERR
  */
-thread httpServer(int netDescrp, int gentcpdev)
+thread httpServer(int netDescrp, int listendev)
 {
     tid_typ shelltid, killtid;
     int tcpdev, httpdev;
     char thrname[TNMLEN];
-    struct netaddr *host;
-    struct netif *nif;
 
     wait(maxhttp);              /* Make sure max HTTP threads not reached */
 
@@ -80,19 +101,19 @@ thread httpServer(int netDescrp, int gentcpdev)
         return SYSERR;
     }
 
-    /* Back up the general tcpdev number */
-    tcpdev = gentcpdev;
-
-    /* Look up the network descriptor */
-    nif = netLookup(netDescrp);
-    if (SYSERR == (int)nif)
+    /* Wait for a connection */
+    tcpdev = control(listendev, TCP_CTRL_ACCEPT, 0, 0);
+    if (isbadtcp(tcpdev))
     {
-        fprintf(stderr, "%s is not associated with an active network",
-                devtab[netDescrp].name);
-        fprintf(stderr, " interface.\n");
+        /* Device was never opened, only release it */
+        httpFree((device *)&devtab[httpdev]);
         return SYSERR;
     }
-    host = &(nif->ip);
+
+    /* Spawn the thread that accepts the next connection */
+    sprintf(thrname, "XWeb_%d", (devtab[listendev].minor));
+    ready(create((void *)httpServer, INITSTK, INITPRIO, thrname,
+                 2, netDescrp, listendev), RESCHED_NO);
 
     /* Open HTTP device */
     if (SYSERR == (long)open(httpdev, tcpdev))
@@ -124,59 +145,6 @@ thread httpServer(int netDescrp, int gentcpdev)
     ready(shelltid, RESCHED_NO);
     ready(killtid, RESCHED_NO);
 
-    /* Open TCP device */
-    if (SYSERR ==
-        (long)open(tcpdev, host, NULL, HTTP_LOCAL_PORT, NULL,
-                   TCP_PASSIVE))
-    {
-        int temp;
-        sleep(TCP_TWOMSL + 500);
-        if (SYSERR ==
-            (temp = (long)open(tcpdev, host, NULL, HTTP_LOCAL_PORT, NULL,
-                               TCP_PASSIVE)))
-        {
-            fprintf(CONSOLE, "open returns: %d\n", temp);
-            fprintf(stderr, "tcpOpen SYSERR, devnum: %d\n", tcpdev);
-            kill(shelltid);
-            close(tcpdev);
-            close(httpdev);
-            return SYSERR;
-        }
-        fprintf(CONSOLE, "open returns: %d\n", temp);
-    }
-
-    /* Allocate TCP device */
-    gentcpdev = tcpAlloc();
-    if (isbadtcp(gentcpdev))
-    {
-        /* Wait for a free http device */
-        wait(maxhttp);
-
-        /* Acquire a TCP device through allocation */
-        while ((ushort)SYSERR == (gentcpdev = tcpAlloc()))
-        {
-            /* Do nothing, yield processor */
-            yield();
-        }
-
-        /* Everything acquired, spawn general http device listener */
-        if (semcount(activeXWeb) <= 0)
-        {
-            sprintf(thrname, "XWeb_%d", (devtab[gentcpdev].minor));
-            ready(create((void *)httpServer, INITSTK, INITPRIO,
-                         thrname, 2, netDescrp, gentcpdev), RESCHED_NO);
-        }
-
-        /* Did not consume http device, just waited for availability */
-        signal(maxhttp);
-    }
-    else
-    {
-        sprintf(thrname, "XWeb_%d", (devtab[gentcpdev].minor));
-        ready(create((void *)httpServer, INITSTK, INITPRIO,
-                     thrname, 2, netDescrp, gentcpdev), RESCHED_NO);
-    }
-
     return OK;
 }
 
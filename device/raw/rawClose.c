@@ -46,6 +46,7 @@ devcall rawClose(device *devptr)
         rawptr->icount--;
     }
 
+    bpfFree(&rawptr->filter);
     bzero(rawptr, sizeof(struct raw));  /* Clear RAW structure.         */
     restore(im);
     return OK;
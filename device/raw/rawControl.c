@@ -8,6 +8,8 @@
 #include <device.h>
 #include <raw.h>
 #include <interrupt.h>
+#include <memory.h>
+#include <string.h>
 
 /**
  * @ingroup raw
@@ -22,6 +24,8 @@
 devcall rawControl(device *devptr, int func, long arg1, long arg2)
 {
     struct raw *rawptr;
+    const struct bpf_program *prog;
+    struct bpf_insn *insns = NULL;
     uchar old;
     irqmask im;
 
@@ -51,6 +55,32 @@ devcall rawControl(device *devptr, int func, long arg1, long arg2)
         rawptr->flags &= ~(arg1);
         restore(im);
         return old;
+
+        /* Set filter: arg1 = filter program to copy, NULL to remove */
+        /* return OK, SYSERR if the program is invalid               */
+    case RAW_CTRL_SETFILTER:
+        prog = (const struct bpf_program *)arg1;
+        if (NULL != prog)
+        {
+            if (!bpfValidate(prog->bf_insns, prog->bf_len))
+            {
+                restore(im);
+                return SYSERR;
+            }
+            insns = memget(prog->bf_len * sizeof(struct bpf_insn));
+            if (SYSERR == (int)insns)
+            {
+                restore(im);
+                return SYSERR;
+            }
+            memcpy(insns, prog->bf_insns,
+                   prog->bf_len * sizeof(struct bpf_insn));
+        }
+        bpfFree(&rawptr->filter);
+        rawptr->filter.bf_insns = insns;
+        rawptr->filter.bf_len = (NULL == prog) ? 0 : prog->bf_len;
+        restore(im);
+        return OK;
     }
 
     restore(im);
@@ -78,6 +78,8 @@ devcall rawOpen(device *devptr, va_list ap)
         return SYSERR;
     }
     rawptr->flags = NULL;
+    rawptr->filter.bf_len = 0;
+    rawptr->filter.bf_insns = NULL;
 
     restore(im);
     return OK;
@@ -5,6 +5,9 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <bpf.h>
+#include <interrupt.h>
+#include <mib.h>
 #include <network.h>
 #include <icmp.h>
 #include <raw.h>
@@ -21,6 +24,9 @@ syscall rawRecv(struct packet *pkt, struct netaddr *src,
 {
     struct raw *rawptr;
     uint index;
+    uint len;
+    uint accept = 1;
+    irqmask im;
 
     /* Error check pointers */
     if ((NULL == pkt) || (NULL == src) || (NULL == dst))
@@ -33,15 +39,35 @@ syscall rawRecv(struct packet *pkt, struct netaddr *src,
     if (NULL == rawptr)
     {
         RAW_TRACE("No matching socket");
+        mib.ipv4.inUnknownProtos++;
         /* Send ICMP port unreachable message */
         icmpDestUnreach(pkt, ICMP_PORT_UNR);
         netFreebuf(pkt);
         return OK;
     }
 
+    /* Drop packets rejected by the socket's filter program.  rawControl()
+     * may replace and free the program, so run it with interrupts
+     * disabled. */
+    im = disable();
+    if (rawptr->filter.bf_len > 0)
+    {
+        len = pkt->len - (pkt->nethdr - pkt->linkhdr);
+        accept = bpfFilter(rawptr->filter.bf_insns, pkt->nethdr, len,
+                           len - netSeglen(pkt));
+    }
+    restore(im);
+    if (0 == accept)
+    {
+        RAW_TRACE("Rejected by filter");
+        netFreebuf(pkt);
+        return OK;
+    }
+
     /* Ensure there is space */
     if (rawptr->icount >= RAW_IBLEN)
     {
+        mib.ipv4.inDiscards++;
         netFreebuf(pkt);
         return SYSERR;
     }
@@ -51,6 +77,7 @@ syscall rawRecv(struct packet *pkt, struct netaddr *src,
     rawptr->in[index] = pkt;
     netaddrcpy(&rawptr->src[index], src);
     rawptr->icount++;
+    mib.ipv4.inDelivers++;
     signal(rawptr->isema);
 
     RAW_TRACE("Enqueued packet");
@@ -4,6 +4,7 @@
 /* Embedded Xinu, Copyright (C) 2008, 2013.  All rights reserved. */
 
 #include <ether.h>
+#include <interrupt.h>
 #include <network.h>
 #include <string.h>
 #include "smsc9512.h"
@@ -16,6 +17,10 @@ devcall etherControl(device *devptr, int req, long arg1, long arg2)
     usb_status_t status;
     struct netaddr *addr;
     struct ether *ethptr;
+    struct packet *pkt;
+    struct packet **pkts;
+    irqmask im;
+    int n;
 
     ethptr = &ethertab[devptr->minor];
     udev = ethptr->csr;
@@ -52,6 +57,10 @@ devcall etherControl(device *devptr, int req, long arg1, long arg2)
     case NET_GET_MTU:
         return ETH_MTU;
 
+    /* Gather write of a frame given as segments.  */
+    case NET_SEND_SG:
+        return etherWritev(devptr, (const struct netseg *)arg1, arg2);
+
     /* Get hardware address.  */
     case NET_GET_HWADDR:
         addr = (struct netaddr *)arg1;
@@ -67,6 +76,62 @@ devcall etherControl(device *devptr, int req, long arg1, long arg2)
         memset(addr->addr, 0xFF, ETH_ADDR_LEN);
         break;
 
+    /* Hand the next received packet to the caller without copying it. */
+    case NET_RECV_PKT:
+        im = disable();
+        if (ethptr->state != ETH_STATE_UP)
+        {
+            restore(im);
+            return SYSERR;
+        }
+        /* Re-submit held Rx requests before waiting on an empty queue.  */
+        if ((0 == ethptr->icount) && ethptr->rxpoll)
+        {
+            etherPoll(ethptr);
+        }
+        wait(ethptr->isema);
+        pkt = ethptr->in[ethptr->istart];
+        ethptr->istart = (ethptr->istart + 1) % ETH_IBLEN;
+        ethptr->icount--;
+        restore(im);
+        *((struct packet **)arg1) = pkt;
+        return pkt->len;
+
+    /* Hand up every received packet, up to arg2, without copying them.  */
+    case NET_RECV_BURST:
+        if (arg2 < 1)
+        {
+            return SYSERR;
+        }
+        pkts = (struct packet **)arg1;
+        im = disable();
+        if (ethptr->state != ETH_STATE_UP)
+        {
+            restore(im);
+            return SYSERR;
+        }
+        /* Re-submit held Rx requests before waiting on an empty queue.  */
+        if ((0 == ethptr->icount) && ethptr->rxpoll)
+        {
+            etherPoll(ethptr);
+        }
+        wait(ethptr->isema);
+        n = 0;
+        while (TRUE)
+        {
+            pkts[n++] = ethptr->in[ethptr->istart];
+            ethptr->istart = (ethptr->istart + 1) % ETH_IBLEN;
+            ethptr->icount--;
+            if ((n >= arg2) || (semcount(ethptr->isema) < 1))
+            {
+                break;
+            }
+            /* Another packet is queued, so this does not block.  */
+            wait(ethptr->isema);
+        }
+        restore(im);
+        return n;
+
     default:
         return SYSERR;
     }
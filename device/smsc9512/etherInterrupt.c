@@ -17,9 +17,14 @@
 #include "smsc9512.h"
 #include <bufpool.h>
 #include <ether.h>
+#include <network.h>
 #include <string.h>
 #include <usb_core_driver.h>
 
+/* Rx requests held back from resubmission while readers catch up.  */
+static struct usb_xfer_request *rx_held[NETHER][SMSC9512_MAX_RX_REQUESTS];
+static uint rx_nheld[NETHER];
+
 /**
  * @ingroup etherspecific
  *
@@ -108,18 +113,29 @@ void smsc9512_rx_complete(struct usb_xfer_request *req)
             {
                 /* Buffer the received packet.  */
 
-                struct ethPktBuffer *pkt;
+                struct packet *pkt;
 
-                pkt = bufget(ethptr->inPool);
-                pkt->buf = pkt->data = (uint8_t*)(pkt + 1);
-                pkt->length = frame_length - ETH_CRC_LEN;
-                memcpy(pkt->buf, data + SMSC9512_RX_OVERHEAD, pkt->length);
+                /* Copy the frame straight into a network packet buffer so
+                 * that it can be handed up the stack without another copy.
+                 * We can't wait for a buffer here, so drop the frame if the
+                 * network pool is exhausted.  */
+                pkt = netGetbufNowait();
+                if (SYSERR == (int)pkt)
+                {
+                    usb_dev_debug(req->dev, "SMSC9512: Tallying overrun\n");
+                    ethptr->ovrrun++;
+                    continue;
+                }
+                pkt->len = frame_length - ETH_CRC_LEN;
+                memcpy(pkt->data, data + SMSC9512_RX_OVERHEAD, pkt->len);
+                pkt->linkhdr = pkt->data;
+                pkt->curr = pkt->data;
                 ethptr->in[(ethptr->istart + ethptr->icount) % ETH_IBLEN] = pkt;
                 ethptr->icount++;
 
                 usb_dev_debug(req->dev, "SMSC9512: Receiving "
                               "packet (length=%u, icount=%u)\n",
-                              pkt->length, ethptr->icount);
+                              pkt->len, ethptr->icount);
 
                 /* This may wake up a thread in etherRead().  */
                 signal(ethptr->isema);
@@ -132,6 +148,37 @@ void smsc9512_rx_complete(struct usb_xfer_request *req)
         usb_dev_debug(req->dev, "SMSC9512: USB Rx transfer failed\n");
         ethptr->errors++;
     }
+
+    /* If the readers have fallen a budget behind, switch to polling: hold
+     * the request back so the adapter buffers frames rather than the CPU
+     * taking a completion for every few of them.  etherPoll() re-submits it
+     * once a reader has drained the queue.  */
+    if ((ethptr->icount >= ETH_RX_BUDGET)
+        && (rx_nheld[ethptr - ethertab] < SMSC9512_MAX_RX_REQUESTS))
+    {
+        usb_dev_debug(req->dev, "SMSC9512: Holding USB Rx request\n");
+        ethptr->rxpoll = TRUE;
+        ethptr->rxbudget++;
+        rx_held[ethptr - ethertab][rx_nheld[ethptr - ethertab]++] = req;
+        return;
+    }
+
     usb_dev_debug(req->dev, "SMSC9512: Re-submitting USB Rx request\n");
     usb_submit_xfer_request(req);
 }
+
+/* Implementation of etherPoll() for the SMSC LAN9512.  There is no Rx
+ * interrupt to mask on a USB adapter, so polling mode means the Rx requests
+ * are held back by smsc9512_rx_complete(), and a poll re-submits them.  See
+ * the documentation for this function in ether.h.  */
+void etherPoll(struct ether *ethptr)
+{
+    uint n = ethptr - ethertab;
+
+    ethptr->rxpolls++;
+    ethptr->rxpoll = FALSE;
+    while (rx_nheld[n] > 0)
+    {
+        usb_submit_xfer_request(rx_held[n][--rx_nheld[n]]);
+    }
+}
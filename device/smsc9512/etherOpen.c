@@ -55,14 +55,8 @@ devcall etherOpen(device *devptr)
         goto out_restore;
     }
 
-    /* Create buffer pool for Rx packets (not the actual USB transfers, which
-     * are allocated separately).  */
-    ethptr->inPool = bfpalloc(sizeof(struct ethPktBuffer) + ETH_MAX_PKT_LEN,
-                              ETH_IBLEN);
-    if (ethptr->inPool == SYSERR)
-    {
-        goto out_free_out_pool;
-    }
+    /* Received packets are placed directly in network pool buffers (see
+     * smsc9512_rx_complete()), so no separate Rx buffer pool is needed.  */
 
     /* We're abusing the csr field to store a pointer to the USB device
      * structure.  At least it's somewhat equivalent, since it's what we need to
@@ -72,7 +66,7 @@ devcall etherOpen(device *devptr)
     /* Set MAC address */
     if (smsc9512_set_mac_address(udev, ethptr->devAddress) != USB_STATUS_SUCCESS)
     {
-        goto out_free_in_pool;
+        goto out_free_out_pool;
     }
 
     /* Initialize the Tx requests.  */
@@ -107,7 +101,7 @@ devcall etherOpen(device *devptr)
         req = usb_alloc_xfer_request(SMSC9512_DEFAULT_HS_BURST_CAP_SIZE);
         if (req == NULL)
         {
-            goto out_free_in_pool;
+            goto out_free_out_pool;
         }
         req->dev = udev;
         /* Assign Rx endpoint, checked in smsc9512_bind_device() */
@@ -125,7 +119,7 @@ devcall etherOpen(device *devptr)
     smsc9512_write_reg(udev, TX_CFG, TX_CFG_ON);
     if (udev->last_error != USB_STATUS_SUCCESS)
     {
-        goto out_free_in_pool;
+        goto out_free_out_pool;
     }
 
     /* Success!  Set the device to ETH_STATE_UP. */
@@ -133,8 +127,6 @@ devcall etherOpen(device *devptr)
     retval = OK;
     goto out_restore;
 
-out_free_in_pool:
-    bfpfree(ethptr->inPool);
 out_free_out_pool:
     bfpfree(ethptr->outPool);
 out_restore:
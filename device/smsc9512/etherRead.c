@@ -3,9 +3,9 @@
  */
 /* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
 
-#include <bufpool.h>
 #include <ether.h>
 #include <interrupt.h>
+#include <network.h>
 #include <string.h>
 
 /* Implementation of etherRead() for the smsc9512; see the documentation for
@@ -14,7 +14,7 @@ devcall etherRead(device *devptr, void *buf, uint len)
 {
     irqmask im;
     struct ether *ethptr;
-    struct ethPktBuffer *pkt;
+    struct packet *pkt;
 
     im = disable();
 
@@ -27,7 +27,11 @@ devcall etherRead(device *devptr, void *buf, uint len)
     }
 
     /* Wait for received packet to be available in the ethptr->in circular
-     * queue.  */
+     * queue, re-submitting held Rx requests if it is empty.  */
+    if ((0 == ethptr->icount) && ethptr->rxpoll)
+    {
+        etherPoll(ethptr);
+    }
     wait(ethptr->isema);
 
     /* Remove the received packet from the circular queue.  */
@@ -35,23 +39,20 @@ devcall etherRead(device *devptr, void *buf, uint len)
     ethptr->istart = (ethptr->istart + 1) % ETH_IBLEN;
     ethptr->icount--;
 
-    /* TODO: we'd like to restore interrupts here (before the memcpy()), but
-     * this doesn't work yet because smsc9512_rx_complete() expects a buffer to
-     * be available if icount < ETH_IBLEN; therefore, since we decremented
-     * icount, we can't restore interrupts until we actually release the
-     * corresponding buffer.  */
+    /* smsc9512_rx_complete() allocates its own buffers, so it is safe to
+     * restore interrupts before copying out of this one.  */
+    restore(im);
 
     /* Copy the data from the packet buffer, being careful to copy at most the
      * number of bytes requested. */
-    if (pkt->length < len)
+    if (pkt->len < len)
     {
-        len = pkt->length;
+        len = pkt->len;
     }
-    memcpy(buf, pkt->buf, len);
+    memcpy(buf, pkt->data, len);
 
     /* Return the packet buffer to the pool, then return the length of the
      * packet received.  */
-    buffree(pkt);
-    restore(im);
+    netFreebuf(pkt);
     return len;
 }
@@ -36,6 +36,8 @@ void etherStat(ushort minor)
     printf("  Rx errors             %lu\n",  ethptr->errors);
     printf("  Rx overruns           %u\n",   ethptr->ovrrun);
     printf("  Rx USB transfers done %lu\n",  ethptr->rxirq);
+    printf("  Rx polls              %lu\n",  ethptr->rxpolls);
+    printf("  Rx budget hits        %lu\n",  ethptr->rxbudget);
     printf("  Tx USB transfers done %lu\n",  ethptr->txirq);
 }
 
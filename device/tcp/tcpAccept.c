@@ -0,0 +1,51 @@
+/**
+ * @file tcpAccept.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <semaphore.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Waits for a listener with a backlog to complete a handshake, and takes
+ * the connection off its accept queue.
+ * @param listener listening TCB
+ * @return device number of the established connection, SYSERR if the
+ *         TCB is not listening with a backlog, or stops while waiting
+ * @pre-condition listener TCB mutex is not held
+ */
+devcall tcpAccept(struct tcb *listener)
+{
+    struct tcb *tcbptr = NULL;
+    irqmask im;
+
+    while (NULL == tcbptr)
+    {
+        if ((TCP_LISTEN != listener->state) || (0 == listener->backlog))
+        {
+            return SYSERR;
+        }
+
+        /* Established connections each signal the listener */
+        wait(listener->openclose);
+
+        im = disable();
+        tcbptr = listener->acceptq;
+        if (NULL != tcbptr)
+        {
+            listener->acceptq = tcbptr->anext;
+            listener->qlen--;
+            tcbptr->anext = NULL;
+            tcbptr->listener = NULL;
+        }
+        restore(im);
+    }
+
+    TCP_TRACE("Accepted socket %d", tcbptr - tcptab);
+    return tcbptr->dev;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file tcpBufResize.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <memory.h>
+#include <semaphore.h>
+#include <string.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Changes the size of the input and output buffers of a TCP connection.
+ * Buffered data is moved to the start of the new buffers.  A buffer may
+ * not shrink below the data it holds or, for input, the window already
+ * advertised.
+ * @param tcbptr pointer to transmission control block for connection
+ * @param ilen new size of input buffer, 0 to leave it alone
+ * @param olen new size of output buffer, 0 to leave it alone
+ * @return OK if resized, SYSERR if a buffer would be too small or memory
+ *         is short; neither buffer changes on SYSERR
+ * @pre-condition TCB mutex is already held
+ * @post-condition TCB mutex is still held
+ */
+int tcpBufResize(struct tcb *tcbptr, uint ilen, uint olen)
+{
+    uchar *in = NULL;
+    uchar *out = NULL;
+    uint used, first;
+
+    if (0 == ilen)
+    {
+        ilen = tcbptr->ilen;
+    }
+    if (0 == olen)
+    {
+        olen = tcbptr->olen;
+    }
+
+    /* Input in use covers readable data and the advertised window,
+     * where out-of-order data may already sit */
+    used = tcbptr->icount;
+    if (seqlt(tcbptr->rcvnxt, tcbptr->rcvwnd))
+    {
+        used += tcpSeqdiff(tcbptr->rcvwnd, tcbptr->rcvnxt);
+    }
+    if (used > tcbptr->ilen)
+    {
+        used = tcbptr->ilen;
+    }
+    if ((ilen < used) || (olen < tcbptr->ocount))
+    {
+        return SYSERR;
+    }
+
+    /* Allocate both buffers before changing either */
+    if (ilen != tcbptr->ilen)
+    {
+        in = memget(ilen);
+        if (SYSERR == (int)in)
+        {
+            return SYSERR;
+        }
+    }
+    if (olen != tcbptr->olen)
+    {
+        out = memget(olen);
+        if (SYSERR == (int)out)
+        {
+            if (NULL != in)
+            {
+                memfree(in, ilen);
+            }
+            return SYSERR;
+        }
+    }
+
+    if (NULL != in)
+    {
+        first = tcbptr->ilen - tcbptr->istart;
+        if (first > used)
+        {
+            first = used;
+        }
+        memcpy(in, &tcbptr->in[tcbptr->istart], first);
+        memcpy(in + first, &tcbptr->in[0], used - first);
+        memfree(tcbptr->in, tcbptr->ilen);
+        tcbptr->in = in;
+        tcbptr->ilen = ilen;
+        tcbptr->istart = 0;
+        tcbptr->inxt = tcbptr->icount;
+    }
+
+    if (NULL != out)
+    {
+        first = tcbptr->olen - tcbptr->ostart;
+        if (first > tcbptr->ocount)
+        {
+            first = tcbptr->ocount;
+        }
+        memcpy(out, &tcbptr->out[tcbptr->ostart], first);
+        memcpy(out + first, &tcbptr->out[0], tcbptr->ocount - first);
+        memfree(tcbptr->out, tcbptr->olen);
+        tcbptr->out = out;
+        tcbptr->olen = olen;
+        tcbptr->ostart = 0;
+
+        /* Writers may be waiting for the room just made */
+        if ((tcbptr->ocount < olen) && (semcount(tcbptr->writers) < 1))
+        {
+            signal(tcbptr->writers);
+        }
+    }
+
+    return OK;
+}
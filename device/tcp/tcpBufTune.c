@@ -0,0 +1,118 @@
+/**
+ * @file tcpBufTune.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <tcp.h>
+
+static uint tcpBufWant(uint, uint, ulong, uint);
+
+/**
+ * @ingroup tcp
+ *
+ * Auto-tunes the buffers of a TCP connection.  Once per round trip, the
+ * octets that moved each way during the round trip give the bandwidth x
+ * RTT product; a buffer that holds less than twice that is grown, at most
+ * doubling each time and never beyond ::TCP_BUFMAX.  Buffers never shrink
+ * on their own.
+ * @param tcbptr pointer to transmission control block for connection
+ * @pre-condition TCB mutex is already held
+ * @post-condition TCB mutex is still held
+ */
+void tcpBufTune(struct tcb *tcbptr)
+{
+    ulong now, elapsed;
+    uint rtt;
+    uint ilen = 0;
+    uint olen = 0;
+    irqmask im;
+
+    if (!tcbptr->iauto && !tcbptr->oauto)
+    {
+        return;
+    }
+
+    /* Smoothed RTT, or the retransmit time until there is a sample */
+    rtt = tcbptr->sndrtt >> 3;
+    if (0 == rtt)
+    {
+        rtt = tcbptr->rxttime;
+    }
+
+    im = disable();
+    now = clktime * 1000 + clkticks * (1000 / CLKTICKS_PER_SEC);
+    restore(im);
+    elapsed = now - tcbptr->tunetime;
+    if (elapsed < rtt)
+    {
+        return;
+    }
+
+    /* The first sample only starts the clock */
+    if (0 != tcbptr->tunetime)
+    {
+        if (tcbptr->iauto)
+        {
+            ilen = tcpBufWant(tcbptr->ilen,
+                              tcbptr->ibytes - tcbptr->tuneibytes,
+                              elapsed, rtt);
+        }
+        if (tcbptr->oauto)
+        {
+            olen = tcpBufWant(tcbptr->olen,
+                              tcbptr->obytes - tcbptr->tuneobytes,
+                              elapsed, rtt);
+        }
+        if ((0 != ilen) || (0 != olen))
+        {
+            TCP_TRACE("Tune buffers in %u out %u", ilen, olen);
+            tcpBufResize(tcbptr, ilen, olen);
+        }
+    }
+
+    tcbptr->tunetime = now;
+    tcbptr->tuneibytes = tcbptr->ibytes;
+    tcbptr->tuneobytes = tcbptr->obytes;
+}
+
+/**
+ * Size a buffer should grow to.
+ * @param len current size
+ * @param bytes octets moved in the sample
+ * @param elapsed length of the sample, ms
+ * @param rtt round trip time, ms
+ * @return new size, 0 if the buffer is large enough
+ */
+static uint tcpBufWant(uint len, uint bytes, ulong elapsed, uint rtt)
+{
+    uint rate;
+    uint want;
+
+    /* Octets per ms; divide first, octets times milliseconds overflows */
+    rate = bytes / elapsed;
+    if (rate > TCP_BUFMAX / (2 * rtt))
+    {
+        want = TCP_BUFMAX;
+    }
+    else
+    {
+        want = 2 * rtt * rate;
+    }
+    if ((want <= len) || (len >= TCP_BUFMAX))
+    {
+        return 0;
+    }
+    if (want > 2 * len)
+    {
+        want = 2 * len;
+    }
+    if (want > TCP_BUFMAX)
+    {
+        want = TCP_BUFMAX;
+    }
+    return want;
+}
@@ -17,7 +17,9 @@ ushort tcpChksum(struct packet *pkt, ushort len, struct netaddr *src,
 {
     struct tcpPseudo *pseu;
     uchar buf[TCP_PSEUDO_LEN];
+    struct netseg segs[NET_MAX_SEGS + 1];
     ushort sum;
+    uint i;
 
     /* Store current data before TCP header in temporary buffer */
     pseu = (struct tcpPseudo *)(pkt->curr - TCP_PSEUDO_LEN);
@@ -30,7 +32,15 @@ ushort tcpChksum(struct packet *pkt, ushort len, struct netaddr *src,
     pseu->proto = IPv4_PROTO_TCP;
     pseu->len = hs2net(len);
 
-    sum = netChksum(pseu, len + TCP_PSEUDO_LEN);
+    /* Sum the pseudo header and the part of the segment in the packet
+     * buffer, followed by any payload segments */
+    segs[0].data = pseu;
+    segs[0].len = len - netSeglen(pkt) + TCP_PSEUDO_LEN;
+    for (i = 0; i < pkt->nseg; i++)
+    {
+        segs[i + 1] = pkt->seg[i];
+    }
+    sum = netChksumSg(segs, pkt->nseg + 1);
 
     /* Restore data before TCP header from temporary buffer */
     memcpy(pseu, buf, TCP_PSEUDO_LEN);
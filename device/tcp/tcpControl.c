@@ -18,6 +18,8 @@ devcall tcpControl(device *devptr, int func, long arg1, long arg2)
 {
     struct tcb *tcbptr;
     uint bytes;
+    int result;
+    ushort flag;
 
     tcbptr = &tcptab[devptr->minor];
 
@@ -36,6 +38,73 @@ devcall tcpControl(device *devptr, int func, long arg1, long arg2)
         signal(tcbptr->mutex);
         return bytes;
 
+        /* Set buffer sizes; a size of 0 auto-tunes the buffer */
+    case TCP_CTRL_RCVBUF:
+    case TCP_CTRL_SNDBUF:
+        if ((TCP_CLOSED == tcbptr->state)
+            || ((0 != arg1)
+                && ((arg1 < TCP_BUFMIN) || (arg1 > TCP_BUFMAX))))
+        {
+            signal(tcbptr->mutex);
+            return SYSERR;
+        }
+        if (TCP_CTRL_RCVBUF == func)
+        {
+            tcbptr->iauto = (0 == arg1);
+            result = (0 == arg1) ? OK : tcpBufResize(tcbptr, arg1, 0);
+        }
+        else
+        {
+            tcbptr->oauto = (0 == arg1);
+            result = (0 == arg1) ? OK : tcpBufResize(tcbptr, 0, arg1);
+        }
+        signal(tcbptr->mutex);
+        return result;
+
+        /* Set Nagle opt-out or cork, then send what they now allow */
+    case TCP_CTRL_NODELAY:
+    case TCP_CTRL_CORK:
+        flag = (TCP_CTRL_NODELAY == func) ? TCP_FLG_NODELAY : TCP_FLG_CORK;
+        if (arg1)
+        {
+            tcbptr->sndflg |= flag;
+        }
+        else
+        {
+            tcbptr->sndflg &= ~flag;
+        }
+        if ((TCP_ESTAB == tcbptr->state)
+            || (TCP_CLOSEWT == tcbptr->state))
+        {
+            tcpSendData(tcbptr);
+        }
+        signal(tcbptr->mutex);
+        return OK;
+
+        /* Set listen backlog, for a passive open yet to come */
+    case TCP_CTRL_BACKLOG:
+        if ((arg1 < 0) || (arg1 >= NTCP)
+            || ((TCP_CLOSED != tcbptr->state)
+                && (TCP_LISTEN != tcbptr->state)))
+        {
+            signal(tcbptr->mutex);
+            return SYSERR;
+        }
+        tcbptr->backlog = arg1;
+        signal(tcbptr->mutex);
+        return OK;
+
+        /* Wait for a connection on a listener with a backlog */
+    case TCP_CTRL_ACCEPT:
+        signal(tcbptr->mutex);
+        return tcpAccept(tcbptr);
+
+        /* Record events in the TCP event log, or stop */
+    case TCP_CTRL_LOG:
+        tcbptr->log = (arg1 != FALSE);
+        signal(tcbptr->mutex);
+        return OK;
+
         /* Unrecongnized control function */
     default:
         signal(tcbptr->mutex);
@@ -1,12 +1,18 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <interrupt.h>
 #include <tcp.h>
 
 /**
  * @ingroup tcp
  *
- * Locate the TCP socket for a TCP packet
+ * Locate the TCP socket for a TCP packet.  A full match in the connection
+ * table is best; otherwise a TCB in the listener table with a matching
+ * remote port is preferred to one with no remote port.  Among equally
+ * good matches the earliest in tcptab wins, as in the linear scan this
+ * replaced.  Lookup only walks one bucket of each table, with interrupts
+ * disabled instead of taking each TCB's mutex.
  * @param dstpt destination port of the TCP packet
  * @param srcpt source port of the TCP packet
  * @param dstip destination IP of the TCP packet
@@ -16,54 +22,64 @@
 struct tcb *tcpDemux(ushort dstpt, ushort srcpt, struct netaddr *dstip,
                      struct netaddr *srcip)
 {
-    struct tcb *tcbptr = NULL;
-    uint i;
+    struct tcb *tcbptr;
+    struct tcb *best = NULL;
     uint level = 0;
+    irqmask im;
 
-    /* Cycle through all tcp devices to find the best match */
-    for (i = 0; i < NTCP; i++)
+    im = disable();
+
+    /* Full match is the best */
+    for (tcbptr = tcpconntab[tcpHashConn(dstpt, srcpt, srcip)];
+         NULL != tcbptr; tcbptr = tcbptr->hnext)
+    {
+        if ((tcbptr->localpt == dstpt)
+            && (tcbptr->remotept == srcpt)
+            && (netaddrequal(&tcbptr->localip, dstip))
+            && (netaddrequal(&tcbptr->remoteip, srcip))
+            && ((NULL == best) || (tcbptr < best)))
+        {
+            best = tcbptr;
+        }
+    }
+    if (NULL != best)
+    {
+        restore(im);
+        TCP_TRACE("Level 3 match, socket %d", best - tcptab);
+        return best;
+    }
+
+    for (tcbptr = tcplistentab[tcpHashListen(dstpt)];
+         NULL != tcbptr; tcbptr = tcbptr->hnext)
     {
-        wait(tcptab[i].mutex);
-        if (tcptab[i].state != TCP_CLOSED)
+        if ((tcbptr->localpt != dstpt)
+            || (tcbptr->remoteip.type != NULL)
+            || (!netaddrequal(&tcbptr->localip, dstip)))
         {
-            /* Full match is the best */
-            if (level < 3
-                && (tcptab[i].localpt == dstpt)
-                && (tcptab[i].remotept == srcpt)
-                && (netaddrequal(&tcptab[i].localip, dstip))
-                && (netaddrequal(&tcptab[i].remoteip, srcip)))
-            {
-                tcbptr = &tcptab[i];
-                level = 3;
-                TCP_TRACE("Level 3 match, socket %d", i);
-            }
+            continue;
+        }
 
-            /* Src and dst ports match */
-            if (level < 2
-                && (tcptab[i].localpt == dstpt)
-                && (tcptab[i].remotept == srcpt)
-                && (netaddrequal(&tcptab[i].localip, dstip))
-                && (tcptab[i].remoteip.type == NULL))
-            {
-                tcbptr = &tcptab[i];
-                level = 2;
-                TCP_TRACE("Level 2 match, socket %d", i);
-            }
+        /* Src and dst ports match */
+        if ((tcbptr->remotept == srcpt)
+            && ((level < 2) || (tcbptr < best)))
+        {
+            best = tcbptr;
+            level = 2;
+        }
 
-            /* Dst ports match is last */
-            if (level < 1
-                && (tcptab[i].localpt == dstpt)
-                && (tcptab[i].remotept == NULL)
-                && (netaddrequal(&tcptab[i].localip, dstip))
-                && (tcptab[i].remoteip.type == NULL))
-            {
-                tcbptr = &tcptab[i];
-                level = 1;
-                TCP_TRACE("Level 1 match, socket %d", i);
-            }
+        /* Dst ports match is last */
+        else if ((tcbptr->remotept == NULL) && (level <= 1)
+                 && ((level < 1) || (tcbptr < best)))
+        {
+            best = tcbptr;
+            level = 1;
         }
-        signal(tcptab[i].mutex);
     }
 
-    return tcbptr;
+    restore(im);
+    if (NULL != best)
+    {
+        TCP_TRACE("Level %d match, socket %d", level, best - tcptab);
+    }
+    return best;
 }
@@ -2,6 +2,7 @@
 
 #include <device.h>
 #include <interrupt.h>
+#include <memory.h>
 #include <semaphore.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -18,6 +19,23 @@ devcall tcpFree(struct tcb *tcbptr)
 {
     irqmask im;
     semaphore temp;
+    struct tcb *child;
+    struct tcb **prev;
+    int i;
+
+    tcpHashRemove(tcbptr);
+
+    /* Release buffers */
+    if (NULL != tcbptr->in)
+    {
+        memfree(tcbptr->in, tcbptr->ilen);
+        tcbptr->in = NULL;
+    }
+    if (NULL != tcbptr->out)
+    {
+        memfree(tcbptr->out, tcbptr->olen);
+        tcbptr->out = NULL;
+    }
 
     /* Verify TCB is not already free */
     if (TCP_CLOSED == tcbptr->state)
@@ -28,8 +46,46 @@ devcall tcpFree(struct tcb *tcbptr)
 
     TCP_TRACE("Free TCB");
 
+    /* A listener takes down the connections it still holds */
+    if (tcbptr->backlog > 0)
+    {
+        for (i = 0; i < NTCP; i++)
+        {
+            child = &tcptab[i];
+            if ((child == tcbptr) || (child->listener != tcbptr))
+            {
+                continue;
+            }
+            wait(child->mutex);
+            if (child->listener == tcbptr)
+            {
+                child->listener = NULL;
+                tcpFree(child);
+            }
+            else
+            {
+                signal(child->mutex);
+            }
+        }
+    }
+
     im = disable();
 
+    /* A connection not yet accepted leaves its listener's backlog */
+    if (NULL != tcbptr->listener)
+    {
+        prev = &tcbptr->listener->acceptq;
+        while ((NULL != *prev) && (tcbptr != *prev))
+        {
+            prev = &(*prev)->anext;
+        }
+        if (NULL != *prev)
+        {
+            *prev = tcbptr->anext;
+        }
+        tcbptr->listener->qlen--;
+    }
+
     /* Free TCB */
     temp = tcbptr->mutex;
     semfree(tcbptr->openclose);
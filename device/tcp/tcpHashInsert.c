@@ -0,0 +1,47 @@
+/**
+ * @file tcpHashInsert.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Adds a TCB to the demultiplexing tables.  A TCB with both remote port
+ * and remote IP address goes in the connection table, hashed on its
+ * 4-tuple; any other TCB goes in the listener table, hashed on its local
+ * port.  The connection fields must not change while the TCB is in a
+ * table; call tcpHashRemove() first.
+ * @param tcbptr pointer to transmission control block for connection
+ * @pre-condition TCB mutex is already held
+ */
+void tcpHashInsert(struct tcb *tcbptr)
+{
+    struct tcb **head;
+    irqmask im;
+
+    if (tcbptr->hashed)
+    {
+        return;
+    }
+
+    if ((NULL != tcbptr->remotept) && (NULL != tcbptr->remoteip.type))
+    {
+        head = &tcpconntab[tcpHashConn(tcbptr->localpt, tcbptr->remotept,
+                                       &tcbptr->remoteip)];
+    }
+    else
+    {
+        head = &tcplistentab[tcpHashListen(tcbptr->localpt)];
+    }
+
+    im = disable();
+    tcbptr->hnext = *head;
+    *head = tcbptr;
+    tcbptr->hashed = TRUE;
+    restore(im);
+}
@@ -0,0 +1,50 @@
+/**
+ * @file tcpHashRemove.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Removes a TCB from the demultiplexing tables, if it is in one.
+ * @param tcbptr pointer to transmission control block for connection
+ * @pre-condition TCB mutex is already held
+ */
+void tcpHashRemove(struct tcb *tcbptr)
+{
+    struct tcb **prev;
+    irqmask im;
+
+    if (!tcbptr->hashed)
+    {
+        return;
+    }
+
+    if ((NULL != tcbptr->remotept) && (NULL != tcbptr->remoteip.type))
+    {
+        prev = &tcpconntab[tcpHashConn(tcbptr->localpt, tcbptr->remotept,
+                                       &tcbptr->remoteip)];
+    }
+    else
+    {
+        prev = &tcplistentab[tcpHashListen(tcbptr->localpt)];
+    }
+
+    im = disable();
+    while ((NULL != *prev) && (tcbptr != *prev))
+    {
+        prev = &(*prev)->hnext;
+    }
+    if (NULL != *prev)
+    {
+        *prev = tcbptr->hnext;
+    }
+    tcbptr->hnext = NULL;
+    tcbptr->hashed = FALSE;
+    restore(im);
+}
@@ -10,6 +10,8 @@
 #include <tcp.h>
 
 struct tcb tcptab[NTCP];
+struct tcb *tcpconntab[TCP_NHASH];
+struct tcb *tcplistentab[TCP_NHASH];
 
 /**
  * @ingroup tcp
@@ -0,0 +1,51 @@
+/**
+ * @file tcpLog.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <tcp.h>
+
+struct tcpLogEntry tcplog[TCP_LOG_LEN];
+uint tcplognext = 0;
+bool tcplogall = FALSE;
+
+/**
+ * @ingroup tcp
+ *
+ * Records an event and the congestion state it left behind in the TCP
+ * event log, if the connection is being logged.  The log is a ring shared
+ * by all connections; the oldest entries are overwritten.
+ * @param tcbptr pointer to transmission control block for connection
+ * @param event TCP_LOG_* event
+ * @param value event detail
+ * @pre-condition TCB mutex is already held
+ * @post-condition TCB mutex is still held
+ */
+void tcpLog(struct tcb *tcbptr, uchar event, int value)
+{
+    struct tcpLogEntry *entry;
+    irqmask im;
+
+    if (!tcbptr->log)
+    {
+        return;
+    }
+
+    im = disable();
+    entry = &tcplog[tcplognext % TCP_LOG_LEN];
+    tcplognext++;
+    entry->time = tcpTimerNow() * TCP_FREQ;
+    entry->dev = tcbptr->dev;
+    entry->event = event;
+    entry->snduna = tcbptr->snduna;
+    entry->sndcwn = tcbptr->sndcwn;
+    entry->sndsst = tcbptr->sndsst;
+    entry->sndwnd = tcbptr->sndwnd;
+    entry->sndrtt = tcbptr->sndrtt >> 3;
+    entry->value = value;
+    restore(im);
+}
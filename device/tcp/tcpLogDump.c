@@ -0,0 +1,50 @@
+/**
+ * @file tcpLogDump.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <stdio.h>
+#include <tcp.h>
+
+static const char *tcplogname[] = {
+    "none", "ack", "dupack", "rtt", "rto", "fast", "recover", "persist",
+    "open"
+};
+
+/**
+ * @ingroup tcp
+ *
+ * Prints the TCP event log as comma separated values, oldest entry first,
+ * with a header row naming the columns.
+ */
+void tcpLogDump(void)
+{
+    struct tcpLogEntry entry;
+    uint i, end;
+    irqmask im;
+
+    im = disable();
+    end = tcplognext;
+    restore(im);
+    i = (end > TCP_LOG_LEN) ? end - TCP_LOG_LEN : 0;
+
+    printf("time,dev,event,snduna,cwnd,ssthresh,wnd,srtt,value\n");
+    for (; i < end; i++)
+    {
+        /* Copy the entry, so printing need not hold off interrupts; one
+         * overwritten meanwhile is printed as it now stands */
+        im = disable();
+        entry = tcplog[i % TCP_LOG_LEN];
+        restore(im);
+        if (entry.event >= sizeof(tcplogname) / sizeof(tcplogname[0]))
+        {
+            entry.event = 0;
+        }
+        printf("%lu,%d,%s,%u,%u,%u,%u,%d,%d\n", entry.time, entry.dev,
+               tcplogname[entry.event], entry.snduna, entry.sndcwn,
+               entry.sndsst, entry.sndwnd, entry.sndrtt, entry.value);
+    }
+}
@@ -24,6 +24,8 @@ static ushort allocPort(void);
  *           4th argument is the local port (auto-assigned if zero)
  *           5th argument is the remote port (ignored if zero)
  *           6th argument is the mode (TCP_ACTIVE or TCP_PASSIVE)
+ * A passive open waits for a connection, unless a backlog was set with
+ * ::TCP_CTRL_BACKLOG; the TCB then stays listening and returns at once.
  * @return OK if TCP is opened properly, otherwise SYSERR
  */
 devcall tcpOpen(device *devptr, va_list ap)
@@ -76,6 +78,9 @@ devcall tcpOpen(device *devptr, va_list ap)
     /* Mutually link tcp record with device table entry */
     tcbptr->dev = devptr->num;
 
+    /* A listening TCB being reopened leaves the demultiplexing tables */
+    tcpHashRemove(tcbptr);
+
     /* Initialize port and ip fields */
     tcbptr->localpt = localpt;
     netaddrcpy(&tcbptr->localip, localip);
@@ -98,11 +103,21 @@ devcall tcpOpen(device *devptr, va_list ap)
         return SYSERR;
     }
 
+    /* Make the TCB visible to tcpDemux() before any segment can arrive */
+    tcpHashInsert(tcbptr);
+
     /* Perform appropriate action and change state */
     switch (mode)
     {
     case TCP_PASSIVE:
         tcbptr->state = TCP_LISTEN;
+        /* With a backlog, connections are taken with tcpAccept() */
+        if (tcbptr->backlog > 0)
+        {
+            signal(tcbptr->mutex);
+            TCP_TRACE("Listening");
+            return OK;
+        }
         break;
     case TCP_ACTIVE:
         if (SYSERR == tcpOpenActive(tcbptr))
@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <mib.h>
 #include <tcp.h>
 
 /**
@@ -31,6 +32,7 @@ devcall tcpOpenActive(struct tcb *tcbptr)
     }
 
     tcbptr->state = TCP_SYNSENT;
+    mib.tcp.activeOpens++;
 
     return OK;
 }
@@ -0,0 +1,72 @@
+/**
+ * @file tcpRangeAdd.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <string.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Adds the sequence range [start, end) to a list of at most ::TCP_NRANGE
+ * ranges, such as the out-of-order data held by a TCP connection or the
+ * data its peer has selectively acknowledged.  Ranges stay sorted by
+ * sequence number; ranges that overlap or touch the new one are merged
+ * with it.
+ * @param range list of ranges
+ * @param count number of ranges in the list, updated
+ * @param start first sequence number of the range
+ * @param end sequence number following the range
+ * @return OK if added, SYSERR if the list is full
+ * @pre-condition TCB mutex is already held
+ * @post-condition TCB mutex is still held
+ */
+int tcpRangeAdd(struct tcpRange *range, uint *count, tcpseq start,
+                tcpseq end)
+{
+    uint n = *count;
+    uint i, j;
+
+    /* Skip ranges that end before the new one begins */
+    for (i = 0; (i < n) && seqlt(range[i].end, start); i++)
+    {
+    }
+
+    /* Absorb ranges that overlap or touch the new one */
+    for (j = i; (j < n) && seqlte(range[j].start, end); j++)
+    {
+        if (seqlt(range[j].start, start))
+        {
+            start = range[j].start;
+        }
+        if (seqlt(end, range[j].end))
+        {
+            end = range[j].end;
+        }
+    }
+
+    if (i == j)
+    {
+        /* Nothing merged, insert a new range */
+        if (n >= TCP_NRANGE)
+        {
+            return SYSERR;
+        }
+        memmove(&range[i + 1], &range[i], (n - i) * sizeof(*range));
+        n++;
+    }
+    else
+    {
+        /* Ranges i through j - 1 become range i */
+        memmove(&range[i + 1], &range[j], (n - j) * sizeof(*range));
+        n -= j - i - 1;
+    }
+
+    range[i].start = start;
+    range[i].end = end;
+    *count = n;
+    return OK;
+}
@@ -6,6 +6,7 @@
 
 #include <device.h>
 #include <stddef.h>
+#include <string.h>
 #include <tcp.h>
 
 static int stateCheck(struct tcb *);
@@ -22,6 +23,7 @@ static int stateCheck(struct tcb *);
 devcall tcpRead(device *devptr, void *buf, uint len)
 {
     int count = 0;
+    uint n, first;
     struct tcb *tcbptr;
     int check;
     char *buffer = buf;
@@ -55,16 +57,24 @@ devcall tcpRead(device *devptr, void *buf, uint len)
 //            return check; 
         }
 
-        /* Read as much as possible from the input buffer 
-         * Preserve the circular buffer  */
-        while ((tcbptr->icount > 0) && (count < len))
+        /* Read as much as possible from the input buffer, in at most
+         * two pieces around the wrap of the circular buffer */
+        n = tcbptr->icount;
+        if (n > len - count)
         {
-            *buffer++ = tcbptr->in[tcbptr->istart];
-            tcbptr->imark[tcbptr->istart] = FALSE;
-            tcbptr->istart = (tcbptr->istart + 1) % TCP_IBLEN;
-            tcbptr->icount--;
-            count++;
+            n = len - count;
         }
+        first = tcbptr->ilen - tcbptr->istart;
+        if (first > n)
+        {
+            first = n;
+        }
+        memcpy(buffer, &tcbptr->in[tcbptr->istart], first);
+        memcpy(buffer + first, &tcbptr->in[0], n - first);
+        tcbptr->istart = (tcbptr->istart + n) % tcbptr->ilen;
+        tcbptr->icount -= n;
+        buffer += n;
+        count += n;
 
 #ifdef TCP_GRACIOUSACK
         /* Send gracious acknowledgement if window has increaed */
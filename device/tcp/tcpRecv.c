@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <mib.h>
 #include <network.h>
 #include <semaphore.h>
 #include <tcp.h>
@@ -25,6 +26,8 @@ int tcpRecv(struct packet *pkt, struct netaddr *src, struct netaddr *dst)
     ushort tcplen;
     int result = 0;
 
+    mib.tcp.inSegs++;
+
     /* Setup packet pointers */
     tcp = (struct tcpPkt *)pkt->curr;
     tcplen = pkt->len - (pkt->curr - pkt->linkhdr);
@@ -32,6 +35,7 @@ int tcpRecv(struct packet *pkt, struct netaddr *src, struct netaddr *dst)
     /* Verify TCP checksum is correct */
     if (tcpChksum(pkt, tcplen, src, dst))
     {
+        mib.tcp.inErrs++;
         netFreebuf(pkt);
         TCP_TRACE("Bad Checksum");
         return OK;
@@ -55,6 +59,7 @@ int tcpRecv(struct packet *pkt, struct netaddr *src, struct netaddr *dst)
     /* Send a reset if no matching stream socket was found */
     if (NULL == tcbptr)
     {
+        mib.tcp.noPorts++;
         tcpSendRst(pkt, src, dst);
         return netFreebuf(pkt);
     }
@@ -70,6 +75,9 @@ int tcpRecv(struct packet *pkt, struct netaddr *src, struct netaddr *dst)
         return netFreebuf(pkt);
     }
 
+    tcbptr->rcvsegs++;
+    tcbptr->rcvoctets += tcpSeglen(tcp, tcplen);
+
     tcpRecvOpts(pkt, tcbptr);
 
     /* Call appropriate receive function based on connection state */
@@ -5,13 +5,18 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <interrupt.h>
+#include <network.h>
+#include <string.h>
 #include <tcp.h>
 
 /**
  * @ingroup tcp
  *
  * Process an ackowledgement of data in an incoming TCP segment for a
- * connection which has been fully established.
+ * connection which has been fully established.  Duplicate ACKs trigger
+ * fast retransmit and NewReno fast recovery (RFC 5681, RFC 6582), during
+ * which holes reported by SACK are retransmitted first.
  * @param pkt incoming packet
  * @param tcbptr pointer to transmission control block for connection
  * @precondition TCB mutex is already held 
@@ -20,11 +25,33 @@
 int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
 {
     uint amt = 0;
+    uint flight;
+    uint window;
     tcpseq oldend, newend;
     struct tcpPkt *tcp;
+    ushort tcplen;
+    bool dupack;
+    ulong closed;
+    irqmask im;
 
     /* Setup packet pointers */
     tcp = (struct tcpPkt *)pkt->curr;
+    tcplen = pkt->len - (pkt->curr - pkt->linkhdr);
+
+    /* The window in a SYN is never scaled */
+    window = tcp->window;
+    if (!(tcp->control & TCP_CTRL_SYN))
+    {
+        window <<= tcbptr->sndscale;
+    }
+
+    /* A duplicate ACK acknowledges nothing new, carries no data, leaves
+     * the window alone and arrives while data is outstanding */
+    dupack = (tcp->acknum == tcbptr->snduna)
+        && (0 == tcpSeglen(tcp, tcplen))
+        && (window == tcbptr->sndwnd)
+        && !(tcp->control & (TCP_CTRL_SYN | TCP_CTRL_FIN))
+        && seqlt(tcbptr->snduna, tcbptr->sndnxt);
 
     if (seqlt(tcbptr->snduna, tcp->acknum)
         && seqlte(tcp->acknum, tcbptr->sndnxt))
@@ -47,19 +74,57 @@ int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
         }
 
         /* Adjust send buffer */
-        tcbptr->ostart = (tcbptr->ostart + amt) % TCP_OBLEN;
+        tcbptr->ostart = (tcbptr->ostart + amt) % tcbptr->olen;
         tcbptr->ocount -= amt;
         tcbptr->obytes += amt;
-        if (tcbptr->ocount < TCP_OBLEN)
+        if (tcbptr->ocount < tcbptr->olen)
         {
             signal(tcbptr->writers);
         }
 
         tcbptr->snduna = tcp->acknum;
+        tcbptr->dupacks = 0;
+
+        /* Forget SACKed ranges that are now acknowledged */
+        while ((tcbptr->sndnsack > 0)
+               && seqlte(tcbptr->sndsack[0].end, tcbptr->snduna))
+        {
+            tcbptr->sndnsack--;
+            memmove(&tcbptr->sndsack[0], &tcbptr->sndsack[1],
+                    tcbptr->sndnsack * sizeof(struct tcpRange));
+        }
+        if ((tcbptr->sndnsack > 0)
+            && seqlt(tcbptr->sndsack[0].start, tcbptr->snduna))
+        {
+            tcbptr->sndsack[0].start = tcbptr->snduna;
+        }
 
         /* Remove any segments from retransmission queue which are ACKed */
         tcbptr->rxtcount = 0;
-        tcpRecvRtt(tcbptr);
+        if (tcbptr->sndflg & TCP_FLG_RECOVER)
+        {
+            /* Retransmitted data gives no round trip sample */
+            tcpTimerPurge(tcbptr, TCP_EVT_RXT);
+            if (seqlt(tcp->acknum, tcbptr->sndrecover))
+            {
+                /* Partial ACK: the next hole was lost too.  Deflate the
+                 * window by the data acknowledged and retransmit. */
+                tcbptr->sndcwn -= (amt < tcbptr->sndcwn) ?
+                    amt : tcbptr->sndcwn;
+                tcbptr->sndcwn += tcbptr->sndmss;
+                tcpSendRecover(tcbptr);
+            }
+            else
+            {
+                /* Full ACK: leave fast recovery */
+                tcbptr->sndcwn = tcbptr->sndsst;
+                tcbptr->sndflg &= ~TCP_FLG_RECOVER;
+            }
+        }
+        else
+        {
+            tcpRecvRtt(tcbptr);
+        }
         /* If unacknowledged data remains, reschedule retransmit timer */
         if (seqlt(tcbptr->snduna, tcbptr->sndnxt))
         {
@@ -67,6 +132,8 @@ int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
         }
 
         tcbptr->sndflg |= TCP_FLG_SNDDATA;
+        tcpBufTune(tcbptr);
+        tcpLog(tcbptr, TCP_LOG_ACK, amt);
     }
 
     /* Update send window (if packet is not out of order) */
@@ -76,15 +143,23 @@ int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
     {
         /* Calculate sequence number for end of old and new send window */
         oldend = seqadd(tcbptr->sndwl2, tcbptr->sndwnd);
-        newend = seqadd(tcp->acknum, tcp->window);
+        newend = seqadd(tcp->acknum, window);
 
-        tcbptr->sndwnd = tcp->window;
+        tcbptr->sndwnd = window;
         tcbptr->sndwl1 = tcp->seqnum;
         tcbptr->sndwl2 = tcp->acknum;
 
         /* If window increased, clear persist event */
         if (!seqlte(newend, oldend))
         {
+            if (tcbptr->sndflg & TCP_FLG_PERSIST)
+            {
+                im = disable();
+                closed = tcpTimerNow() * TCP_FREQ - tcbptr->pststart;
+                restore(im);
+                tcbptr->psttotal += closed;
+                tcpLog(tcbptr, TCP_LOG_OPEN, closed);
+            }
             tcpTimerPurge(tcbptr, TCP_EVT_PERSIST);
             tcbptr->sndflg &= ~TCP_FLG_PERSIST;
             tcbptr->sndflg |= TCP_FLG_SNDDATA;
@@ -98,6 +173,43 @@ int tcpRecvAck(struct packet *pkt, struct tcb *tcbptr)
         return OK;
     }
 
-    /* Ignore duplicate ACK */
+    if (!dupack)
+    {
+        return OK;
+    }
+
+    tcbptr->dupacks++;
+    tcbptr->dupackcount++;
+    tcpLog(tcbptr, TCP_LOG_DUPACK, tcbptr->dupacks);
+    if (tcbptr->sndflg & TCP_FLG_RECOVER)
+    {
+        /* Each duplicate means a segment left the network; fill the next
+         * hole, or send new data if the inflated window allows */
+        tcbptr->sndcwn += tcbptr->sndmss;
+        if (0 == tcpSendRecover(tcbptr))
+        {
+            tcbptr->sndflg |= TCP_FLG_SNDDATA;
+        }
+    }
+    else if (TCP_RXT_DUPACKS == tcbptr->dupacks)
+    {
+        /* Fast retransmit, then enter fast recovery */
+        flight = tcpSeqdiff(tcbptr->sndnxt, tcbptr->snduna);
+        tcbptr->sndsst = flight >> 1;
+        if (tcbptr->sndsst < 2 * tcbptr->sndmss)
+        {
+            tcbptr->sndsst = 2 * tcbptr->sndmss;
+        }
+        tcbptr->sndrecover = tcbptr->sndnxt;
+        tcbptr->sndrxtnxt = tcbptr->snduna;
+        tcbptr->sndflg |= TCP_FLG_RECOVER;
+        tcbptr->recoveries++;
+        tcpSendRecover(tcbptr);
+        tcbptr->sndcwn = tcbptr->sndsst + TCP_RXT_DUPACKS * tcbptr->sndmss;
+        tcpLog(tcbptr, TCP_LOG_FAST, flight);
+        tcpTimerPurge(tcbptr, TCP_EVT_RXT);
+        tcpTimerSched(tcbptr->rxttime, tcbptr, TCP_EVT_RXT);
+    }
+
     return OK;
 }
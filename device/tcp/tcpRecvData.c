@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <network.h>
+#include <string.h>
 #include <tcp.h>
 
 /**
@@ -25,11 +26,13 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
     ushort seglen;
 
     uint start;
-    uint i;
-    uint index;
+    uint first;
+    uint more;
+    struct tcpRange *range;
     tcpseq offset;
     uchar *data;
     uint window;
+    bool filled;
 
     /* Setup packet pointers */
     tcp = (struct tcpPkt *)pkt->curr;
@@ -61,7 +64,7 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
             else
             {
                 offset = tcpSeqdiff(tcp->seqnum, tcbptr->rcvnxt);
-                start = (tcbptr->inxt + offset) % TCP_IBLEN;
+                start = (tcbptr->inxt + offset) % tcbptr->ilen;
             }
 
             /* Copy only part of data if not enough buffer space */
@@ -73,13 +76,32 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
                 tcp->control &= ~TCP_CTRL_FIN;
             }
 
-            /* Copy data into buffer */
-            for (i = 0; i < seglen; i++)
+            /* ACK out-of-order data at once, so the sender sees a
+             * duplicate ACK, and keep it only if its range can be
+             * recorded */
+            if (start != tcbptr->inxt)
             {
-                index = (start + i) % TCP_IBLEN;
-                tcbptr->in[index] = data[i];
-                tcbptr->imark[index] = TRUE;
+                tcbptr->sndflg |= TCP_FLG_SNDACK;
+                if ((0 == seglen)
+                    || (SYSERR == tcpRangeAdd(tcbptr->rcvrange,
+                                              &tcbptr->rcvnrange,
+                                              tcp->seqnum,
+                                              seqadd(tcp->seqnum, seglen))))
+                {
+                    break;
+                }
+                tcbptr->rcvsack = tcp->seqnum;
+            }
+
+            /* Copy data into buffer, in at most two pieces around the
+             * wrap of the circular buffer */
+            first = tcbptr->ilen - start;
+            if (first > seglen)
+            {
+                first = seglen;
             }
+            memcpy(&tcbptr->in[start], data, first);
+            memcpy(&tcbptr->in[0], data + first, seglen - first);
 
             /* If started at begnning of window, we can ACK */
             if (start == tcbptr->inxt)
@@ -87,25 +109,36 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
                 /* ACK at least current data */
                 tcbptr->icount += seglen;
                 tcbptr->ibytes += seglen;
-                tcbptr->inxt = (tcbptr->inxt + seglen) % TCP_IBLEN;
+                tcbptr->inxt = (tcbptr->inxt + seglen) % tcbptr->ilen;
                 tcbptr->rcvnxt = seqadd(tcbptr->rcvnxt, seglen);
+                tcbptr->rcvunacked += seglen;
 
-                /* Keep going until data is missing */
-                while ((tcbptr->icount < TCP_IBLEN)
-                       && (tcbptr->imark[tcbptr->inxt]))
+                /* Keep going while out-of-order data fills the hole */
+                range = tcbptr->rcvrange;
+                filled = (tcbptr->rcvnrange > 0);
+                while ((tcbptr->rcvnrange > 0)
+                       && seqlte(range[0].start, tcbptr->rcvnxt))
                 {
-                    tcbptr->icount++;
-                    tcbptr->ibytes++;
-                    tcbptr->inxt = (tcbptr->inxt + 1) % TCP_IBLEN;
-                    tcbptr->rcvnxt = seqadd(tcbptr->rcvnxt, 1);
-
-                    /* If FIN has been seen, stop when we reach it */
-                    if ((tcbptr->rcvflg & TCP_FLG_FIN)
-                        && (tcbptr->rcvnxt == tcbptr->rcvfin))
+                    if (seqlt(tcbptr->rcvnxt, range[0].end))
                     {
-                        tcp->control |= TCP_CTRL_FIN;
-                        break;
+                        more = tcpSeqdiff(range[0].end, tcbptr->rcvnxt);
+                        tcbptr->icount += more;
+                        tcbptr->ibytes += more;
+                        tcbptr->inxt =
+                            (tcbptr->inxt + more) % tcbptr->ilen;
+                        tcbptr->rcvnxt = range[0].end;
+                        tcbptr->rcvunacked += more;
                     }
+                    tcbptr->rcvnrange--;
+                    memmove(&range[0], &range[1],
+                            tcbptr->rcvnrange * sizeof(*range));
+                }
+
+                /* If FIN has been seen, stop when we reach it */
+                if ((tcbptr->rcvflg & TCP_FLG_FIN)
+                    && (tcbptr->rcvnxt == tcbptr->rcvfin))
+                {
+                    tcp->control |= TCP_CTRL_FIN;
                 }
 
                 /* Signal readers */
@@ -114,7 +147,21 @@ int tcpRecvData(struct packet *pkt, struct tcb *tcbptr)
                     signal(tcbptr->readers);
                 }
 
-                tcbptr->sndflg |= TCP_FLG_SNDACK;
+                tcpBufTune(tcbptr);
+
+                /* ACK every second full segment, or data that filled a
+                 * hole, at once; otherwise delay the ACK in the hope it
+                 * rides on outbound data (RFC 1122, 4.2.3.2) */
+                if (filled || (tcbptr->rcvunacked
+                               >= TCP_DELACK_SEGS * tcbptr->rcvmss))
+                {
+                    tcbptr->sndflg |= TCP_FLG_SNDACK;
+                }
+                else if (!(tcbptr->sndflg & TCP_FLG_DELACK))
+                {
+                    tcbptr->sndflg |= TCP_FLG_DELACK;
+                    tcpTimerSched(TCP_DELACK_TIME, tcbptr, TCP_EVT_DELACK);
+                }
             }
 
             break;
@@ -5,9 +5,12 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <mib.h>
 #include <network.h>
 #include <tcp.h>
 
+static int tcpRecvSyn(struct packet *, struct tcb *, struct netaddr *);
+
 /**
  * @ingroup tcp
  *
@@ -22,6 +25,7 @@ int tcpRecvListen(struct packet *pkt, struct tcb *tcbptr,
                   struct netaddr *src)
 {
     struct tcpPkt *tcp;
+    struct tcb *child;
 
     /* Setup packet pointers */
     tcp = (struct tcpPkt *)pkt->curr;
@@ -42,42 +46,90 @@ int tcpRecvListen(struct packet *pkt, struct tcb *tcbptr,
     /* Should receive a SYN */
     if (tcp->control & TCP_CTRL_SYN)
     {
-        /* Update receive information */
-        tcbptr->rcvnxt = seqadd(tcp->seqnum, 1);
-        tcbptr->rcvwnd = seqadd(tcp->seqnum, TCP_INIT_WND);
-        tcbptr->rcvflg |= TCP_FLG_SYN;
-        tcbptr->sndflg |= TCP_FLG_SNDACK;
-
-        /* Finish specifying connection, if not already set */
-        if (NULL == tcbptr->remotept)
-        {
-            tcbptr->remotept = tcp->srcpt;
-        }
-        if (NULL == tcbptr->remoteip.type)
+        /* A listener with a backlog stays listening and answers in a new
+         * TCB; past its backlog the SYN is dropped, so the remote side
+         * retransmits it rather than being reset */
+        if (tcbptr->backlog > 0)
         {
-            netaddrcpy(&tcbptr->remoteip, src);
+            if (tcbptr->qlen >= tcbptr->backlog)
+            {
+                TCP_TRACE("Backlog full");
+                return OK;
+            }
+            child = tcpSpawn(tcbptr, src, tcp->srcpt);
+            if (NULL == child)
+            {
+                return OK;
+            }
+            tcpRecvOpts(pkt, child);
+            if (TCP_ERR_RESET == tcpRecvSyn(pkt, child, src))
+            {
+                tcpFree(child);
+                return OK;
+            }
+            signal(child->mutex);
+            return OK;
         }
 
-        /* Update send information */
-        tcbptr->sndwnd = tcp->window;
-        tcbptr->sndwl1 = tcp->seqnum;
+        return tcpRecvSyn(pkt, tcbptr, src);
+    }
 
-        /* Attempt to send SYN */
-        tcpSendSyn(tcbptr);
+    /* Should not get here, but if so drop segment and return */
+    return OK;
+}
 
-        /* Ack if needed */
-        if (tcbptr->sndflg & TCP_FLG_SNDACK)
-        {
-            tcpSendAck(tcbptr);
-        }
+/**
+ * Answers a SYN, moving a TCB from LISTEN to SYNRECV.
+ * @param pkt incoming packet
+ * @param tcbptr pointer to transmission control block for connection
+ * @param src source IP address
+ * @return result of processing the rest of the segment
+ * @pre-condition TCB mutex is already held
+ * @post-condition TCB mutex is still held
+ */
+static int tcpRecvSyn(struct packet *pkt, struct tcb *tcbptr,
+                      struct netaddr *src)
+{
+    struct tcpPkt *tcp;
+
+    tcp = (struct tcpPkt *)pkt->curr;
 
-        /* Change state */
-        tcbptr->state = TCP_SYNRECV;
+    /* Update receive information */
+    tcbptr->rcvnxt = seqadd(tcp->seqnum, 1);
+    tcbptr->rcvwnd = seqadd(tcp->seqnum, TCP_INIT_WND);
+    tcbptr->rcvflg |= TCP_FLG_SYN;
+    tcbptr->sndflg |= TCP_FLG_SNDACK;
 
-        /* Processing remaining controls and data */
-        return tcpRecvData(pkt, tcbptr);
+    /* Finish specifying connection, if not already set, and move
+     * the TCB to the connection table under its full 4-tuple */
+    tcpHashRemove(tcbptr);
+    if (NULL == tcbptr->remotept)
+    {
+        tcbptr->remotept = tcp->srcpt;
+    }
+    if (NULL == tcbptr->remoteip.type)
+    {
+        netaddrcpy(&tcbptr->remoteip, src);
     }
+    tcpHashInsert(tcbptr);
 
-    /* Should not get here, but if so drop segment and return */
-    return OK;
+    /* Update send information */
+    tcbptr->sndwnd = tcp->window;
+    tcbptr->sndwl1 = tcp->seqnum;
+
+    /* Attempt to send SYN */
+    tcpSendSyn(tcbptr);
+
+    /* Ack if needed */
+    if (tcbptr->sndflg & TCP_FLG_SNDACK)
+    {
+        tcpSendAck(tcbptr);
+    }
+
+    /* Change state */
+    tcbptr->state = TCP_SYNRECV;
+    mib.tcp.passiveOpens++;
+
+    /* Processing remaining controls and data */
+    return tcpRecvData(pkt, tcbptr);
 }
@@ -23,9 +23,20 @@ int tcpRecvOpts(struct packet *pkt, struct tcb *tcbptr)
     uchar *options;
     uchar *endopt;
     struct tcpPkt *tcp;
+    tcpseq start, end;
+    uchar len;
 
     tcp = (struct tcpPkt *)pkt->curr;
 
+    /* A SYN renegotiates SACK and window scaling; each is used only if
+     * the SYN offers it */
+    if (tcp->control & TCP_CTRL_SYN)
+    {
+        tcbptr->rcvflg &= ~(TCP_FLG_SACKOK | TCP_FLG_WSCALE);
+        tcbptr->sndscale = 0;
+        tcbptr->rcvscale = 0;
+    }
+
     /* Check if the header contains options */
     if (offset2octets(tcp->offset) == TCP_HDR_LEN)
     {
@@ -37,7 +48,7 @@ int tcpRecvOpts(struct packet *pkt, struct tcb *tcbptr)
     endopt = options + (offset2octets(tcp->offset) - TCP_HDR_LEN);
 
     /* Keep handling options until end of otpion list is encountered */
-    while ((*options != TCP_OPT_END) && (options < endopt))
+    while ((options < endopt) && (*options != TCP_OPT_END))
     {
         switch (*options)
         {
@@ -49,16 +60,69 @@ int tcpRecvOpts(struct packet *pkt, struct tcb *tcbptr)
              * a short.  Discovered by RB on 7/2.
              * FIXED by AG on 8/10.
              * TODO: add test case with non-word aligned opts
+             * The value is in network order, high octet first.
              */
-            tcbptr->sndmss = *options++;
-            tcbptr->sndmss += *options++ << 8;
+            tcbptr->sndmss = *options++ << 8;
+            tcbptr->sndmss += *options++;
             tcbptr->sndmss -= TCP_HDR_LEN;
             break;
-            /* Skip over NOP and unknown options */
+            /* Skip over NOP */
         case TCP_OPT_NOP:
-        default:
             options++;
             break;
+            /* Options with a length: SACK permitted, SACK, window scale,
+             * and unknown */
+        default:
+            len = (options + 1 < endopt) ? options[1] : 0;
+            if ((len < 2) || (options + len > endopt))
+            {
+                /* Malformed, ignore the rest */
+                return OK;
+            }
+            if ((TCP_OPT_SACKOK == *options)
+                && (tcp->control & TCP_CTRL_SYN))
+            {
+                tcbptr->rcvflg |= TCP_FLG_SACKOK;
+            }
+
+            /* Both sides scale windows once both SYNs offer it */
+            if ((TCP_OPT_WSCALE == *options)
+                && (TCP_OPT_WSCALE_LEN == len)
+                && (tcp->control & TCP_CTRL_SYN))
+            {
+                tcbptr->rcvflg |= TCP_FLG_WSCALE;
+                tcbptr->sndscale = options[2];
+                if (tcbptr->sndscale > TCP_OPT_WSCALE_MAX)
+                {
+                    tcbptr->sndscale = TCP_OPT_WSCALE_MAX;
+                }
+                tcbptr->rcvscale = TCP_WSCALE;
+            }
+
+            /* Record blocks SACKed beyond snduna and within what was sent,
+             * as long as room remains to remember them */
+            if ((TCP_OPT_SACK == *options)
+                && (tcbptr->rcvflg & TCP_FLG_SACKOK)
+                && (tcp->control & TCP_CTRL_ACK))
+            {
+                for (len -= TCP_OPT_SACK_LEN, options += TCP_OPT_SACK_LEN;
+                     len >= TCP_OPT_SACK_BLK;
+                     len -= TCP_OPT_SACK_BLK, options += TCP_OPT_SACK_BLK)
+                {
+                    start = (options[0] << 24) | (options[1] << 16)
+                        | (options[2] << 8) | options[3];
+                    end = (options[4] << 24) | (options[5] << 16)
+                        | (options[6] << 8) | options[7];
+                    if (seqlt(tcbptr->snduna, start) && seqlt(start, end)
+                        && seqlte(end, tcbptr->sndnxt))
+                    {
+                        tcpRangeAdd(tcbptr->sndsack, &tcbptr->sndnsack,
+                                    start, end);
+                    }
+                }
+            }
+            options += len;
+            break;
         }
     }
 
@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <interrupt.h>
 #include <network.h>
 #include <tcp.h>
 
@@ -23,6 +24,8 @@ int tcpRecvOther(struct packet *pkt, struct tcb *tcbptr)
 {
     bool segAccept = FALSE;
     struct tcpPkt *tcp;
+    struct tcb **prev;
+    irqmask im;
 
     /* Setup packet pointers */
     tcp = (struct tcpPkt *)pkt->curr;
@@ -52,7 +55,8 @@ int tcpRecvOther(struct packet *pkt, struct tcb *tcbptr)
         case TCP_SYNRECV:
             tcbptr->rxtcount = 0;
             tcpTimerPurge(tcbptr, TCP_EVT_RXT);
-            if (TCP_PASSIVE == tcbptr->opentype)
+            if ((TCP_PASSIVE == tcbptr->opentype)
+                && (NULL == tcbptr->listener))
             {
                 tcbptr->state = TCP_LISTEN;
                 return OK;
@@ -94,7 +98,23 @@ int tcpRecvOther(struct packet *pkt, struct tcb *tcbptr)
             && seqlte(tcp->acknum, tcbptr->sndnxt))
         {
             tcbptr->state = TCP_ESTAB;
-            signal(tcbptr->openclose);  /* Signal connection open */
+            if (NULL == tcbptr->listener)
+            {
+                signal(tcbptr->openclose);  /* Signal connection open */
+            }
+            else
+            {
+                /* Queue connection for its listener to accept */
+                im = disable();
+                prev = &tcbptr->listener->acceptq;
+                while (NULL != *prev)
+                {
+                    prev = &(*prev)->anext;
+                }
+                *prev = tcbptr;
+                restore(im);
+                signal(tcbptr->listener->openclose);
+            }
         }
         else
         {
@@ -37,6 +37,19 @@ int tcpRecvRtt(struct tcb *tcbptr)
         {
             tcbptr->rxttime = TCP_RXT_MINTIME;
         }
+
+        /* Keep statistics on the samples */
+        if ((0 == tcbptr->rttcount) || (rtt < tcbptr->rttmin))
+        {
+            tcbptr->rttmin = rtt;
+        }
+        if (rtt > tcbptr->rttmax)
+        {
+            tcbptr->rttmax = rtt;
+        }
+        tcbptr->rttcount++;
+        tcbptr->rttsum += rtt;
+        tcpLog(tcbptr, TCP_LOG_RTT, rtt);
     }
 
     /* Handle slow start/congestion window increase */
@@ -53,5 +66,9 @@ int tcpRecvRtt(struct tcb *tcbptr)
         tcbptr->sndcwn +=
             (tcbptr->sndmss * tcbptr->sndmss) / tcbptr->sndcwn;
     }
+    if (tcbptr->sndcwn > tcbptr->cwnmax)
+    {
+        tcbptr->cwnmax = tcbptr->sndcwn;
+    }
     return OK;
 }
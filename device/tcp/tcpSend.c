@@ -6,10 +6,13 @@
 
 #include <stddef.h>
 #include <memory.h>
+#include <mib.h>
 #include <stdlib.h>
 #include <string.h>
 #include <tcp.h>
 
+static void tcpSendSack(struct tcb *, uchar *, uint);
+
 /**
  * @ingroup tcp
  *
@@ -31,17 +34,42 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
     int result;
     uchar *data;
     uint i = 0;
-    ushort window = 0;
-    ushort msslen = 0;
+    uint window = 0;
+    ushort optlen = 0;
     ushort tcplen;
+    bool sackok = FALSE;
+    bool wscale = FALSE;
+    uint nsack = 0;
 
-    /* If SYN is set, then don't include in datalen, but include MSS */
+    /* If SYN is set, then don't include in datalen, but include MSS and
+     * offer SACK and window scaling, unless answering a SYN that did not
+     * offer them */
     if (ctrl & TCP_CTRL_SYN)
     {
         datalen--;
-        msslen = ((3 + TCP_OPT_MSS_SIZE) & ~0x03);
+        optlen = TCP_OPT_MSS_LEN;
+        if (!(ctrl & TCP_CTRL_ACK) || (tcbptr->rcvflg & TCP_FLG_SACKOK))
+        {
+            sackok = TRUE;
+            optlen += 2 + TCP_OPT_SACKOK_LEN;
+        }
+        if (!(ctrl & TCP_CTRL_ACK) || (tcbptr->rcvflg & TCP_FLG_WSCALE))
+        {
+            wscale = TRUE;
+            optlen += 1 + TCP_OPT_WSCALE_LEN;
+        }
         TCP_TRACE("No SYN in datalen, include MSS");
     }
+    /* Otherwise report out-of-order data, if the remote side allows SACK */
+    else if ((tcbptr->rcvflg & TCP_FLG_SACKOK) && (tcbptr->rcvnrange > 0))
+    {
+        nsack = tcbptr->rcvnrange;
+        if (nsack > TCP_OPT_SACK_MAX)
+        {
+            nsack = TCP_OPT_SACK_MAX;
+        }
+        optlen = 2 + TCP_OPT_SACK_LEN + nsack * TCP_OPT_SACK_BLK;
+    }
     /* If FIN is set, then don't include in datalen */
     if (ctrl & TCP_CTRL_FIN)
     {
@@ -50,7 +78,7 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
     }
 
     /* Get space to construct packet */
-    tcplen = TCP_HDR_LEN + datalen + msslen;
+    tcplen = TCP_HDR_LEN + datalen + optlen;
     if (tcplen > NET_MAX_PKTLEN)
     {
         TCP_TRACE("Packet too large");
@@ -63,8 +91,9 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
         return SYSERR;
     }
 
-    /* Back off end of buffer to add TCP packet, preserving word alignment */
-    pkt->curr -= (tcplen + 0x7) & ~0x7;
+    /* Back off end of buffer to add TCP header, preserving word alignment;
+     * the payload is sent from the output buffer as segments */
+    pkt->curr -= (TCP_HDR_LEN + optlen + 0x7) & ~0x7;
     pkt->len = tcplen;
 
     /* Set TCP header fields */
@@ -73,33 +102,67 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
     tcp->dstpt = tcbptr->remotept;
     tcp->seqnum = seqnum;
     tcp->acknum = acknum;
-    tcp->offset = octets2offset(TCP_HDR_LEN + msslen);
+    tcp->offset = octets2offset(TCP_HDR_LEN + optlen);
     tcp->control = ctrl;
-    tcp->window = tcpSendWindow(tcbptr);
-    window = tcp->window;
+    window = tcpSendWindow(tcbptr);
+    tcp->window = (ctrl & TCP_CTRL_SYN) ? window
+        : window >> tcbptr->rcvscale;
+    tcp->chksum = 0;
+    tcp->urgent = 0;
     data = tcp->data;
 
     /* Add options */
-    if (msslen)
+    if (ctrl & TCP_CTRL_SYN)
     {
+        /* Packet buffers are not zeroed, so pad the option area explicitly */
+        memset(data, TCP_OPT_END, optlen);
         *data++ = TCP_OPT_MSS;
         *data++ = TCP_OPT_MSS_LEN;
-        *((ushort *)data) = hs2net((tcbptr->rcvmss + TCP_HDR_LEN));
-        data += TCP_OPT_MSS_LEN;
-        for (i = (TCP_OPT_MSS_LEN % 4); i > 1; i--)
+        *data++ = (tcbptr->rcvmss + TCP_HDR_LEN) >> 8;
+        *data++ = (tcbptr->rcvmss + TCP_HDR_LEN) & 0xFF;
+        if (sackok)
         {
             *data++ = TCP_OPT_NOP;
+            *data++ = TCP_OPT_NOP;
+            *data++ = TCP_OPT_SACKOK;
+            *data++ = TCP_OPT_SACKOK_LEN;
+        }
+        if (wscale)
+        {
+            *data++ = TCP_OPT_NOP;
+            *data++ = TCP_OPT_WSCALE;
+            *data++ = TCP_OPT_WSCALE_LEN;
+            *data++ = TCP_WSCALE;
         }
-        *data++ = TCP_OPT_END;
         TCP_TRACE("Added MSS");
     }
+    else if (nsack > 0)
+    {
+        *data++ = TCP_OPT_NOP;
+        *data++ = TCP_OPT_NOP;
+        *data++ = TCP_OPT_SACK;
+        *data++ = TCP_OPT_SACK_LEN + nsack * TCP_OPT_SACK_BLK;
+        tcpSendSack(tcbptr, data, nsack);
+        TCP_TRACE("Added %u SACK blocks", nsack);
+    }
 
-    /* Copy data into packet */
+    /* Reference data in the output buffer, split where it wraps */
     if (datalen > 0)
     {
-        for (i = 0; i < datalen; i++)
+        datastart %= tcbptr->olen;
+        i = tcbptr->olen - datastart;
+        if (i > datalen)
         {
-            *data++ = tcbptr->out[(datastart + i) % TCP_OBLEN];
+            i = datalen;
+        }
+        pkt->seg[0].data = &tcbptr->out[datastart];
+        pkt->seg[0].len = i;
+        pkt->nseg = 1;
+        if (i < datalen)
+        {
+            pkt->seg[1].data = &tcbptr->out[0];
+            pkt->seg[1].len = datalen - i;
+            pkt->nseg = 2;
         }
     }
 
@@ -124,8 +187,22 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
         return SYSERR;
     }
 
+    /* Any ACK sent covers a delayed one */
+    if (ctrl & TCP_CTRL_ACK)
+    {
+        if (tcbptr->sndflg & TCP_FLG_DELACK)
+        {
+            tcpTimerPurge(tcbptr, TCP_EVT_DELACK);
+        }
+        tcbptr->sndflg &= ~(TCP_FLG_SNDACK | TCP_FLG_DELACK);
+        tcbptr->rcvunacked = 0;
+    }
+
     if (result == OK)
     {
+        mib.tcp.outSegs++;
+        tcbptr->sndsegs++;
+        tcbptr->sndoctets += datalen;
         TCP_TRACE("SENT <C=0x%02X><S=%u><A=%u><dl=%u><w=%u>",
                       ctrl, seqnum, acknum, datalen, window)
     }
@@ -137,3 +214,51 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
 
     return result;
 }
+
+/**
+ * Writes SACK blocks for the out-of-order data of a TCP connection, the
+ * range holding the latest out-of-order segment first (RFC 2018).
+ * @param tcbptr pointer to the transmission control block for connection
+ * @param data where the blocks go
+ * @param nsack number of blocks to write
+ */
+static void tcpSendSack(struct tcb *tcbptr, uchar *data, uint nsack)
+{
+    struct tcpRange *range = tcbptr->rcvrange;
+    uint latest = 0;
+    uint i, j;
+    tcpseq seq;
+
+    for (i = 0; i < tcbptr->rcvnrange; i++)
+    {
+        if (seqlte(range[i].start, tcbptr->rcvsack)
+            && seqlt(tcbptr->rcvsack, range[i].end))
+        {
+            latest = i;
+        }
+    }
+
+    for (i = 0; i < nsack; i++)
+    {
+        /* Latest range, then the others in sequence order */
+        if (0 == i)
+        {
+            j = latest;
+        }
+        else
+        {
+            j = (i <= latest) ? i - 1 : i;
+        }
+
+        seq = range[j].start;
+        *data++ = seq >> 24;
+        *data++ = seq >> 16;
+        *data++ = seq >> 8;
+        *data++ = seq;
+        seq = range[j].end;
+        *data++ = seq >> 24;
+        *data++ = seq >> 16;
+        *data++ = seq >> 8;
+        *data++ = seq;
+    }
+}
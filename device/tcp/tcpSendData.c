@@ -5,13 +5,16 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <interrupt.h>
 #include <tcp.h>
 
 /**
  * @ingroup tcp
  *
  * Sends pending outbound data (including SYN and FIN) for a TCP connection, 
- * if new data is ready for transmission.
+ * if new data is ready for transmission.  Any ACK owed rides on the data.
+ * A partial segment is held back while earlier data is unacknowledged,
+ * unless ::TCP_FLG_NODELAY is set, or at all while ::TCP_FLG_CORK is.
  * @param tcpptr pointer to the transmission control block for connection
  * @return number of octets sent
  * @pre-condition TCB mutex is already held
@@ -23,7 +26,9 @@ int tcpSendData(struct tcb *tcbptr)
     uint pending;      /**< amount of data pending ACK or transmission */
     uint tosend;
     uint sent;
+    uint window;       /**< lesser of send and congestion window */
     uchar ctrl;
+    irqmask im;
 
     /* Verify sender MSS is greater than 0 */
     if (tcbptr->sndmss == 0)
@@ -50,12 +55,24 @@ int tcpSendData(struct tcb *tcbptr)
         tcbptr->sndflg |= TCP_FLG_PERSIST;
         tcbptr->psttime = TCP_PST_INITTIME;
         tcpTimerSched(tcbptr->psttime, tcbptr, TCP_EVT_PERSIST);
+        im = disable();
+        tcbptr->pststart = tcpTimerNow() * TCP_FREQ;
+        restore(im);
+        tcbptr->zerownds++;
+        tcpLog(tcbptr, TCP_LOG_PERSIST, 0);
         return 0;
     }
 
+    /* Send no more than the receiver and the congestion window allow */
+    window = tcbptr->sndwnd;
+    if (window > tcbptr->sndcwn)
+    {
+        window = tcbptr->sndcwn;
+    }
+
     /* Check if new transmssion is allowed */
-    /* If (SNDNXT >= SNDUNA + SNDWND), then can't send data */
-    if (seqlte(seqadd(tcbptr->snduna, tcbptr->sndwnd), tcbptr->sndnxt))
+    /* If (SNDNXT >= SNDUNA + WINDOW), then can't send data */
+    if (seqlte(seqadd(tcbptr->snduna, window), tcbptr->sndnxt))
     {
         return 0;
     }
@@ -80,9 +97,9 @@ int tcpSendData(struct tcb *tcbptr)
     /* There is data to send and space in the window to send it */
     ctrl = TCP_CTRL_ACK;
     /* Determine how much data to send */
-    if (pending > tcbptr->sndwnd)
+    if (pending > window)
     {
-        tosend = tcbptr->sndwnd - wndused;
+        tosend = window - wndused;
     }
     else
     {
@@ -98,30 +115,40 @@ int tcpSendData(struct tcb *tcbptr)
     while (tosend > tcbptr->sndmss)
     {
         tcpSend(tcbptr, TCP_CTRL_ACK, tcbptr->sndnxt, tcbptr->rcvnxt,
-                (tcbptr->ostart + wndused) % TCP_OBLEN, tcbptr->sndmss);
+                (tcbptr->ostart + wndused) % tcbptr->olen,
+                tcbptr->sndmss);
         tosend -= tcbptr->sndmss;
         sent += tcbptr->sndmss;
         wndused += tcbptr->sndmss;
         tcbptr->sndnxt = seqadd(tcbptr->sndnxt, tcbptr->sndmss);
     }
 
-    /* Send the remainder of the sendable data */
-    tcpSend(tcbptr, ctrl, tcbptr->sndnxt, tcbptr->rcvnxt,
-            (tcbptr->ostart + wndused) % TCP_OBLEN, tosend);
-    sent += tosend;
-    wndused += tosend;
-    tcbptr->sndnxt = seqadd(tcbptr->sndnxt, tosend);
+    /* Hold back a partial segment, unless it carries the FIN: Nagle's
+     * algorithm waits for outstanding data to be ACKed, a cork for the
+     * segment to fill (RFC 896) */
+    if ((tosend < tcbptr->sndmss) && !(ctrl & TCP_CTRL_FIN)
+        && ((tcbptr->sndflg & TCP_FLG_CORK)
+            || (!(tcbptr->sndflg & TCP_FLG_NODELAY)
+                && seqlt(tcbptr->snduna, tcbptr->sndnxt))))
+    {
+        tosend = 0;
+    }
 
-    /* If one does not already exist, schedule a retransmission event */
-    if (tcpTimerRemain(tcbptr, TCP_EVT_RXT) <= 0)
+    /* Send the remainder of the sendable data */
+    if ((tosend > 0) || (ctrl & TCP_CTRL_FIN))
     {
-        tcpTimerSched(tcbptr->rxttime, tcbptr, TCP_EVT_RXT);
+        tcpSend(tcbptr, ctrl, tcbptr->sndnxt, tcbptr->rcvnxt,
+                (tcbptr->ostart + wndused) % tcbptr->olen, tosend);
+        sent += tosend;
+        wndused += tosend;
+        tcbptr->sndnxt = seqadd(tcbptr->sndnxt, tosend);
     }
 
-    /* No longer need to ACK if data was sent, since ACK was piggybacked */
-    if (sent > 0)
+    /* If one does not already exist, schedule a retransmission event */
+    if (seqlt(tcbptr->snduna, tcbptr->sndnxt)
+        && (tcpTimerRemain(tcbptr, TCP_EVT_RXT) <= 0))
     {
-        tcbptr->sndflg &= ~TCP_FLG_SNDACK;
+        tcpTimerSched(tcbptr->rxttime, tcbptr, TCP_EVT_RXT);
     }
 
     tcbptr->sndflg &= ~TCP_FLG_SNDDATA;
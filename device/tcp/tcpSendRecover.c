@@ -0,0 +1,86 @@
+/**
+ * @file tcpSendRecover.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <mib.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Retransmits, during fast recovery, one segment from the next hole in the
+ * data the receiver holds.  Holes are found by stepping over the ranges
+ * the receiver has selectively acknowledged, starting from where the last
+ * retransmission ended.  Without SACK information only the segment at
+ * snduna is treated as lost, as in NewReno.
+ * @param tcbptr pointer to the transmission control block for connection
+ * @return number of octets sent, 0 if no hole remains
+ * @pre-condition TCB mutex is already held
+ * @post-condition TCB mutex is still held
+ */
+int tcpSendRecover(struct tcb *tcbptr)
+{
+    struct tcpRange *sack = tcbptr->sndsack;
+    tcpseq seq;
+    uint tosend;
+    uint i;
+    uchar control = TCP_CTRL_ACK;
+
+    /* Start after what was already retransmitted */
+    seq = tcbptr->sndrxtnxt;
+    if (seqlt(seq, tcbptr->snduna))
+    {
+        seq = tcbptr->snduna;
+    }
+
+    /* Step over SACKed data; the hole ends where the next range begins */
+    for (i = 0; i < tcbptr->sndnsack; i++)
+    {
+        if (seqlt(seq, sack[i].start))
+        {
+            break;
+        }
+        if (seqlt(seq, sack[i].end))
+        {
+            seq = sack[i].end;
+        }
+    }
+
+    /* Data above the highest SACKed range is not known to be lost */
+    if (i < tcbptr->sndnsack)
+    {
+        tosend = tcpSeqdiff(sack[i].start, seq);
+    }
+    else if ((seq == tcbptr->snduna) && seqlt(seq, tcbptr->sndnxt))
+    {
+        tosend = tcpSeqdiff(tcbptr->sndnxt, seq);
+    }
+    else
+    {
+        return 0;
+    }
+    if (tosend > tcbptr->sndmss)
+    {
+        tosend = tcbptr->sndmss;
+    }
+
+    /* Determine if FIN falls in the retransmitted segment */
+    if ((tcbptr->sndflg & TCP_FLG_FIN)
+        && seqlte(seq, tcbptr->sndfin)
+        && seqlt(tcbptr->sndfin, seqadd(seq, tosend)))
+    {
+        control |= TCP_CTRL_FIN;
+    }
+
+    mib.tcp.retransSegs++;
+    tcbptr->fastsegs++;
+    tcpSend(tcbptr, control, seq, tcbptr->rcvnxt,
+            tcbptr->ostart + tcpSeqdiff(seq, tcbptr->snduna), tosend);
+    tcbptr->sndrxtnxt = seqadd(seq, tosend);
+    tcpLog(tcbptr, TCP_LOG_RECOVER, tosend);
+
+    return tosend;
+}
@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <ipv4.h>
+#include <mib.h>
 #include <network.h>
 #include <tcp.h>
 
@@ -52,6 +53,9 @@ int tcpSendRst(struct packet *pkt, struct netaddr *src,
     outtcp->dstpt = tcp->srcpt;
     outtcp->offset = octets2offset(TCP_HDR_LEN);
     outtcp->control = TCP_CTRL_RST;
+    outtcp->window = 0;
+    outtcp->chksum = 0;
+    outtcp->urgent = 0;
     if (tcp->control & TCP_CTRL_ACK)
     {
         outtcp->seqnum = tcp->acknum;
@@ -85,6 +89,11 @@ int tcpSendRst(struct packet *pkt, struct netaddr *src,
 
     /* Send TCP packet */
     result = ipv4Send(out, src, dst, IPv4_PROTO_TCP);
+    if (OK == result)
+    {
+        mib.tcp.outSegs++;
+        mib.tcp.outRsts++;
+    }
 
     if (SYSERR == netFreebuf(out))
     {
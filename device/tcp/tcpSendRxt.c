@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <mib.h>
 #include <tcp.h>
 
 /**
@@ -48,6 +49,10 @@ int tcpSendRxt(struct tcb *tcbptr)
         return 0;
     }
 
+    /* A timeout ends fast recovery */
+    tcbptr->sndflg &= ~TCP_FLG_RECOVER;
+    tcbptr->dupacks = 0;
+
     /* Reschedule retransmit event */
     time = tcbptr->rxttime << tcbptr->rxtcount;
     if (time > TCP_RXT_MAXTIME)
@@ -66,6 +71,8 @@ int tcpSendRxt(struct tcb *tcbptr)
             control |= TCP_CTRL_ACK;
         }
         /* Retransmit SYN */
+        mib.tcp.retransSegs++;
+        tcbptr->rxtsegs++;
         tcpSend(tcbptr, control, tcbptr->snduna, tcbptr->rcvnxt, 0, 1);
 
         signal(tcbptr->mutex);
@@ -93,6 +100,8 @@ int tcpSendRxt(struct tcb *tcbptr)
     }
 
     /* Send data */
+    mib.tcp.retransSegs++;
+    tcbptr->rxtsegs++;
     tcpSend(tcbptr, control, tcbptr->snduna, tcbptr->rcvnxt,
             tcbptr->ostart, tosend);
 
@@ -114,6 +123,7 @@ int tcpSendRxt(struct tcb *tcbptr)
         tcbptr->sndsst = tcbptr->sndmss;
     }
     tcbptr->sndcwn = tcbptr->sndmss;
+    tcpLog(tcbptr, TCP_LOG_RTO, tcbptr->rxtcount);
 
     signal(tcbptr->mutex);
     return tosend;
@@ -11,17 +11,20 @@
  * @ingroup tcp
  *
  * Calculates the window size to advertise in an outgoing TCP packet.
+ * Outside a SYN the window is sent shifted right by rcvscale, so it is
+ * kept to what the 16-bit field can carry at that scale.
  * @param tcbptr pointer to transmission control block for connection
+ * @return window in octets, before scaling
  * @pre-condition TCB mutex is already held
  * @post-condition TCB mutex is still held
  */
-ushort tcpSendWindow(struct tcb *tcbptr)
+uint tcpSendWindow(struct tcb *tcbptr)
 {
-    ushort unused = 0;
-    ushort window = 0;
+    uint unused = 0;
+    uint window = 0;
 
     /* Set proposed window to maximum possible */
-    window = TCP_IBLEN - tcbptr->icount;        // Correct?
+    window = tcbptr->ilen - tcbptr->icount;        // Correct?
 
     switch (tcbptr->state)
     {
@@ -31,14 +34,26 @@ ushort tcpSendWindow(struct tcb *tcbptr)
     case TCP_LISTEN:
     case TCP_SYNSENT:
     case TCP_SYNRECV:
-        /* Don't do receiver-side silly window syndrome avoidance */
+        /* Don't do receiver-side silly window syndrome avoidance; the
+         * window in a SYN is never scaled */
+        if (window > TCP_MAX_WND)
+        {
+            window = TCP_MAX_WND;
+        }
         tcbptr->rcvwnd = seqadd(tcbptr->rcvnxt, window);
         return window;
     }
 
+    /* Keep to whole units of the window scale */
+    if (window > (TCP_MAX_WND << tcbptr->rcvscale))
+    {
+        window = TCP_MAX_WND << tcbptr->rcvscale;
+    }
+    window &= ~((1 << tcbptr->rcvscale) - 1);
+
     /* Receiver-side silly window syndrome avoidance */
     /* Calculate unsued portion of currently advertised window */
-    unused = (ushort)tcpSeqdiff(tcbptr->rcvwnd, tcbptr->rcvnxt);
+    unused = tcpSeqdiff(tcbptr->rcvwnd, tcbptr->rcvnxt);
 #ifdef TCP_FAKEACK
     if (seqlt(tcbptr->rcvwnd, tcbptr->rcvnxt))
     {
@@ -46,7 +61,7 @@ ushort tcpSendWindow(struct tcb *tcbptr)
     }
 #endif
     /* Use 0 if proposed window less than 1/4 buffer or less than 1 MSS */
-    if (((window * 4) < TCP_IBLEN) || (window < tcbptr->rcvmss))
+    if (((window * 4) < tcbptr->ilen) || (window < tcbptr->rcvmss))
     {
         window = 0;
     }
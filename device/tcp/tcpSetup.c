@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <clock.h>
+#include <memory.h>
 #include <network.h>
 #include <semaphore.h>
 #include <tcp.h>
@@ -32,11 +33,42 @@ int tcpSetup(struct tcb *tcbptr)
     /* Intialize connection semaphore */
     tcbptr->openclose = semcreate(0);
 
+    /* Allocate buffers, unless still held from an earlier passive open;
+     * they start small and are auto-tuned from there */
+    if (NULL == tcbptr->in)
+    {
+        tcbptr->ilen = TCP_IBLEN;
+        tcbptr->in = memget(TCP_IBLEN);
+    }
+    if (NULL == tcbptr->out)
+    {
+        tcbptr->olen = TCP_OBLEN;
+        tcbptr->out = memget(TCP_OBLEN);
+    }
+    if ((SYSERR == (int)tcbptr->in) || (SYSERR == (int)tcbptr->out))
+    {
+        if (SYSERR == (int)tcbptr->in)
+        {
+            tcbptr->in = NULL;
+        }
+        if (SYSERR == (int)tcbptr->out)
+        {
+            tcbptr->out = NULL;
+        }
+        return SYSERR;
+    }
+    tcbptr->iauto = TRUE;
+    tcbptr->oauto = TRUE;
+    tcbptr->tunetime = 0;
+    tcbptr->tuneibytes = 0;
+    tcbptr->tuneobytes = 0;
+
     /* Initialize input buffer */
     tcbptr->istart = 0;
     tcbptr->inxt = 0;
     tcbptr->icount = 0;
     tcbptr->ibytes = 0;
+    tcbptr->rcvnrange = 0;
     tcbptr->readers = semcreate(0);
 
     /* Initialize output buffer */
@@ -53,14 +85,23 @@ int tcpSetup(struct tcb *tcbptr)
     tcbptr->sndmss = TCP_INIT_MSS;
     tcbptr->sndflg = NULL;
     tcbptr->sndcwn = tcbptr->sndmss;
-    tcbptr->sndsst = TCP_MAX_WND;
+    tcbptr->sndsst = TCP_MAX_WND << TCP_WSCALE;
+    tcbptr->sndscale = 0;
     tcbptr->rxttime = TCP_RXT_INITTIME;
     tcbptr->rxtcount = 0;
     tcbptr->psttime = TCP_PST_INITTIME;
+    tcbptr->dupacks = 0;
+    tcbptr->sndrecover = tcbptr->iss;
+    tcbptr->sndrxtnxt = tcbptr->iss;
+    tcbptr->sndnsack = 0;
 
     /* Initialize receive fields */
     tcbptr->rcvmss = TCP_INIT_MSS - TCP_HDR_LEN;
     tcbptr->rcvflg = NULL;
+    tcbptr->rcvscale = 0;
+
+    /* Log events if every connection is logged */
+    tcbptr->log = tcplogall;
 
     /* Verify creation of semaphores */
     if ((SYSERR == (int)tcbptr->openclose)
@@ -0,0 +1,79 @@
+/**
+ * @file tcpSpawn.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <network.h>
+#include <semaphore.h>
+#include <tcp.h>
+
+/**
+ * @ingroup tcp
+ *
+ * Allocates a TCB to answer a SYN that arrived at a listener with a
+ * backlog.  The new TCB takes the listener's local address and the
+ * remote address of the SYN, and counts against the listener's backlog
+ * until it is accepted.
+ * @param listener listening TCB the SYN arrived at
+ * @param remoteip remote IP address of the SYN
+ * @param remotept remote port of the SYN
+ * @return new TCB with its mutex held, NULL if none is free
+ * @pre-condition listener TCB mutex is already held
+ * @post-condition listener TCB mutex is still held
+ */
+struct tcb *tcpSpawn(struct tcb *listener, struct netaddr *remoteip,
+                     ushort remotept)
+{
+    struct tcb *tcbptr = NULL;
+    irqmask im;
+    int i;
+
+    /* Claim a free TCB whose mutex is not held.  Waiting on another TCB's
+     * mutex while holding the listener's could deadlock against a receive
+     * worker doing the same, or stall receive behind an application. */
+    im = disable();
+    for (i = 0; i < NTCP; i++)
+    {
+        if ((TCP_FREE == tcptab[i].devstate)
+            && (semcount(tcptab[i].mutex) > 0))
+        {
+            /* Does not block, the mutex is free */
+            wait(tcptab[i].mutex);
+            tcbptr = &tcptab[i];
+            tcbptr->devstate = TCP_ALLOC;
+            break;
+        }
+    }
+    restore(im);
+    if (NULL == tcbptr)
+    {
+        TCP_TRACE("No TCB for backlog");
+        return NULL;
+    }
+
+    tcbptr->dev = i + TCP0;
+    tcbptr->localpt = listener->localpt;
+    netaddrcpy(&tcbptr->localip, &listener->localip);
+    tcbptr->remotept = remotept;
+    netaddrcpy(&tcbptr->remoteip, remoteip);
+    tcbptr->opentype = TCP_PASSIVE;
+
+    if (SYSERR == tcpSetup(tcbptr))
+    {
+        tcbptr->state = TCP_LISTEN;
+        tcpFree(tcbptr);
+        return NULL;
+    }
+    tcbptr->state = TCP_LISTEN;
+    tcbptr->sndflg |= listener->sndflg & (TCP_FLG_NODELAY | TCP_FLG_CORK);
+
+    im = disable();
+    tcbptr->listener = listener;
+    listener->qlen++;
+    restore(im);
+
+    return tcbptr;
+}
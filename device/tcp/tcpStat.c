@@ -25,8 +25,14 @@ void tcpStat(struct tcb *tcbptr)
     tcpseq rcvnxt, rcvwnd;
     tcpseq snduna, sndnxt;
     uint sndwnd;
-    uint istart, icount, ibytes;
-    uint ostart, ocount, obytes;
+    uint istart, icount, ibytes, ilen;
+    uint ostart, ocount, obytes, olen;
+    uint sndsegs, sndoctets, rcvsegs, rcvoctets;
+    uint rxtsegs, fastsegs, dupackcount, recoveries;
+    uint rttcount, rttsum, rttmin, rttmax;
+    int sndrtt, sndrtd, rxttime;
+    uint sndcwn, sndsst, cwnmax, zerownds;
+    ulong psttotal;
     char strA[20];
     char strB[20];
 
@@ -57,9 +63,32 @@ void tcpStat(struct tcb *tcbptr)
     istart = tcbptr->istart;
     icount = tcbptr->icount;
     ibytes = tcbptr->ibytes;
+    ilen = tcbptr->ilen;
     ostart = tcbptr->ostart;
     ocount = tcbptr->ocount;
     obytes = tcbptr->obytes;
+    olen = tcbptr->olen;
+
+    sndsegs = tcbptr->sndsegs;
+    sndoctets = tcbptr->sndoctets;
+    rcvsegs = tcbptr->rcvsegs;
+    rcvoctets = tcbptr->rcvoctets;
+    rxtsegs = tcbptr->rxtsegs;
+    fastsegs = tcbptr->fastsegs;
+    dupackcount = tcbptr->dupackcount;
+    recoveries = tcbptr->recoveries;
+    rttcount = tcbptr->rttcount;
+    rttsum = tcbptr->rttsum;
+    rttmin = tcbptr->rttmin;
+    rttmax = tcbptr->rttmax;
+    sndrtt = tcbptr->sndrtt;
+    sndrtd = tcbptr->sndrtd;
+    rxttime = tcbptr->rxttime;
+    sndcwn = tcbptr->sndcwn;
+    sndsst = tcbptr->sndsst;
+    cwnmax = tcbptr->cwnmax;
+    zerownds = tcbptr->zerownds;
+    psttotal = tcbptr->psttotal;
 
     signal(tcbptr->mutex);
 
@@ -144,11 +173,35 @@ void tcpStat(struct tcb *tcbptr)
 
     /* Buffers */
     printf("           ");
-    printf("In  Start: %-10u Count: %-10u Read %-10u\n",
-           istart, icount, ibytes);
+    printf("In  Start: %-10u Count: %-10u Read %-10u Size %u\n",
+           istart, icount, ibytes, ilen);
     printf("           ");
-    printf("Out Start: %-10u Count: %-10u Read %-10u\n",
-           ostart, ocount, obytes);
+    printf("Out Start: %-10u Count: %-10u Read %-10u Size %u\n",
+           ostart, ocount, obytes, olen);
+
+    /* Segments and average payload */
+    printf("           ");
+    printf("Segs Sent: %-10u Avg: %-5u   Recv: %-10u Avg: %u\n",
+           sndsegs, (0 == sndsegs) ? 0 : sndoctets / sndsegs,
+           rcvsegs, (0 == rcvsegs) ? 0 : rcvoctets / rcvsegs);
+
+    /* Loss recovery */
+    printf("           ");
+    printf("Resent Timeout: %-6u Fast: %-6u Dup ACKs: %-6u "
+           "Recoveries: %u\n", rxtsegs, fastsegs, dupackcount, recoveries);
+
+    /* Round trip time, ms; the deviation is the smoothed mean deviation */
+    printf("           ");
+    printf("RTT Min: %-6u Avg: %-6u Max: %-6u Srtt: %-6d Dev: %-6d "
+           "RTO: %d\n", rttmin, (0 == rttcount) ? 0 : rttsum / rttcount,
+           rttmax, sndrtt >> 3, sndrtd >> 2, rxttime);
+
+    /* Congestion and flow control */
+    printf("           ");
+    printf("Cwnd: %-10u Max: %-10u Ssthresh: %-10u\n",
+           sndcwn, cwnmax, sndsst);
+    printf("           ");
+    printf("Zero Wnd: %-6u Persist: %lu ms\n", zerownds, psttotal);
     printf("\n");
 
     return;
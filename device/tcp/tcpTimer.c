@@ -6,126 +6,106 @@
 
 #include <clock.h>
 #include <interrupt.h>
-#include <semaphore.h>
 #include <stddef.h>
-#include <stdlib.h>
 #include <tcp.h>
 #include <thread.h>
 
-struct tcpEvent tcptimertab[TCP_NEVENTS];
-semaphore tcpmutex;
-
-static int calcElapsed(int, int);
+struct tcpEvent *tcpwheel[TCP_WHEEL_SLOTS]; /**< timing wheel slots      */
+uint tcptimercount = 0;         /**< events armed in the wheel           */
+ulong tcptimertick = 0;         /**< next tick the wheel visits          */
+ulong tcptimerwake = 0;         /**< tick the timer thread sleeps until  */
+tid_typ tcptimerthr = BADTID;   /**< timer thread                        */
 
 /**
  * @ingroup tcp
  *
- * TCP timer process to manage timeout and retransmit events.
+ * TCP timer process to manage timeout and retransmit events.  Events hang
+ * in a hashed timing wheel, one slot per tick; the thread visits each
+ * tick's slot in turn and triggers the events due.  Between visits it
+ * sleeps until the next slot holding an event, and while no event is
+ * armed it waits for tcpTimerSched() to wake it.
  */
 thread tcpTimer(void)
 {
-    struct tcpEvent *first = NULL;
-    struct tcpEvent *head = NULL;
-    ulong lastticks;
-    ulong lasttime;
-    ulong elapse;
-    irqmask ps;
+    struct tcpEvent *evt;
+    ulong now;
+    uint ticks;
     uchar type;
-    struct tcb *tcbptr = NULL;
-
-    /* Setup timer event delta queue */
-    bzero(tcptimertab, sizeof(struct tcpEvent) * TCP_NEVENTS);
-    tcpmutex = semcreate(1);
-    head = &tcptimertab[TCP_EVT_HEAD];
-    head->used = TRUE;
-    head->next = NULL;
+    struct tcb *tcbptr;
+    irqmask im;
 
+    tcptimerthr = gettid();
     TCP_TRACE("Timer init complete");
-    /* Initialize timer accounting information */
-    ps = disable();
-    lastticks = clkticks;
-    lasttime = clktime;
-    elapse = 0;
-    restore(ps);
-    sleep(TCP_FREQ);
 
     while (TRUE)
     {
-//              TCP_TRACE("Tick");
-        wait(tcpmutex);
-        while ((head->next != NULL) && (elapse > 0))
+        im = disable();
+        if (0 == tcptimercount)
+        {
+            restore(im);
+            receive();
+            continue;
+        }
+
+        /* Visit each tick up to now, triggering the events due */
+        now = tcpTimerNow();
+        while ((long)(tcptimertick - now) <= 0)
         {
-            first = head->next;
-            if (first->remain > elapse)
+            evt = tcpwheel[tcptimertick & (TCP_WHEEL_SLOTS - 1)];
+            while ((NULL != evt) && ((long)(evt->due - tcptimertick) > 0))
             {
-                first->remain -= elapse;
-                break;
+                /* Due on a later turn of the wheel */
+                evt = evt->next;
             }
-
-            elapse -= first->remain;
-            first->remain = 0;
-            while ((first != NULL) && (first->remain <= 0))
+            if (NULL == evt)
             {
-                /* Save event information and update pointers */
-                type = first->type;
-                tcbptr = first->tcbptr;
-                first->used = FALSE;
-                head->next = first->next;
+                tcptimertick++;
+                continue;
+            }
 
-                /* Release mutex in case triggered event needs it */
-                signal(tcpmutex);
+            /* Disarm the event and trigger it with interrupts enabled;
+             * the slot may change meanwhile, so look at it again */
+            if (NULL != evt->prev)
+            {
+                evt->prev->next = evt->next;
+            }
+            else
+            {
+                tcpwheel[tcptimertick & (TCP_WHEEL_SLOTS - 1)] = evt->next;
+            }
+            if (NULL != evt->next)
+            {
+                evt->next->prev = evt->prev;
+            }
+            evt->used = FALSE;
+            tcptimercount--;
+            type = evt->type;
+            tcbptr = evt->tcbptr;
+            restore(im);
 
-                /* Trigger event */
-                tcpTimerTrigger(type, tcbptr);
+            tcpTimerTrigger(type, tcbptr);
 
-                /* Reclaim mutex */
-                wait(tcpmutex);
+            im = disable();
+        }
 
-                /* Obtain first event (which may have changed while 
-                 * mutex was released) */
-                first = head->next;
+        /* Sleep until the next slot with an event, which may only be due
+         * on a later turn of the wheel */
+        for (ticks = 0; ticks < TCP_WHEEL_SLOTS; ticks++)
+        {
+            if (NULL !=
+                tcpwheel[(tcptimertick + ticks) & (TCP_WHEEL_SLOTS - 1)])
+            {
+                break;
             }
         }
-        signal(tcpmutex);
-
-        ps = disable();
-        elapse = calcElapsed(lastticks, lasttime);
-        restore(ps);
-
-//        sleep(TCP_FREQ - elapse);
-        sleep(TCP_FREQ);
-
-        ps = disable();
-        elapse = calcElapsed(lastticks, lasttime);
-        lastticks = clkticks;
-        lasttime = clktime;
-        restore(ps);
+        if (0 == tcptimercount)
+        {
+            restore(im);
+            continue;
+        }
+        tcptimerwake = tcptimertick + ticks;
+        restore(im);
+        recvtime((ticks + 1) * TCP_FREQ);
     }
     return OK;
 }
-
-/**
- * Calulates the number of milliseconds elapsed.
- * @param lastticks last value of clock ticks
- * @param lasttime last value of clock time
- * @return number of milliseconds elapsed between the time provided and now 
- * @precondition interrupts are disabled
- * @postcondition interrupts are still disabled
- */
-static int calcElapsed(int lastticks, int lasttime)
-{
-    int ticks = 0;
-
-    if (lasttime == clktime)
-    {
-        ticks = clkticks - lastticks;
-    }
-    else
-    {
-        ticks = CLKTICKS_PER_SEC - lastticks;
-        ticks += (clktime - lasttime - 1) * CLKTICKS_PER_SEC;
-        ticks += clkticks;
-    }
-
-    return (ticks * (CLKTICKS_PER_SEC / 1000));
-}
@@ -4,7 +4,7 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
-#include <semaphore.h>
+#include <interrupt.h>
 #include <stddef.h>
 #include <tcp.h>
 
@@ -19,33 +19,56 @@
  */
 devcall tcpTimerPurge(struct tcb *tcbptr, uchar type)
 {
-    struct tcpEvent *prev = NULL;
     struct tcpEvent *cur = NULL;
     int result = SYSERR;
+    uchar first, last;
+    irqmask im;
 
-    wait(tcpmutex);
-    prev = &tcptimertab[TCP_EVT_HEAD];
-    cur = prev->next;
-    while (cur != NULL)
+    if (NULL == type)
     {
-        if ((cur->tcbptr == tcbptr)
-            && ((NULL == type) || (cur->type == type)))
+        first = 1;
+        last = TCP_NEVTS;
+    }
+    else if (type <= TCP_NEVTS)
+    {
+        first = last = type;
+    }
+    else
+    {
+        return SYSERR;
+    }
+
+    im = disable();
+    for (type = first; type <= last; type++)
+    {
+        cur = tcpTimerEvent(tcbptr, type);
+        if (!cur->used)
+        {
+            continue;
+        }
+        if (SYSERR == result)
+        {
+            result = cur->time
+                - (int)(cur->due - tcpTimerNow()) * TCP_FREQ;
+        }
+
+        /* Unlink event from its wheel slot */
+        if (NULL != cur->prev)
+        {
+            cur->prev->next = cur->next;
+        }
+        else
+        {
+            tcpwheel[cur->due & (TCP_WHEEL_SLOTS - 1)] = cur->next;
+        }
+        if (NULL != cur->next)
         {
-            if (SYSERR == result)
-            {
-                result = cur->time - cur->remain;
-            }
-            if (cur->next != NULL)
-            {
-                cur->next->remain += cur->remain;
-            }
-            prev->next = cur->next;
-            cur->used = FALSE;
+            cur->next->prev = cur->prev;
         }
-        prev = cur;
-        cur = cur->next;
+        cur->used = FALSE;
+        tcptimercount--;
     }
-    signal(tcpmutex);
+    restore(im);
 
     return result;
 }
@@ -4,7 +4,7 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
-#include <semaphore.h>
+#include <interrupt.h>
 #include <stddef.h>
 #include <tcp.h>
 
@@ -20,20 +20,25 @@ int tcpTimerRemain(struct tcb *tcbptr, uchar type)
 {
     struct tcpEvent *cur = NULL;
     int time = 0;
+    irqmask im;
 
-    wait(tcpmutex);
-    cur = tcptimertab[TCP_EVT_HEAD].next;
-    while (cur != NULL)
+    if ((type < 1) || (type > TCP_NEVTS))
     {
-        time += cur->remain;
-        if ((cur->tcbptr == tcbptr) && (cur->type == type))
+        return 0;
+    }
+
+    im = disable();
+    cur = tcpTimerEvent(tcbptr, type);
+    if (cur->used)
+    {
+        time = (int)(cur->due - tcpTimerNow()) * TCP_FREQ;
+        /* Due now, but not yet triggered */
+        if (time <= 0)
         {
-            signal(tcpmutex);
-            return time;
+            time = 1;
         }
-        cur = cur->next;
     }
-    signal(tcpmutex);
+    restore(im);
 
-    return 0;
+    return time;
 }
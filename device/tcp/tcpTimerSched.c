@@ -4,16 +4,16 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
-#include <semaphore.h>
+#include <interrupt.h>
 #include <stddef.h>
 #include <tcp.h>
-
-static int allocEvent(void);
+#include <thread.h>
 
 /**
  * @ingroup tcp
  *
- * Schedule TCP timer events.
+ * Schedule TCP timer events.  An event of the same type already armed for
+ * the TCB is rescheduled.
  * @param time milliseconds before timer triggers
  * @param tcbptr TCB with which event is associated
  * @param type type of timer event
@@ -21,77 +21,64 @@ static int allocEvent(void);
  */
 devcall tcpTimerSched(int time, struct tcb *tcbptr, uchar type)
 {
-    int evt = 0;
     struct tcpEvent *evtptr = NULL;
-    struct tcpEvent *prev = NULL;
-    struct tcpEvent *next = NULL;
+    struct tcpEvent **slot = NULL;
+    ulong now;
+    bool wake;
+    irqmask im;
 
     /* Verify parameters */
-    if ((time < 0) || (NULL == tcbptr))
+    if ((time < 0) || (NULL == tcbptr)
+        || (type < 1) || (type > TCP_NEVTS))
     {
         return SYSERR;
     }
 
-    wait(tcpmutex);
+    im = disable();
+    tcpTimerPurge(tcbptr, type);
+
     /* Setup timer event */
-    evt = allocEvent();
-    if (SYSERR == evt)
-    {
-        signal(tcpmutex);
-        return SYSERR;
-    }
-    evtptr = &tcptimertab[evt];
+    evtptr = tcpTimerEvent(tcbptr, type);
+    evtptr->used = TRUE;
     evtptr->time = time;
     evtptr->type = type;
     evtptr->tcbptr = tcbptr;
 
-    /* Insert event into delta queue */
-    prev = &tcptimertab[TCP_EVT_HEAD];
-    next = prev->next;
-    while ((next != NULL) && (next->remain <= time))
+    /* An idle wheel starts turning from now */
+    now = tcpTimerNow();
+    wake = FALSE;
+    if (0 == tcptimercount)
     {
-        time -= next->remain;
-        prev = next;
-        next = next->next;
+        tcptimertick = now;
+        wake = TRUE;
     }
-    evtptr->next = next;
-    prev->next = evtptr;
-    evtptr->remain = time;
-    if (next != NULL)
+    evtptr->due = now + (time + TCP_FREQ - 1) / TCP_FREQ;
+    if ((long)(evtptr->due - tcptimertick) < 0)
     {
-        next->remain -= time;
+        evtptr->due = tcptimertick;
+    }
+    if ((long)(evtptr->due - tcptimerwake) < 0)
+    {
+        wake = TRUE;
     }
-    signal(tcpmutex);
-
-    return OK;
-}
 
-/**
- * Allocate an unused timer event block
- * @return index to used block, or SYSERR if none exist
- * @precondition TCP Timer mutex is already held
- * @postcondition TCP Timer mutex is still held
- */
-static int allocEvent(void)
-{
-    int evt;
-    static int nextevt = 0;
+    /* Insert event at the head of its wheel slot */
+    slot = &tcpwheel[evtptr->due & (TCP_WHEEL_SLOTS - 1)];
+    evtptr->prev = NULL;
+    evtptr->next = *slot;
+    if (NULL != *slot)
+    {
+        (*slot)->prev = evtptr;
+    }
+    *slot = evtptr;
+    tcptimercount++;
 
-    /* Check all TCP timer event slots (except the head) */
-    for (evt = 0; evt < TCP_NEVENTS; evt++)
+    /* Wake the timer thread if it sleeps past the new event */
+    if (wake && !isbadtid(tcptimerthr))
     {
-        nextevt = (nextevt + 1) % TCP_NEVENTS;
-        /* Ignore head */
-        if (TCP_EVT_HEAD == nextevt)
-        {
-            continue;
-        }
-        if (FALSE == tcptimertab[nextevt].used)
-        {
-            tcptimertab[nextevt].used = TRUE;
-            return nextevt;
-        }
+        send(tcptimerthr, 0);
     }
-    return SYSERR;
+    restore(im);
 
+    return OK;
 }
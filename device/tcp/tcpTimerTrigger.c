@@ -28,5 +28,13 @@ void tcpTimerTrigger(uchar type, struct tcb *tcbptr)
     case TCP_EVT_PERSIST:
         tcpSendPersist(tcbptr);
         return;
+    case TCP_EVT_DELACK:
+        wait(tcbptr->mutex);
+        if (tcbptr->sndflg & TCP_FLG_DELACK)
+        {
+            tcpSendAck(tcbptr);
+        }
+        signal(tcbptr->mutex);
+        return;
     }
 }
@@ -6,6 +6,7 @@
 
 #include <device.h>
 #include <stddef.h>
+#include <string.h>
 #include <tcp.h>
 
 static int stateCheck(struct tcb *);
@@ -22,7 +23,7 @@ static int stateCheck(struct tcb *);
 devcall tcpWrite(device *devptr, void *buf, uint len)
 {
     uint count = 0;
-    uchar ch;
+    uint n, tail, first;
     struct tcb *tcbptr;
     uchar *buffer = buf;
     int check;
@@ -55,16 +56,26 @@ devcall tcpWrite(device *devptr, void *buf, uint len)
             return check;
         }
 
-        while ((tcbptr->ocount < TCP_OBLEN) && (count < len))
+        /* Copy as much as fits, in at most two pieces around the wrap */
+        n = tcbptr->olen - tcbptr->ocount;
+        if (n > len - count)
         {
-            ch = *buffer++;
-            tcbptr->out[((tcbptr->ostart + tcbptr->ocount) % TCP_OBLEN)] =
-                ch;
-            tcbptr->ocount++;
-            count++;
+            n = len - count;
         }
+        tail = (tcbptr->ostart + tcbptr->ocount) % tcbptr->olen;
+        first = tcbptr->olen - tail;
+        if (first > n)
+        {
+            first = n;
+        }
+        memcpy(&tcbptr->out[tail], buffer, first);
+        memcpy(&tcbptr->out[0], buffer + first, n - first);
+        tcbptr->ocount += n;
+        buffer += n;
+        count += n;
+
         /* If space remains, another writer can write */
-        if (tcbptr->ocount < TCP_OBLEN)
+        if (tcbptr->ocount < tcbptr->olen)
         {
             signal(tcbptr->writers);
         }
@@ -26,7 +26,9 @@ ushort udpChksum(struct packet *pkt, ushort len, const struct netaddr *src,
 
     struct udpPseudoHdr *pseu;
     struct udpPseudoHdr temp;
+    struct netseg segs[NET_MAX_SEGS + 1];
     ushort sum;
+    uint i;
 
     pseu = ((struct udpPseudoHdr *)(pkt->curr)) - 1;
     memcpy(&temp, pseu, sizeof(struct udpPseudoHdr));
@@ -38,7 +40,15 @@ ushort udpChksum(struct packet *pkt, ushort len, const struct netaddr *src,
     pseu->proto = IPv4_PROTO_UDP;
     pseu->len = hs2net(len);
 
-    sum = netChksum(pseu, len + sizeof(struct udpPseudoHdr));
+    /* Sum the pseudo header and the part of the datagram in the packet
+     * buffer, followed by any payload segments */
+    segs[0].data = pseu;
+    segs[0].len = len - netSeglen(pkt) + sizeof(struct udpPseudoHdr);
+    for (i = 0; i < pkt->nseg; i++)
+    {
+        segs[i + 1] = pkt->seg[i];
+    }
+    sum = netChksumSg(segs, pkt->nseg + 1);
 
     memcpy(pseu, &temp, sizeof(struct udpPseudoHdr));
 
@@ -44,6 +44,9 @@ devcall udpClose(device *devptr)
         return SYSERR;
     }
 
+    /* Stop demultiplexing datagrams to the socket */
+    udpHashRemove(udpptr);
+
     /* Free the in buffer pool */
     bfpfree(udpptr->inPool);
 
@@ -7,13 +7,15 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <device.h>
+#include <interrupt.h>
 #include <network.h>
 #include <udp.h>
 
 /**
  * @ingroup udpexternal
  *
- * Control function for udp devices.
+ * Control function for udp devices.  Rebinding moves an open socket
+ * between demultiplexing tables.
  * @param devptr udp device table entry
  * @param func control function to execute
  * @param arg1 first argument for the control function
@@ -24,6 +26,8 @@ devcall udpControl(device *devptr, int func, long arg1, long arg2)
 {
     struct udp *udpptr;
     uchar old;
+    irqmask im;
+    devcall result = OK;
 
     udpptr = &udptab[devptr->minor];
 
@@ -31,18 +35,27 @@ devcall udpControl(device *devptr, int func, long arg1, long arg2)
     {
     case UDP_CTRL_ACCEPT:
         /* arg1 is port and arg2 is pointer to netaddr */
+        im = disable();
+        udpHashRemove(udpptr);
         udpptr->localpt = arg1;
         if (NULL == arg2)
         {
-            return SYSERR;
+            result = SYSERR;
         }
         else
         {
             netaddrcpy(&(udpptr->localip), (struct netaddr *)arg2);
         }
-        return OK;
+        if (UDP_OPEN == udpptr->state)
+        {
+            udpHashInsert(udpptr);
+        }
+        restore(im);
+        return result;
     case UDP_CTRL_BIND:
         /* arg1 is port and arg2 is pointer to netaddr */
+        im = disable();
+        udpHashRemove(udpptr);
         udpptr->remotept = arg1;
         if (NULL == arg2)
         {
@@ -52,6 +65,11 @@ devcall udpControl(device *devptr, int func, long arg1, long arg2)
         {
             netaddrcpy(&(udpptr->remoteip), (struct netaddr *)arg2);
         }
+        if (UDP_OPEN == udpptr->state)
+        {
+            udpHashInsert(udpptr);
+        }
+        restore(im);
         return OK;
     case UDP_CTRL_CLRFLAG:
         /* arg1 is the flag we are clearing */
@@ -15,7 +15,10 @@
 /**
  * @ingroup udpinternal
  *
- * Locate the UDP socket for a UDP packet
+ * Locate the UDP socket for a UDP packet.  Only the bucket of the exact
+ * table for the packet's endpoints and the bucket of the wildcard table for
+ * its destination port are searched.  Among sockets that match equally
+ * well, the one earliest in ::udptab wins.
  * @param dstpt destination port of the UDP packet
  * @param srcpt source port of the UDP packet
  * @param dstip destination IP of the UDP packet
@@ -27,56 +30,54 @@
 struct udp *udpDemux(ushort dstpt, ushort srcpt, const struct netaddr *dstip,
                      const struct netaddr *srcip)
 {
-    struct udp *udpptr = NULL;
-    uint i;
+    struct udp *udpptr;
+    struct udp *best = NULL;
     uint match = NO_MATCH;
 
-    /* Cycle through all udp devices to find the best match */
-    for (i = 0; i < NUDP; i++)
+    /* Full match is the best */
+    for (udpptr = udpexacttab[udpHashExact(dstpt, srcpt, srcip)];
+         NULL != udpptr; udpptr = udpptr->hnext)
     {
-        if (udptab[i].state == UDP_FREE)
+        if ((udpptr->localpt == dstpt)
+            && (udpptr->remotept == srcpt)
+            && netaddrequal(&udpptr->localip, dstip)
+            && netaddrequal(&udpptr->remoteip, srcip)
+            && ((NULL == best) || (udpptr < best)))
         {
-            /* skip this entry */
-            continue;
-        }
-        if (!netaddrequal(&udptab[i].localip, dstip))
-        {
-            /* entry is not bound to the destination */
-            continue;
+            best = udpptr;
         }
+    }
+    if (NULL != best)
+    {
+        return best;
+    }
 
-        /* Full match is the best */
-        if (match < FULL_MATCH
-            && (udptab[i].localpt == dstpt)
-            && (udptab[i].remotept == srcpt)
-            && (netaddrequal(&udptab[i].remoteip, srcip)))
+    for (udpptr = udpwildtab[udpHashWild(dstpt)];
+         NULL != udpptr; udpptr = udpptr->hnext)
+    {
+        if ((udpptr->localpt != dstpt)
+            || (udpptr->remoteip.type != NULL)
+            || !netaddrequal(&udpptr->localip, dstip))
         {
-            udpptr = &udptab[i];
-            match = FULL_MATCH;
-            /* you can't beat a full match */
-            break;
+            continue;
         }
 
         /* Src and dst ports match is second */
-        if (match < PARTIAL_MATCH
-            && (udptab[i].localpt == dstpt)
-            && (udptab[i].remotept == srcpt)
-            && (udptab[i].remoteip.type == NULL))
+        if ((udpptr->remotept == srcpt)
+            && ((match < PARTIAL_MATCH) || (udpptr < best)))
         {
-            udpptr = &udptab[i];
+            best = udpptr;
             match = PARTIAL_MATCH;
         }
 
         /* Dst ports match is last */
-        if (match < DEST_MATCH
-            && (udptab[i].localpt == dstpt)
-            && (udptab[i].remotept == NULL)
-            && (udptab[i].remoteip.type == NULL))
+        else if ((udpptr->remotept == NULL) && (match <= DEST_MATCH)
+                 && ((match < DEST_MATCH) || (udpptr < best)))
         {
-            udpptr = &udptab[i];
+            best = udpptr;
             match = DEST_MATCH;
         }
     }
 
-    return udpptr;
+    return best;
 }
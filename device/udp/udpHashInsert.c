@@ -0,0 +1,47 @@
+/**
+ * @file     udpHashInsert.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <udp.h>
+
+/**
+ * @ingroup udpinternal
+ *
+ * Adds a UDP socket to the demultiplexing tables.  A socket bound to both
+ * a remote port and a remote IP address goes in the exact table, hashed
+ * on its local port and remote endpoint; any other socket goes in the
+ * wildcard table, hashed on its local port.  Ports and addresses must not
+ * change while the socket is in a table; call udpHashRemove() first.
+ * @param udpptr pointer to the UDP control block
+ */
+void udpHashInsert(struct udp *udpptr)
+{
+    struct udp **head;
+    irqmask im;
+
+    im = disable();
+    if (udpptr->hashed)
+    {
+        restore(im);
+        return;
+    }
+
+    if ((0 != udpptr->remotept) && (NULL != udpptr->remoteip.type))
+    {
+        head = &udpexacttab[udpHashExact(udpptr->localpt, udpptr->remotept,
+                                         &udpptr->remoteip)];
+    }
+    else
+    {
+        head = &udpwildtab[udpHashWild(udpptr->localpt)];
+    }
+
+    udpptr->hnext = *head;
+    *head = udpptr;
+    udpptr->hashed = TRUE;
+    restore(im);
+}
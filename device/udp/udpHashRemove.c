@@ -0,0 +1,50 @@
+/**
+ * @file     udpHashRemove.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <udp.h>
+
+/**
+ * @ingroup udpinternal
+ *
+ * Removes a UDP socket from the demultiplexing tables, if it is in one.
+ * @param udpptr pointer to the UDP control block
+ */
+void udpHashRemove(struct udp *udpptr)
+{
+    struct udp **prev;
+    irqmask im;
+
+    im = disable();
+    if (!udpptr->hashed)
+    {
+        restore(im);
+        return;
+    }
+
+    if ((0 != udpptr->remotept) && (NULL != udpptr->remoteip.type))
+    {
+        prev = &udpexacttab[udpHashExact(udpptr->localpt, udpptr->remotept,
+                                         &udpptr->remoteip)];
+    }
+    else
+    {
+        prev = &udpwildtab[udpHashWild(udpptr->localpt)];
+    }
+
+    while ((NULL != *prev) && (udpptr != *prev))
+    {
+        prev = &(*prev)->hnext;
+    }
+    if (NULL != *prev)
+    {
+        *prev = udpptr->hnext;
+    }
+    udpptr->hnext = NULL;
+    udpptr->hashed = FALSE;
+    restore(im);
+}
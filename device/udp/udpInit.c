@@ -10,6 +10,8 @@
 #include <udp.h>
 
 struct udp udptab[NUDP];
+struct udp *udpexacttab[UDP_NHASH];
+struct udp *udpwildtab[UDP_NHASH];
 
 /**
  * @ingroup udpexternal
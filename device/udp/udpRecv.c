@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <mib.h>
 #include <string.h>
 #include <interrupt.h>
 #include <ipv4.h>
@@ -40,6 +41,16 @@ syscall udpRecv(struct packet *pkt, const struct netaddr *src,
     if (NULL == udppkt)
     {
         UDP_TRACE("Invalid UDP packet.");
+        mib.udp.inErrors++;
+        netFreebuf(pkt);
+        return SYSERR;
+    }
+
+    /* A reassembled datagram may not fit in the socket's input buffers */
+    if (net2hs(udppkt->len) > NET_MAX_PKTLEN - sizeof(struct udpPseudoHdr))
+    {
+        UDP_TRACE("UDP packet too large.");
+        mib.udp.inErrors++;
         netFreebuf(pkt);
         return SYSERR;
     }
@@ -49,6 +60,8 @@ syscall udpRecv(struct packet *pkt, const struct netaddr *src,
         && (0 != udpChksum(pkt, net2hs(udppkt->len), src, dst)))
     {
         UDP_TRACE("Invalid UDP checksum.");
+        mib.udp.inErrors++;
+        mib.udp.inCsumErrors++;
         netFreebuf(pkt);
         return SYSERR;
     }
@@ -81,6 +94,7 @@ syscall udpRecv(struct packet *pkt, const struct netaddr *src,
         udppkt->len = hs2net(udppkt->len);
 
         /* Send ICMP port unreachable message */
+        mib.udp.noPorts++;
         icmpDestUnreach(pkt, ICMP_PORT_UNR);
         netFreebuf(pkt);
         return SYSERR;
@@ -88,6 +102,8 @@ syscall udpRecv(struct packet *pkt, const struct netaddr *src,
     if (udpptr->icount >= UDP_MAX_PKTS)
     {
         UDP_TRACE("UDP buffer is full. Dropping UDP packet.");
+        mib.udp.inErrors++;
+        mib.udp.rcvbufErrors++;
         restore(im);
         netFreebuf(pkt);
         return SYSERR;
@@ -97,10 +113,12 @@ syscall udpRecv(struct packet *pkt, const struct netaddr *src,
      * and clear the flag */
     if (UDP_FLAG_BINDFIRST & udpptr->flags)
     {
+        udpHashRemove(udpptr);
         udpptr->remotept = udppkt->srcPort;
         netaddrcpy(&(udpptr->localip), dst);
         netaddrcpy(&(udpptr->remoteip), src);
         udpptr->flags &= ~UDP_FLAG_BINDFIRST;
+        udpHashInsert(udpptr);
     }
 
     /* Get some buffer space to store the packet */
@@ -109,6 +127,8 @@ syscall udpRecv(struct packet *pkt, const struct netaddr *src,
     if (SYSERR == (int)tpkt)
     {
         UDP_TRACE("Unable to get UDP buffer from pool. Dropping packet.");
+        mib.udp.inErrors++;
+        mib.udp.rcvbufErrors++;
         restore(im);
         netFreebuf(pkt);
         return SYSERR;
@@ -128,6 +148,7 @@ syscall udpRecv(struct packet *pkt, const struct netaddr *src,
     /* Store the temporary UDP packet in a FIFO buffer */
     udpptr->in[(udpptr->istart + udpptr->icount) % UDP_MAX_PKTS] = tpkt;
     udpptr->icount++;
+    mib.udp.inDatagrams++;
 
     restore(im);
 
@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
 
 #include <ipv4.h>
+#include <mib.h>
 #include <network.h>
 #include <string.h>
 #include <udp.h>
@@ -92,21 +93,24 @@ syscall udpSend(struct udp *udpptr, ushort datalen, const void *buf)
     }
     else
     {
+        /* Only the header goes in the packet buffer; the payload is sent
+         * straight from the caller's buffer as a segment */
+        pkt->curr -= UDP_HDR_LEN;
+        if (datalen > 0)
+        {
+            pkt->seg[0].data = buf;
+            pkt->seg[0].len = datalen;
+            pkt->nseg = 1;
+        }
         datalen += UDP_HDR_LEN;
-        /* Set the length of the packet and set the curr pointer back that
-         * length */
         pkt->len = datalen;
-        /* Round the datalength to maintain word alignment */
-        pkt->curr -= (3 + (ulong)(pkt->len)) & ~0x03;
 
-        /* Set UDP header fields and fill the packet with the data */
+        /* Set UDP header fields */
         udppkt = (struct udpPkt *)(pkt->curr);
         udppkt->srcPort = hs2net(udpptr->localpt);
         udppkt->dstPort = hs2net(udpptr->remotept);
         udppkt->len = hs2net(pkt->len);
         udppkt->chksum = 0;
-
-        memcpy(udppkt->data, buf, datalen - UDP_HDR_LEN);
     }
 
     /* Calculate UDP checksum (which happens to be the same as TCP's) */
@@ -114,6 +118,10 @@ syscall udpSend(struct udp *udpptr, ushort datalen, const void *buf)
 
     /* Send the UDP packet through IP */
     result = ipv4Send(pkt, &localip, &remoteip, IPv4_PROTO_UDP);
+    if (OK == result)
+    {
+        mib.udp.outDatagrams++;
+    }
 
     if (SYSERR == netFreebuf(pkt))
     {
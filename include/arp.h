@@ -45,14 +45,19 @@
 /* ARP entry is resolved if it is USED and RESOLVED (0b11) */
 #define ARP_RESOLVED        3      /**< Entry is used and resolved      */
 #define ARP_NTHRWAIT        10     /**< Num threads that can wait       */
+#define ARP_NHASH           16     /**< ARP hash buckets (power of 2)   */
+#define ARP_NPENDING        4      /**< Pkts queued per unresolved entry */
 
 /* ARP Lookup */
 #define ARP_MAX_LOOKUP      5     /**< Num ARP lookup attempts per pkt  */
 #define ARP_MSG_RESOLVED    1     /**< Message shows arp resolution     */
+#define ARP_PENDING         2     /**< arpResolve() queued the packet   */
 
 /* Timing info */
 #define ARP_TTL_UNRESOLVED  5    /**< TTL in secs for unresolv entry  */
 #define ARP_TTL_RESOLVED    300   /**< TTL in secs for resolved entry  */
+#define ARP_RETRY_INIT      1     /**< Secs before first request retry */
+#define ARP_RETRY_MAX       4     /**< Max secs between request retries */
 
 /* ARP thread constants */
 #define ARP_THR_PRIO        NET_THR_PRIO   /**< ARP thread priority     */
@@ -105,16 +110,27 @@ struct arpEntry
     uint expires;                    /**< clktime when entry expires    */
     tid_typ waiting[ARP_NTHRWAIT];   /**< Threads waiting for entry     */
     int count;                       /**< Count of threads waiting      */
+    struct arpEntry *next;           /**< Next entry in hash bucket     */
+    uint retry;                      /**< clktime of next request       */
+    uint backoff;                    /**< Secs until the one after      */
+    struct packet *pending[ARP_NPENDING]; /**< Pkts awaiting resolution */
+    ushort pendtype[ARP_NPENDING];   /**< Link-level type of each pkt   */
+    int npending;                    /**< Count of pkts awaiting        */
 };
 
 /* ARP table */
 extern struct arpEntry arptab[ARP_NENTRY];
+extern struct arpEntry *arphash[ARP_NHASH];
+
+/** ARP hash bucket for an IPv4 protocol address */
+#define arpHash(praddr) \
+    (((praddr)->addr[2] ^ (praddr)->addr[3]) & (ARP_NHASH - 1))
 
 /* ARP packet queue for packets requiring reply */
 extern mailbox arpqueue;
 
 /* ARP Function Prototypes */
-struct arpEntry *arpAlloc(void);
+struct arpEntry *arpAlloc(const struct netaddr *);
 thread arpDaemon(void);
 struct arpEntry *arpGetEntry(const struct netaddr *);
 syscall arpFree(struct arpEntry *);
@@ -122,6 +138,10 @@ syscall arpInit(void);
 syscall arpLookup(struct netif *, const struct netaddr *, struct netaddr *);
 syscall arpNotify(struct arpEntry *, message);
 syscall arpRecv(struct packet *);
+syscall arpResolve(struct netif *, const struct netaddr *, struct netaddr *,
+                   struct packet *, ushort);
+thread arpRetryDaemon(void);
+bool arpRetryDue(struct arpEntry *);
 syscall arpSendRqst(struct arpEntry *);
 syscall arpSendReply(struct packet *);
 
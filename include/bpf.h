@@ -0,0 +1,90 @@
+/**
+ * @file bpf.h
+ *
+ * Classic Berkeley Packet Filter: an interpreter for filter programs, a
+ * validator, and a compiler for a small subset of the tcpdump expression
+ * language.
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#ifndef _BPF_H_
+#define _BPF_H_
+
+#include <stddef.h>
+#include <pcap.h>
+
+/* Instruction classes */
+#define BPF_CLASS(code) ((code) & 0x07)
+#define BPF_LD          0x00
+#define BPF_LDX         0x01
+#define BPF_ST          0x02
+#define BPF_STX         0x03
+#define BPF_ALU         0x04
+#define BPF_JMP         0x05
+#define BPF_RET         0x06
+#define BPF_MISC        0x07
+
+/* Load/store sizes */
+#define BPF_SIZE(code)  ((code) & 0x18)
+#define BPF_W           0x00
+#define BPF_H           0x08
+#define BPF_B           0x10
+
+/* Load/store addressing modes */
+#define BPF_MODE(code)  ((code) & 0xe0)
+#define BPF_IMM         0x00
+#define BPF_ABS         0x20
+#define BPF_IND         0x40
+#define BPF_MEM         0x60
+#define BPF_LEN         0x80
+#define BPF_MSH         0xa0
+
+/* ALU and jump operations */
+#define BPF_OP(code)    ((code) & 0xf0)
+#define BPF_ADD         0x00
+#define BPF_SUB         0x10
+#define BPF_MUL         0x20
+#define BPF_DIV         0x30
+#define BPF_OR          0x40
+#define BPF_AND         0x50
+#define BPF_LSH         0x60
+#define BPF_RSH         0x70
+#define BPF_NEG         0x80
+#define BPF_MOD         0x90
+#define BPF_XOR         0xa0
+#define BPF_JA          0x00
+#define BPF_JEQ         0x10
+#define BPF_JGT         0x20
+#define BPF_JGE         0x30
+#define BPF_JSET        0x40
+
+/* Operand sources */
+#define BPF_SRC(code)   ((code) & 0x08)
+#define BPF_K           0x00
+#define BPF_X           0x08
+
+/* Return values */
+#define BPF_RVAL(code)  ((code) & 0x18)
+#define BPF_A           0x10
+
+/* Miscellaneous operations */
+#define BPF_MISCOP(code) ((code) & 0xf8)
+#define BPF_TAX         0x00
+#define BPF_TXA         0x80
+
+/* Instruction constructors */
+#define BPF_STMT(code, k)           { (ushort)(code), 0, 0, (k) }
+#define BPF_JUMP(code, k, jt, jf)   { (ushort)(code), (jt), (jf), (k) }
+
+#define BPF_MEMWORDS    16      /**< words of scratch memory            */
+#define BPF_MAXINSNS    512     /**< longest valid program              */
+#define BPF_MAXEXPR     256     /**< longest expression to compile      */
+
+/* Function Prototypes */
+syscall bpfCompile(struct bpf_program *, const char *, uint, uint);
+uint bpfFilter(const struct bpf_insn *, const uchar *, uint, uint);
+void bpfFree(struct bpf_program *);
+bool bpfValidate(const struct bpf_insn *, uint);
+
+#endif                          /* _BPF_H_ */
@@ -31,6 +31,7 @@
 
 /* ETH Buffer lengths */
 #define ETH_IBLEN           1024 /**< input buffer size                 */
+#define ETH_RX_BUDGET       16  /**< Max Rx frames taken per poll       */
 
 /* Ethernet DMA buffer sizes */
 #define ETH_MTU             1500 /**< Maximum transmission units        */
@@ -92,6 +93,9 @@ struct ether
     ulong rxirq;                /**< Count of Rx interrupt requests     */
     ulong rxOffset;             /**< Size in bytes of rxHeader          */
     ulong rxErrors;             /**< Count of Rx errors.                */
+    bool rxpoll;                /**< Rx interrupts off, readers poll    */
+    ulong rxpolls;              /**< Count of Rx polls                  */
+    ulong rxbudget;             /**< Count of polls that used budget    */
 
     struct dmaDescriptor *txRing; /**< array of transmit ring descs.    */
     struct ethPktBuffer **txBufs; /**< Tx ring array                    */
@@ -111,7 +115,7 @@ struct ether
     ushort istart;              /**< Index of first byte                */
     ushort icount;              /**< Packets in buffer                  */
 
-    struct ethPktBuffer *in[ETH_IBLEN]; /**< Input buffer               */
+    void *in[ETH_IBLEN];        /**< Input buffer (driver's packet type)*/
 
     int inPool;                 /**< buffer pool id for input           */
     int outPool;                /**< buffer pool id for output          */
@@ -218,6 +222,31 @@ devcall etherRead(device *devptr, void *buf, uint len);
  */
 devcall etherWrite(device *devptr, const void *buf, uint len);
 
+struct netseg;
+
+/**
+ * \ingroup ether
+ *
+ * Write an Ethernet frame given as a list of segments to an Ethernet device.
+ * This is the gather form of etherWrite() and is reached through the
+ * ::NET_SEND_SG control request.  The segments are copied into a transmit
+ * buffer before this function returns, so they need not remain valid
+ * afterwards.
+ *
+ * @param devptr
+ *      Pointer to the entry in Xinu's device table for the Ethernet device.
+ * @param segs
+ *      Segments of the frame in order.  The first must start with the MAC
+ *      destination address.
+ * @param nsegs
+ *      Number of segments in @p segs.
+ *
+ * @return
+ *      ::SYSERR if the frame is too small, too large, or the Ethernet device is
+ *      not currently up; otherwise the total length of the frame.
+ */
+devcall etherWritev(device *devptr, const struct netseg *segs, uint nsegs);
+
 /**
  * \ingroup ether
  *
@@ -261,6 +290,23 @@ void etherThroughput(ushort minor);
 
 interrupt etherInterrupt(void);
 
+/**
+ * \ingroup ether
+ *
+ * Move up to ::ETH_RX_BUDGET received frames from the device to the input
+ * queue of an Ethernet device that is in polling mode, and return it to
+ * interrupt-driven receive if that drains the device.  Interrupts must be
+ * disabled.
+ *
+ * Drivers enter polling mode from their receive interrupt, so a burst of
+ * frames costs one interrupt.  Threads that find the input queue empty while
+ * ether::rxpoll is set call this to take more.
+ *
+ * @param ethptr
+ *      Ethernet control block of the physical device.
+ */
+void etherPoll(struct ether *ethptr);
+
 /**
  * \ingroup ether
  */
@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <device.h>
 #include <ethernet.h>
+#include <network.h>
 #include <semaphore.h>
 
 #define ELOOP_MTU          1500
@@ -25,6 +26,7 @@
 #define ELOOP_FLAG_HOLDNXT	0x01  /**< place next written pkt in hold  */
 #define ELOOP_FLAG_DROPNXT	0x04  /**< drop next written pkt           */
 #define ELOOP_FLAG_DROPALL	0x08  /**< drop all written pkts           */
+#define ELOOP_FLAG_RXREAD	0x10  /**< hand up received pkts by read() only */
 
 #define ELOOP_STATE_FREE        0
 #define ELOOP_STATE_ALLOC       1
@@ -43,7 +45,7 @@ struct ethloop
     int index;                  /**< index of first packet in buffer    */
     semaphore sem;              /**< number of packets in buffer        */
     int count;                      /**< number of packets in buffer        */
-    char *buffer[ELOOP_NBUF];   /**< input buffer                       */
+    struct packet *buffer[ELOOP_NBUF]; /**< input buffer                */
     int pktlen[ELOOP_NBUF];         /**< length of packet in buffer         */
 
     /* Hold packet */
@@ -63,6 +65,7 @@ devcall ethloopOpen(device *);
 devcall ethloopClose(device *);
 devcall ethloopRead(device *, void *, uint);
 devcall ethloopWrite(device *, const void *, uint);
+devcall ethloopWritev(device *, const struct netseg *, uint);
 devcall ethloopControl(device *, int, long, long);
 
 #endif                          /* _ETHLOOP_H_ */
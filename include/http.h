@@ -14,6 +14,7 @@
 #include <semaphore.h>
 
 #define HTTP_LOCAL_PORT 80
+#define HTTP_BACKLOG    4   /**< connections held while servers are busy */
 
 /* N sizes for strnlen calls */
 #define HTTP_STR_SM  256
@@ -102,6 +103,7 @@ extern const struct httpcmd httpcmdtab[];
 extern ulong nhttpcmd;              /**< number of commands in table    */
 extern semaphore maxhttp;           /**< counter for HTTP threads       */
 extern semaphore activeXWeb;        /**< on/off status of webserver     */
+extern int httplisten;              /**< listening TCP device, or SYSERR */
 
 /* HTTP device structure */
 struct http
@@ -102,6 +102,64 @@ struct ipv4Pkt             /**< IPv4 Packet Variables                   */
     uint8_t   opts[1];            /**< Options and padding is variable       */
 };
 
+/* Fragment reassembly */
+#define IPv4_RASM_MAXLEN    8192    /**< Max reassembled pkt, link hdr incl */
+#define IPv4_RASM_MEMCAP    (4 * IPv4_RASM_MAXLEN) /**< Reassembly memory */
+#define IPv4_RASM_NBUF      (IPv4_RASM_MEMCAP / IPv4_RASM_MAXLEN)
+#define IPv4_RASM_NENTRY    IPv4_RASM_NBUF /**< Max partial datagrams   */
+#define IPv4_RASM_NHASH     16      /**< Reassembly hash buckets (pow 2)   */
+#define IPv4_RASM_NHOLE     8       /**< Max holes in a partial datagram   */
+#define IPv4_RASM_TTL       30      /**< Secs to wait for all fragments    */
+#define IPv4_RASM_INF       0xFFFF  /**< Hole end before last fragment     */
+#define IPv4_RASM_THR_PRIO  NET_THR_PRIO /**< Reassembly thread priority */
+#define IPv4_RASM_THR_STK   NET_THR_STK  /**< Reassembly thread stack    */
+
+/* Reassembly entry states */
+#define IPv4_RASM_FREE      0
+#define IPv4_RASM_USED      1
+
+/**
+ * Range of fragment data not yet received, as byte offsets into the
+ * datagram payload (inclusive).
+ */
+struct ipv4RasmHole
+{
+    ushort first;               /**< First missing byte                 */
+    ushort last;                /**< Last missing byte                  */
+};
+
+/**
+ * Partially reassembled IPv4 datagram
+ */
+struct ipv4RasmEntry
+{
+    uchar state;                /**< IPv4_RASM_* state above            */
+    struct ipv4RasmEntry *next; /**< Next entry in hash bucket          */
+    uchar src[IPv4_ADDR_LEN];   /**< Datagram source address            */
+    uchar dst[IPv4_ADDR_LEN];   /**< Datagram destination address       */
+    ushort id;                  /**< Datagram id, network order         */
+    uchar proto;                /**< Datagram protocol                  */
+    uint expires;               /**< clktime when the entry expires     */
+    ulong seq;                  /**< Allocation order, for eviction     */
+    struct packet *pkt;         /**< Buffer the datagram is built in    */
+    ushort hdrlen;              /**< Offset of payload in buffer        */
+    bool first;                 /**< Fragment at offset 0 received      */
+    ushort ihl;                 /**< IP header length of first fragment */
+    uchar iphdr[IPv4_MAX_HDRLEN]; /**< IP header of first fragment      */
+    uint datalen;               /**< Payload length, 0 until known      */
+    uint nhole;                 /**< Number of holes                    */
+    struct ipv4RasmHole hole[IPv4_RASM_NHOLE]; /**< Missing ranges      */
+};
+
+extern struct ipv4RasmEntry ipv4rasmtab[];
+extern struct ipv4RasmEntry *ipv4rasmhash[];
+extern int ipv4rasmpool;
+
+/** Hash bucket for the (src, dst, id, proto) key of a fragment or entry */
+#define ipv4RasmHash(p) \
+    (((p)->id ^ ((p)->src[3] << 8) ^ (p)->dst[3] ^ (p)->proto) \
+     & (IPv4_RASM_NHASH - 1))
+
 /* Function prototypes */
 syscall dot2ipv4(const char *, struct netaddr *);
 syscall ipv4Recv(struct packet *);
@@ -110,5 +168,10 @@ bool ipv4RecvDemux(struct netaddr *);
 syscall ipv4Send(struct packet *, struct netaddr *, struct netaddr *,
                  uchar);
 syscall ipv4SendFrag(struct packet *, struct netaddr *);
+syscall ipv4RasmInit(void);
+struct packet *ipv4Rasm(struct packet *);
+struct ipv4RasmEntry *ipv4RasmGet(const struct ipv4Pkt *, struct netif *);
+void ipv4RasmFree(struct ipv4RasmEntry *);
+thread ipv4RasmDaemon(void);
 
 #endif                          /* _IPv4_H_ */
@@ -0,0 +1,141 @@
+/**
+ * @file mib.h
+ *
+ * Network statistics, modeled after the MIB-II groups of RFC 1213 as shown
+ * by "netstat -s".
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#ifndef _MIB_H_
+#define _MIB_H_
+
+#include <stddef.h>
+#include <network.h>
+
+/**
+ * Counters are plain uints bumped with non-atomic increments; an increment
+ * lost to a race between receive workers is an acceptable price for
+ * keeping them off the fast path.  Every member of every group is a uint,
+ * so a snapshot can be exported as an array of words in this order.
+ */
+
+/** Link-level receive counters, summed over all interfaces */
+struct mibNet
+{
+    uint inRunts;               /**< Frames shorter than a link header  */
+    uint inNotOurs;             /**< Frames for another hardware addr   */
+    uint inUnknownTypes;        /**< Frames with unknown ether type     */
+    uint inQueueDrops;          /**< Frames dropped, worker queue full  */
+    uint noBufs;                /**< Failed packet buffer allocations   */
+};
+
+/** IPv4 group */
+struct mibIpv4
+{
+    uint inReceives;            /**< Datagrams received                 */
+    uint inHdrErrors;           /**< Dropped by ipv4RecvValid()         */
+    uint inUnknownProtos;       /**< No protocol or raw socket for it   */
+    uint inDiscards;            /**< Dropped, raw socket buffers full   */
+    uint inDelivers;            /**< Passed to a transport protocol     */
+    uint forwDatagrams;         /**< Queued for routing                 */
+    uint forwDiscards;          /**< Dropped, routing queue full        */
+    uint outRequests;           /**< Datagrams handed to ipv4Send()     */
+    uint outNoRoutes;           /**< Dropped, no route to destination   */
+    uint reasmReqds;            /**< Fragments received                 */
+    uint reasmOKs;              /**< Datagrams reassembled              */
+    uint reasmFails;            /**< Fragments or datagrams dropped     */
+    uint reasmTimeouts;         /**< Datagrams timed out in reassembly  */
+    uint fragOKs;               /**< Datagrams fragmented               */
+    uint fragFails;             /**< Dropped, could not fragment        */
+    uint fragCreates;           /**< Fragments sent                     */
+};
+
+/** ICMP group */
+struct mibIcmp
+{
+    uint inMsgs;                /**< Messages received                  */
+    uint inErrors;              /**< Dropped, unmatched or queue full   */
+    uint inEchos;               /**< Echo requests received             */
+    uint inEchoReps;            /**< Echo replies received              */
+    uint inDestUnreachs;        /**< Destination unreachables received  */
+    uint inTimeExcds;           /**< Time exceededs received            */
+    uint outMsgs;               /**< Messages sent                      */
+    uint outErrors;             /**< Messages that could not be sent    */
+    uint outEchos;              /**< Echo requests sent                 */
+    uint outEchoReps;           /**< Echo replies sent                  */
+    uint outDestUnreachs;       /**< Destination unreachables sent      */
+    uint outTimeExcds;          /**< Time exceededs sent                */
+    uint outRedirects;          /**< Redirects sent                     */
+};
+
+/** UDP group */
+struct mibUdp
+{
+    uint inDatagrams;           /**< Datagrams delivered to sockets     */
+    uint noPorts;               /**< Dropped, no socket on port         */
+    uint inErrors;              /**< Dropped for any other reason       */
+    uint inCsumErrors;          /**< Dropped, bad checksum              */
+    uint rcvbufErrors;          /**< Dropped, socket buffers full       */
+    uint outDatagrams;          /**< Datagrams sent                     */
+};
+
+/** TCP group */
+struct mibTcp
+{
+    uint activeOpens;           /**< Active opens                       */
+    uint passiveOpens;          /**< SYNs accepted by listeners         */
+    uint inSegs;                /**< Segments received                  */
+    uint inErrs;                /**< Dropped, bad checksum              */
+    uint noPorts;               /**< No connection for segment          */
+    uint outSegs;               /**< Segments sent                      */
+    uint retransSegs;           /**< Segments retransmitted             */
+    uint outRsts;               /**< Resets sent                        */
+};
+
+/** ARP group */
+struct mibArp
+{
+    uint inRequests;            /**< Requests received                  */
+    uint inReplies;             /**< Replies received                   */
+    uint inErrors;              /**< Dropped, bad or reply queue full   */
+    uint outRequests;           /**< Requests sent                      */
+    uint outReplies;            /**< Replies sent                       */
+    uint pendingDrops;          /**< Pkts dropped waiting for address   */
+};
+
+/** All network statistics */
+struct mib
+{
+    struct mibNet net;
+    struct mibIpv4 ipv4;
+    struct mibIcmp icmp;
+    struct mibUdp udp;
+    struct mibTcp tcp;
+    struct mibArp arp;
+};
+
+extern struct mib mib;
+
+/* Snapshot export */
+#define MIB_MAGIC       0x584D4942  /**< "XMIB", first word of snapshot  */
+#define MIB_VERSION     1           /**< Snapshot format version         */
+
+/**
+ * Header of an exported snapshot.  It is followed by the words of ::mib.
+ * All words are in network byte order.
+ */
+struct mibSnapshot
+{
+    uint magic;                 /**< ::MIB_MAGIC                        */
+    uint version;               /**< ::MIB_VERSION                      */
+    uint time;                  /**< Seconds since boot                 */
+    uint nwords;                /**< Counter words that follow          */
+    uint words[sizeof(struct mib) / sizeof(uint)]; /**< Counters        */
+};
+
+/* Function Prototypes */
+void mibReset(void);
+syscall mibSend(const struct netaddr *, ushort);
+
+#endif                          /* _MIB_H_ */
@@ -7,10 +7,96 @@
 #ifndef _NETEMU_H_
 #define _NETEMU_H_
 
+#include <stddef.h>
+#include <clock.h>
+#include <network.h>
+#include <thread.h>
+
+/* Tracing macros */
+//#define TRACE_NETEMU     TTY1
+#ifdef TRACE_NETEMU
+#include <stdio.h>
+#define NETEMU_TRACE(...)     { \
+		fprintf(TRACE_NETEMU, "%s:%d (%d) ", __FILE__, __LINE__, gettid()); \
+		fprintf(TRACE_NETEMU, __VA_ARGS__); \
+		fprintf(TRACE_NETEMU, "\n"); }
+#else
+#define NETEMU_TRACE(...)
+#endif
+
+/* Emulator constants */
+#define NETEMU_QLEN         128     /**< packets held in the delay queue  */
+#define NETEMU_CHANCE       10000   /**< chances are out of this, 0.01%   */
+#define NETEMU_THR_PRIO     NET_THR_PRIO  /**< emulator thread priority   */
+#define NETEMU_THR_STK      NET_THR_STK   /**< emulator thread stack size */
+
+/* Jitter distributions */
+#define NETEMU_DIST_UNIFORM 0       /**< uniform over delay +/- jitter    */
+#define NETEMU_DIST_NORMAL  1       /**< approximately normal, sd jitter  */
+
+/**
+ * Emulated link conditions and counters of one network interface.  Packets
+ * received on the interface pass, in order, the loss, duplicate, corrupt,
+ * reorder, rate and delay stages before they reach ipv4Recv().
+ */
+struct netemu
+{
+    bool enabled;               /**< emulate this interface             */
+
+    /* Settings */
+    uint delay;                 /**< base delay in ms                   */
+    uint jitter;                /**< delay variation in ms              */
+    uchar dist;                 /**< jitter distribution                */
+    uint rate;                  /**< bandwidth in kbit/s, 0 unlimited   */
+    uint burst;                 /**< token bucket depth in bytes        */
+    ushort loss;                /**< chance to drop a packet            */
+    ushort duplicate;           /**< chance to duplicate a packet       */
+    ushort corrupt;             /**< chance to flip a bit in a packet   */
+    ushort reorder;             /**< chance a packet skips the delay    */
+
+    /* Token bucket state */
+    int tokens;                 /**< bytes that may leave now           */
+    ulong tlast;                /**< time tokens were last added, ms    */
+
+    /* Counters */
+    uint nin;                   /**< packets entering the emulator      */
+    uint nout;                  /**< packets delivered                  */
+    uint nloss;                 /**< packets dropped by the loss stage  */
+    uint ndup;                  /**< packets duplicated                 */
+    uint ncorrupt;              /**< packets corrupted                  */
+    uint nreorder;              /**< packets sent ahead of the queue    */
+    uint nqdrop;                /**< packets dropped, delay queue full  */
+};
+
+/** Packet waiting in the delay queue */
+struct emuEntry
+{
+    struct emuEntry *next;      /**< next packet by departure time      */
+    struct packet *pkt;         /**< packet to deliver                  */
+    ulong due;                  /**< departure time, ms                 */
+};
+
+extern struct netemu emutab[];
+extern struct emuEntry *emuqueue;
+extern struct emuEntry *emufree;
+extern tid_typ emuthr;
+
+/** Current time in milliseconds; call with interrupts disabled */
+#define emuNow()        ((ulong)(clktime * 1000 \
+                                 + clkticks * (1000 / CLKTICKS_PER_SEC)))
+
+/** TRUE with the given chance out of ::NETEMU_CHANCE */
+#define emuChance(c)    ((0 != (c)) \
+                         && ((uint)(rand() % NETEMU_CHANCE) < (c)))
+
+/* Function Prototypes */
 syscall netemu(struct packet *pkt);
 syscall emuCorrupt(struct packet *pkt);
+thread emuDaemon(void);
 syscall emuDelay(struct packet *pkt);
 syscall emuDrop(struct packet *pkt);
 syscall emuDuplicate(struct packet *pkt);
+syscall emuEnqueue(struct packet *pkt, ulong due);
 syscall emuReorder(struct packet *pkt);
+syscall emuStart(void);
 #endif                          /* _NETEMU_H_ */
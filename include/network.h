@@ -10,6 +10,7 @@
 #include <stddef.h>
 #include <conf.h>
 #include <ethernet.h>
+#include <semaphore.h>
 #include <string.h>
 
 /** @ingroup network
@@ -74,6 +75,18 @@ syscall netaddrhost(struct netaddr *, const struct netaddr *);
 #define netaddrcpy(dst, src)     memcpy(dst, src, sizeof(struct netaddr))
 int netaddrsprintf(char *, const struct netaddr *);
 
+/**
+ * @ingroup network
+ *
+ * Hashes a connection of a transport protocol for its demultiplexing
+ * table; reduce the result to a bucket with a power-of-2 mask
+ * @param lpt local port
+ * @param rpt remote port
+ * @param rip remote IPv4 address
+ */
+#define netPortHash(lpt, rpt, rip) \
+    ((lpt) ^ ((rpt) * 7) ^ ((rip)->addr[2] << 3) ^ (rip)->addr[3])
+
 /* Standard underlying network device driver control functions */
 
 #define NET_GET_MTU         200
@@ -81,6 +94,26 @@ int netaddrsprintf(char *, const struct netaddr *);
 #define NET_GET_HWADDR      203
 #define NET_GET_HWBRC       204
 
+/* Optional zero-copy receive.  arg1 is a (struct packet **) which receives a
+ * network pool buffer already holding the next frame.  The frame starts at
+ * pkt->data, which is also where pkt->linkhdr and pkt->curr point, and
+ * pkt->len is its length.  Blocks like read(); returns the frame length, or
+ * SYSERR if the driver does not support it.  */
+#define NET_RECV_PKT        205
+
+/* Optional gather transmit.  arg1 is an array of struct netseg describing
+ * the frame, starting with the link-level header, and arg2 is the number of
+ * segments.  Returns the frame length, or SYSERR if the driver does not
+ * support it.  */
+#define NET_SEND_SG         206
+
+/* Optional burst receive.  arg1 is an array of (struct packet *) with room
+ * for arg2 entries.  Blocks until at least one frame is available, then fills
+ * the array with as many already received frames as fit, each set up as for
+ * NET_RECV_PKT.  Returns the number of packets, or SYSERR if the driver does
+ * not support it.  */
+#define NET_RECV_BURST      207
+
 /* Network interface structure definitions */
 #ifdef NETHER
 #ifdef NETHLOOP
@@ -92,14 +125,34 @@ int netaddrsprintf(char *, const struct netaddr *);
 
 
 /* Network receive thread constants */
-#define NET_NTHR       5              /**< Num net receive threads      */
+#define NET_NTHR       5              /**< Max net recv worker threads  */
 #define NET_THR_PRIO   30             /**< Net recv thread priority     */
 #define NET_THR_STK    4096           /**< Net recv thread stack size   */
+#define NET_NBURST     8              /**< Max pkts per recv burst      */
+#define NET_WORKQLEN   32             /**< Max pkts queued per worker   */
 
 /* Network table entry states */
 #define NET_FREE   0                  /**< Netif state free             */
 #define NET_ALLOC  1                  /**< Netif state allocated        */
 
+/**
+ * Receive worker.  netRecv() steers each incoming flow to one worker by
+ * hashing its addresses and ports, so the packets of a flow are processed
+ * in order and by the same thread.
+ */
+struct netWorker
+{
+    tid_typ tid;                      /**< Worker thread id             */
+    semaphore sema;                   /**< Counts queued packets        */
+    uint head;                        /**< Index of first queued packet */
+    uint count;                       /**< Num queued packets           */
+    struct packet *pkt[NET_WORKQLEN]; /**< Queued packets               */
+    uint nproc;                       /**< Num pkts processed           */
+    uint ndrop;                       /**< Num pkts dropped, queue full */
+    bool stop;                        /**< Drain the queue and exit     */
+    semaphore done;                   /**< Signalled as the worker exits */
+};
+
 /** Net interface control block */
 struct netif
 {
@@ -113,9 +166,13 @@ struct netif
     struct netaddr ipbrc;             /**< Broadcast protocol address   */
     struct netaddr hwaddr;            /**< Hardware address             */
     struct netaddr hwbrc;             /**< Hardware broadcast address   */
-    tid_typ recvthr[NET_NTHR];        /**< Recv thread ids              */
+    tid_typ recvthr;                  /**< Recv (dispatch) thread id    */
+    uint nworker;                     /**< Num recv worker threads      */
+    struct netWorker worker[NET_NTHR]; /**< Recv worker threads         */
     uint nin;                         /**< Num recv pkts                */
     uint nproc;                       /**< Num recv pkts processed      */
+    uint ndrop;                       /**< Num recv pkts dropped        */
+    uint nout;                        /**< Num pkts sent                */
     void *capture;                    /**< Snoop capture structure      */
 };
 
@@ -130,7 +187,25 @@ extern int netpool;
  */
 #define NET_POOLSIZE		512
 
-/** Incoming packet structure       */
+#define NET_MAX_SEGS        2       /**< Max payload segments per packet */
+
+/** Segment of a gather list */
+struct netseg
+{
+    const void *data;           /**< Start of segment                   */
+    uint len;                   /**< Length of segment                  */
+};
+
+/**
+ * Incoming packet structure.
+ *
+ * An outgoing packet may carry its payload in up to ::NET_MAX_SEGS external
+ * segments (for example, a UDP application buffer or the TCP send buffer)
+ * instead of in the packet buffer.  The bytes in the buffer come first,
+ * starting at curr, and the segments follow in order.  len always counts
+ * both.  The segments must stay valid until the packet has been written to
+ * the underlying device.
+ */
 struct packet
 {
     struct netif *nif;          /**< Interface for packet               */
@@ -138,18 +213,30 @@ struct packet
     uchar *linkhdr;             /**< Pointer to link layer header       */
     uchar *nethdr;              /**< Pointer to network layer header    */
     uchar *curr;                /**< Pointer to location into packet    */
+    uint nseg;                  /**< Number of payload segments         */
+    struct netseg seg[NET_MAX_SEGS]; /**< Payload after buffer contents */
     uchar pad[2];               /**< Padding for word alignment         */
     uchar data[1];              /**< Pointer to incoming packet         */
 };
 
+/** Length of the part of a packet held in its buffer, starting at curr */
+#define netBuflen(pkt) ((pkt)->len - netSeglen(pkt))
+
 /* Function Prototypes */
 ushort netChksum(void *, uint);
+ushort netChksumSg(const struct netseg *, uint);
+void netClearbuf(struct packet *);
 syscall netDown(int);
+syscall netFlatten(struct packet *);
 syscall netFreebuf(struct packet *);
 struct packet *netGetbuf(void);
+struct packet *netGetbufNowait(void);
 syscall netInit(void);
 struct netif *netLookup(int);
 thread netRecv(struct netif *);
+thread netRecvWorker(struct netif *, struct netWorker *);
+syscall netRecvWorkers(struct netif *, uint);
+uint netSeglen(const struct packet *);
 syscall netSend(struct packet *, const struct netaddr *, const struct netaddr *,
                 ushort);
 syscall netUp(int, const struct netaddr *, const struct netaddr *,
@@ -46,6 +46,7 @@
 #define PCAP_VERSION_MAJOR 2
 #define PCAP_VERSION_MINOR 4
 #define PCAP_MAGIC         0xA1B2C3D4
+#define PCAP_LINKTYPE_ETHERNET 1
 
 #define PCAP_ERRBUF_SIZE 256
 
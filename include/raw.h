@@ -8,6 +8,7 @@
 #define _RAW_H_
 
 #include <stddef.h>
+#include <bpf.h>
 #include <ipv4.h>
 #include <network.h>
 #include <semaphore.h>
@@ -43,6 +44,7 @@
 /* Control functions */
 #define RAW_CTRL_SETFLAG   1    /**< Set flags                         */
 #define RAW_CTRL_CLRFLAG   2    /**< Clear flags                       */
+#define RAW_CTRL_SETFILTER 3    /**< Set input filter program          */
 
 /**
  *  Raw socket control block 
@@ -66,6 +68,7 @@ struct raw
     semaphore isema;                /**< Count of input packets ready       */
 
     uchar flags;                    /**< Flags                              */
+    struct bpf_program filter;      /**< Input filter, bf_len 0 if none     */
 };
 
 extern struct raw rawtab[];
@@ -24,7 +24,7 @@
 #endif
 
 /* Route Table (Must include at least one entry for default route) */
-#define RT_NENTRY         32       /**< Number of ARP table entries     */
+#define RT_NENTRY         512      /**< Number of route table entries   */
 #define RT_FREE           0        /**< Entry is free                   */
 #define RT_USED           1        /**< Entry is used                   */
 #define RT_PEND           2        /**< Entry is pending                */
@@ -47,8 +47,70 @@ struct rtEntry
     struct netif *nif;
 };
 
+/* Route lookup trie */
+#define RT_NNODE          (2 * RT_NENTRY) /**< Number of trie nodes     */
+#define RT_KEYLEN         32       /**< Bits in a route key (IPv4 addr) */
+
+/**
+ * Node of the path-compressed binary trie used for longest prefix match.
+ * Each node matches a prefix of len bits; its children extend the prefix
+ * with a 0 or 1 at bit len and skip any bits no route branches on.  Nodes
+ * without a route always have two children.
+ */
+struct rtNode
+{
+    uint key;                   /**< Prefix bits, host order            */
+    ushort len;                 /**< Prefix length in bits              */
+    struct rtEntry *route;      /**< Route for this prefix, or NULL     */
+    struct rtNode *child[2];    /**< Subtries for next bit 0 and 1      */
+};
+
+/** Route key of a 4-byte address */
+#define rtKey(a) (((uint)(a)[0] << 24) | ((uint)(a)[1] << 16) \
+                  | ((uint)(a)[2] << 8) | (uint)(a)[3])
+
+/** Mask with the top len bits of a route key set */
+#define rtMask(len) \
+    ((0 == (len)) ? 0 : (0xFFFFFFFF << (RT_KEYLEN - (len))))
+
+/** Bit n (counting from the most significant) of a route key */
+#define rtBit(key, n) (((key) >> (RT_KEYLEN - 1 - (n))) & 0x1)
+
+/* Forwarding flow cache */
+#define RT_NCACHE         64       /**< Flow cache slots (power of 2)   */
+
+/**
+ * Flow cache entry: the route and resolved next-hop hardware address for
+ * one destination, so forwarding skips the route and ARP lookups.  An
+ * entry is valid only while its generation equals ::rtcachegen.
+ */
+struct rtCacheEntry
+{
+    ulong gen;                  /**< rtcachegen when entry was filled   */
+    uint key;                   /**< Destination address, host order    */
+    uint expires;               /**< clktime when ARP entry expires     */
+    struct rtEntry *route;      /**< Route (interface and gateway)      */
+    struct netaddr hwaddr;      /**< Next-hop hardware address          */
+};
+
+/** Flow cache slot for a route key */
+#define rtCacheHash(key) (((key) ^ ((key) >> 8)) & (RT_NCACHE - 1))
+
+/**
+ * Invalidates every flow cache entry; called with interrupts disabled
+ * whenever a route or ARP entry changes.
+ */
+#define rtCacheFlush() (rtcachegen++)
+
 /* Route table */
 extern struct rtEntry rttab[RT_NENTRY];
+extern struct rtNode rtnodetab[RT_NNODE];
+extern struct rtNode *rtroot;
+extern struct rtNode *rtnodefree;
+extern struct rtCacheEntry rtcache[RT_NCACHE];
+extern ulong rtcachegen;
+extern ulong rtcachehits;
+extern ulong rtcachemisses;
 
 /* Route pakcet queue for packets requiring routing */
 extern mailbox rtqueue;
@@ -65,5 +127,7 @@ syscall rtRecv(struct packet *pkt);
 syscall rtRemove(const struct netaddr *dst);
 syscall rtClear(struct netif *nif);
 syscall rtSend(struct packet *pkt);
+struct rtEntry *rtTrieInsert(struct rtEntry *rtptr);
+syscall rtTrieRemove(struct rtEntry *rtptr);
 
 #endif                          /* _ROUTE_H_ */
@@ -9,10 +9,12 @@
 
 #include <stddef.h>
 #include <arp.h>
+#include <bpf.h>
 #include <ethernet.h>
 #include <ipv4.h>
 #include <mailbox.h>
 #include <network.h>
+#include <semaphore.h>
 #include <tcp.h>
 #include <udp.h>
 
@@ -48,6 +50,10 @@
 
 #define SNOOP_QLEN          100
 
+/* Capture ring constants */
+#define SNOOP_RING_NSLOT    256     /**< default slots in a capture ring  */
+#define SNOOP_RING_SNAPLEN  128     /**< default packet bytes per slot    */
+
 struct snoop
 {
     uint caplen;                          /**< bytes of packet to capture   */
@@ -58,9 +64,23 @@ struct snoop
     ushort srcport;                       /**< source port of packets       */
     struct netaddr dstaddr;               /**< destination address of pkts  */
     ushort dstport;                       /**< destination port of packets  */
+    struct bpf_program filter;            /**< program used instead, if any */
 
     mailbox queue;                        /**< mailbox for queueing packets */
 
+    /* Capture ring, used instead of the queue if ring is not NULL */
+    uchar *ring;                          /**< slots of PCAP records        */
+    uint nslot;                           /**< number of slots              */
+    uint slotlen;                         /**< bytes per slot               */
+    uint snaplen;                         /**< packet bytes kept per slot   */
+    uint rstart;                          /**< first filled slot            */
+    uint rcount;                          /**< number of filled slots       */
+    semaphore rsema;                      /**< count of filled slots        */
+    bool stop;                            /**< exporter should exit         */
+    ulong tssec;                          /**< seconds of last timestamp    */
+    ulong tscyc;                          /**< cycles into second tssec     */
+    ulong tslast;                         /**< clkcount() at last timestamp */
+
     uint ncap;
     uint nmatch;
     uint novrn;
@@ -70,6 +90,7 @@ struct snoop
 /* Function prototypes */
 int snoopCapture(struct snoop *cap, struct packet *pkt);
 int snoopClose(struct snoop *cap);
+thread snoopExport(struct snoop *cap, int dev, uint count);
 bool snoopFilter(struct snoop *cap, struct packet *pkt);
 int snoopOpen(struct snoop *cap, char *devname);
 int snoopPrint(struct packet *pkt, char dump, char verbose);
@@ -79,5 +100,7 @@ int snoopPrintIpv4(struct ipv4Pkt *ip, char verbose);
 int snoopPrintTcp(struct tcpPkt *tcp, char verbose);
 int snoopPrintUdp(struct udpPkt *udp, char verbose);
 struct packet *snoopRead(struct snoop *cap);
+syscall snoopRingAlloc(struct snoop *cap, uint nslot, uint snaplen);
+syscall snoopRingFree(struct snoop *cap);
 
 #endif                          /* _SNOOP_H_ */
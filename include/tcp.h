@@ -8,6 +8,7 @@
 #define _TCP_H_
 
 #include <stddef.h>
+#include <clock.h>
 #include <conf.h>
 #include <ethernet.h>
 #include <ipv4.h>
@@ -75,6 +76,15 @@ struct tcpPkt
 #define TCP_OPT_MSS      2 /**< maximum segment size */
 #define TCP_OPT_MSS_SIZE 6 /**< bytes needed for MSS option */
 #define TCP_OPT_MSS_LEN  4 /**< length of MSS option */
+#define TCP_OPT_SACKOK   4 /**< selective acknowledgement permitted */
+#define TCP_OPT_SACKOK_LEN 2 /**< length of SACK permitted option */
+#define TCP_OPT_SACK     5 /**< selective acknowledgement */
+#define TCP_OPT_SACK_LEN 2 /**< length of SACK option without blocks */
+#define TCP_OPT_SACK_BLK 8 /**< length of each SACK block */
+#define TCP_OPT_SACK_MAX 4 /**< SACK blocks sent in one segment */
+#define TCP_OPT_WSCALE   3 /**< window scale */
+#define TCP_OPT_WSCALE_LEN 3 /**< length of window scale option */
+#define TCP_OPT_WSCALE_MAX 14 /**< largest window scale shift */
 
 /* TCP Checksum Pseudo Header */
 struct tcpPseudo
@@ -89,8 +99,12 @@ struct tcpPseudo
 #define TCP_PSEUDO_LEN  12
 
 /* Buffer lengths */
-#define TCP_IBLEN 16384  /**< Size of input buffer, must be multiple of 8 */
-#define TCP_OBLEN 16384  /**< Size of output buffer */
+#define TCP_IBLEN 16384  /**< Initial size of input buffer */
+#define TCP_OBLEN 16384  /**< Initial size of output buffer */
+#define TCP_BUFMIN 4096  /**< Smallest buffer that may be requested */
+#define TCP_BUFMAX (256 * 1024) /**< Largest buffer, also for auto-tuning */
+#define TCP_WSCALE 3     /**< Window scale shift offered, enough to
+                              advertise TCP_BUFMAX */
 
 /* Initial sizes */
 #define TCP_INIT_MSS (1440 + TCP_HDR_LEN)
@@ -98,6 +112,62 @@ struct tcpPseudo
 #define TCP_INIT_WND TCP_INIT_MSS
 #define TCP_MAX_WND 65535
 
+/* Out-of-order reassembly */
+#define TCP_NRANGE  8    /**< out-of-order ranges held per connection */
+
+/**
+ * Sequence range [start, end) of out-of-order data in the input buffer
+ */
+struct tcpRange
+{
+    tcpseq start;               /**< first sequence number in range */
+    tcpseq end;                 /**< sequence number after range */
+};
+
+/* TCP Timer Constants */
+#define TCP_FREQ        1   /**< milliseconds per timer tick */
+#define TCP_WHEEL_SLOTS 256 /**< timing wheel slots, must be a power of 2 */
+#define TCP_EVT_TIMEWT  1   /**< 2MSL time-wait timeout */
+#define TCP_EVT_RXT     2   /**< retransmit event */
+#define TCP_EVT_PERSIST 3   /**< persist event, for zero window */
+#define TCP_EVT_DELACK  4   /**< delayed ACK event */
+#define TCP_NEVTS       4   /**< event types, each a timer in every TCB */
+
+/**
+ * TCP timer event.  Every TCB holds one per event type; an armed event
+ * hangs in the timing wheel slot of the tick it is due.
+ */
+struct tcpEvent
+{
+    bool used;                      /**< Is timer event armed? */
+    int time;                       /**< milliseconds scheduled for */
+    ulong due;                      /**< timer tick the event is due */
+    uchar type;                     /**< Type of event */
+    struct tcb *tcbptr;             /**< TCB for event */
+    struct tcpEvent *next;          /**< Next event in wheel slot */
+    struct tcpEvent *prev;          /**< Previous event in wheel slot */
+};
+
+/**
+ * Timer event of a TCB
+ * @param tcbptr pointer to transmission control block
+ * @param type type of timer event
+ */
+#define tcpTimerEvent(tcbptr, type)  (&(tcbptr)->events[(type) - 1])
+
+/**
+ * Current time in TCP timer ticks; call with interrupts disabled
+ */
+#define tcpTimerNow()   ((ulong)(clktime * (1000 / TCP_FREQ) \
+                                 + clkticks * (1000 / CLKTICKS_PER_SEC) \
+                                 / TCP_FREQ))
+
+extern struct tcpEvent *tcpwheel[];
+extern uint tcptimercount;
+extern ulong tcptimertick;
+extern ulong tcptimerwake;
+extern tid_typ tcptimerthr;
+
 /**
  * Transmission control block 
  */
@@ -115,6 +185,17 @@ struct tcb
     struct netaddr remoteip;    /**< Remote IP address */
     uchar opentype;             /**< Type of open call */
     semaphore openclose;
+    struct tcb *hnext;          /**< Next TCB in demultiplexing chain */
+    bool hashed;                /**< TCB is in a demultiplexing table */
+
+    /* Listen backlog */
+    uint backlog;               /**< Connections a listener may hold,
+                                     0 for a one-shot passive open */
+    uint qlen;                  /**< Connections handshaking or queued */
+    struct tcb *acceptq;        /**< Established connections to accept */
+    struct tcb *listener;       /**< Listener a connection is held by,
+                                     until it is accepted */
+    struct tcb *anext;          /**< Next connection in accept queue */
 
     /* Receive variables */
     tcpseq rcvnxt;              /**< receive next */
@@ -122,17 +203,25 @@ struct tcb
     tcpseq rcvup;               /**< receive urgent pointer */
     tcpseq rcvfin;              /**< sequence number for received FIN */
     ushort rcvmss;              /**< maximum receive segment size */
-    uchar rcvflg;               /**< receive flags */
+    ushort rcvflg;              /**< receive flags */
+    uchar rcvscale;             /**< shift applied to windows sent */
 
     /* Receive buffer */
     semaphore readers;          /**< Count of readers waiting for data */
     uint istart;                /**< Index of first octet ready for user */
     uint icount;                /**< Count of octets ready for user */
     uint inxt;
-    uchar in[TCP_IBLEN];        /**< Input buffer */
-    uchar imark[TCP_IBLEN];
+    uchar *in;                  /**< Input buffer */
+    uint ilen;                  /**< Size of input buffer */
     uint ibytes;                /**< Count of bytes passed to user */
 
+    /* Out-of-order data beyond rcvnxt, sorted and never touching */
+    struct tcpRange rcvrange[TCP_NRANGE];
+    uint rcvnrange;             /**< Count of out-of-order ranges */
+    tcpseq rcvsack;             /**< Latest out-of-order sequence number,
+                                     its range is the first SACK block */
+    uint rcvunacked;            /**< Octets received but not yet ACKed */
+
     /* Send variables */
     tcpseq snduna;                  /**< send unacknowledged */
     tcpseq sndnxt;                  /**< send next */
@@ -145,23 +234,83 @@ struct tcb
     tcpseq iss;                     /**< initial send seq num */
     tcpseq sndfin;                  /**< sequence number for sent FIN */
     ushort sndmss;                  /**< maximum send segment size */
-    uchar sndflg;                   /**< send flags */
+    ushort sndflg;                  /**< send flags */
+    uchar sndscale;                 /**< shift applied to windows received */
     int sndrtt;                     /**< smoothed sending round trip time */
     int sndrtd;                     /**< sending round trip deviation */
     int rxttime;                    /**< retransmission timer */
     uint rxtcount;                  /**< number of retransmissions */
     int psttime;                    /**< persist timer */
+    uint dupacks;                   /**< consecutive duplicate ACKs */
+    tcpseq sndrecover;              /**< sndnxt when fast recovery began */
+    tcpseq sndrxtnxt;               /**< next seq num fast recovery may
+                                         retransmit */
+
+    /* Data beyond snduna the receiver has selectively acknowledged */
+    struct tcpRange sndsack[TCP_NRANGE];
+    uint sndnsack;                  /**< Count of SACKed ranges */
 
     /* Send buffer */
     semaphore writers;         /**< Count of writers waiting for buffer */
     uint ostart;               /**< Index of first octet */
     uint ocount;               /**< Octets in buffer */
-    uchar out[TCP_OBLEN];      /**< Output buffer */
+    uchar *out;                /**< Output buffer */
+    uint olen;                 /**< Size of output buffer */
     uint obytes;               /**< Count of bytes acknowledged by receiver */
+
+    /* Statistics */
+    uint sndsegs;              /**< Segments sent */
+    uint sndoctets;            /**< Payload octets sent, with resends */
+    uint rcvsegs;              /**< Segments received */
+    uint rcvoctets;            /**< Payload octets received */
+    uint rxtsegs;              /**< Segments resent on timeout */
+    uint fastsegs;             /**< Segments resent in fast recovery */
+    uint dupackcount;          /**< Duplicate ACKs received */
+    uint recoveries;           /**< Fast recoveries entered */
+    uint rttcount;             /**< Round trip samples taken */
+    uint rttsum;               /**< Sum of round trip samples, ms */
+    uint rttmin;               /**< Least round trip sample, ms */
+    uint rttmax;               /**< Greatest round trip sample, ms */
+    uint cwnmax;               /**< Largest congestion window */
+    uint zerownds;             /**< Times the send window closed */
+    ulong pststart;            /**< When persist began, ms */
+    ulong psttotal;            /**< Time spent in persist, ms */
+    bool log;                  /**< Record events in the event log */
+
+    /* Buffer auto-tuning */
+    bool iauto;                /**< Size input buffer from bandwidth x RTT */
+    bool oauto;                /**< Size output buffer from bandwidth x RTT */
+    ulong tunetime;            /**< Time of last tuning sample, ms */
+    uint tuneibytes;           /**< ibytes at last tuning sample */
+    uint tuneobytes;           /**< obytes at last tuning sample */
+
+    /* Timers */
+    struct tcpEvent events[TCP_NEVTS]; /**< Timer events, by type */
 };
 
 extern struct tcb tcptab[];
 
+/* Demultiplexing tables */
+#define TCP_NHASH 64     /**< buckets per table, must be a power of 2 */
+
+/**
+ * Bucket for a connection with fully specified remote endpoint
+ * @param lpt local port
+ * @param rpt remote port
+ * @param rip remote IPv4 address
+ */
+#define tcpHashConn(lpt, rpt, rip) \
+    (netPortHash(lpt, rpt, rip) & (TCP_NHASH - 1))
+
+/**
+ * Bucket for a listening or partially specified TCB
+ * @param lpt local port
+ */
+#define tcpHashListen(lpt)  ((lpt) & (TCP_NHASH - 1))
+
+extern struct tcb *tcpconntab[];
+extern struct tcb *tcplistentab[];
+
 /* Local port allocation ranges */
 #define TCP_PSTART 10000     /**< start port for allocating */
 #define TCP_PMAX   65000        /**< max TCP port */
@@ -190,6 +339,12 @@ extern struct tcb tcptab[];
 #define TCP_FLG_SNDDATA  0x08   /**< Need to send data */
 #define TCP_FLG_SNDRST   0x10   /**< Need to send a RST */
 #define TCP_FLG_PERSIST  0x20   /**< In persist output state */
+#define TCP_FLG_SACKOK   0x40   /**< Remote side permits SACK */
+#define TCP_FLG_RECOVER  0x80   /**< In fast recovery */
+#define TCP_FLG_WSCALE   0x100  /**< Remote side scales windows */
+#define TCP_FLG_DELACK   0x200  /**< ACK delayed, timer is armed */
+#define TCP_FLG_NODELAY  0x400  /**< Send partial segments at once */
+#define TCP_FLG_CORK     0x800  /**< Hold partial segments until uncorked */
 
 #define TCP_SEQINCR 904 /**< amount to increment ISS each time */
 
@@ -211,14 +366,6 @@ extern struct tcb tcptab[];
 /* TCP Length Macros */
 #define tcpSeglen(tcppkt, len) (len - offset2octets(tcppkt->offset))
 
-/* TCP Timer Constants */
-#define TCP_NEVENTS     (3*NTCP)+1 /**< max number events (incl dummy head) */
-#define TCP_EVT_HEAD    0   /**< Head entry */
-#define TCP_FREQ        10  /**< milliseconds per timer tick */
-#define TCP_EVT_TIMEWT  1   /**< 2MSL time-wait timeout */
-#define TCP_EVT_RXT     2   /**< retransmit event */
-#define TCP_EVT_PERSIST 3   /**< persist event, for zero window */
-
 /* TCP Timer Durations */
 #define TCP_TWOMSL  (5*1000)
 #define TCP_PST_INITTIME (3*1000)  /**< initial persist time */
@@ -229,24 +376,53 @@ extern struct tcb tcptab[];
 #define TCP_RXT_INITTIME (500)  /**< initial retransmission time */
 #define TCP_RXT_MINTIME  (100)    /**< minimum retransmission time */
 #define TCP_RXT_MAXTIME  (32*1000) /**< maximum retransmission time */
+#define TCP_RXT_DUPACKS  3          /**< duplicate ACKs for fast retransmit */
 
-/* TCP Timer Event */
-struct tcpEvent
-{
-    bool used;                      /**< Is timer event record used? */
-    int time;                       /**< number of TCP timer ticks for event */
-    int remain;                     /**< TCP timer ticks remain */
-    uchar type;                     /**< Type of event */
-    struct tcb *tcbptr;             /**< TCB for event */
-    struct tcpEvent *next;          /**< Next timer event */
-};
-
-extern struct tcpEvent tcptimertab[];
-extern semaphore tcpmutex;
+/* TCP Delayed ACK */
+#define TCP_DELACK_TIME  200        /**< longest an ACK is delayed */
+#define TCP_DELACK_SEGS  2          /**< full segments ACKed at once */
 
 /* TCP Control Functions */
 #define TCP_CTRL_RECVBYTES 2 /**< Get number of bytes recevied */
 #define TCP_CTRL_SENTBYTES 3 /**< Get number of bytes sent */
+#define TCP_CTRL_RCVBUF    4 /**< Set input buffer size, 0 auto-tunes */
+#define TCP_CTRL_SNDBUF    5 /**< Set output buffer size, 0 auto-tunes */
+#define TCP_CTRL_NODELAY   6 /**< Disable Nagle coalescing if arg1 TRUE */
+#define TCP_CTRL_CORK      7 /**< Hold partial segments while arg1 TRUE */
+#define TCP_CTRL_BACKLOG   8 /**< Set listen backlog, before passive open */
+#define TCP_CTRL_ACCEPT    9 /**< Wait for a connection, return its device */
+#define TCP_CTRL_LOG      10 /**< Record events in the log if arg1 TRUE */
+
+/* TCP Event Log */
+#define TCP_LOG_LEN     256 /**< entries in the event log ring */
+#define TCP_LOG_ACK     1   /**< new data ACKed, value is octets */
+#define TCP_LOG_DUPACK  2   /**< duplicate ACK, value is the run */
+#define TCP_LOG_RTT     3   /**< round trip sample, value is ms */
+#define TCP_LOG_RTO     4   /**< retransmit timeout, value is the count */
+#define TCP_LOG_FAST    5   /**< fast retransmit, value is octets in flight */
+#define TCP_LOG_RECOVER 6   /**< resent in recovery, value is octets */
+#define TCP_LOG_PERSIST 7   /**< send window closed */
+#define TCP_LOG_OPEN    8   /**< send window reopened, value is ms closed */
+
+/**
+ * TCP event log entry, recording the congestion state after an event
+ */
+struct tcpLogEntry
+{
+    ulong time;                 /**< milliseconds since boot */
+    ushort dev;                 /**< TCP device of connection */
+    uchar event;                /**< TCP_LOG_* event */
+    tcpseq snduna;              /**< send unacknowledged */
+    uint sndcwn;                /**< congestion window */
+    uint sndsst;                /**< slow start threshold */
+    uint sndwnd;                /**< send window */
+    int sndrtt;                 /**< smoothed round trip time, ms */
+    int value;                  /**< event detail */
+};
+
+extern struct tcpLogEntry tcplog[];
+extern uint tcplognext;         /**< count of entries ever logged */
+extern bool tcplogall;          /**< log every connection set up */
 
 /* TCP Ports */
 #define TCP_PORT_TELNET    23
@@ -262,13 +438,22 @@ devcall tcpGetc(device *);
 devcall tcpPutc(device *, char);
 devcall tcpControl(device *, int, long, long);
 
+devcall tcpAccept(struct tcb *);
 ushort tcpAlloc(void);
+int tcpBufResize(struct tcb *, uint, uint);
+void tcpBufTune(struct tcb *);
 ushort tcpChksum(struct packet *, ushort, struct netaddr *,
                  struct netaddr *);
 devcall tcpFree(struct tcb *);
+void tcpHashInsert(struct tcb *);
+void tcpHashRemove(struct tcb *);
+void tcpLog(struct tcb *, uchar, int);
+void tcpLogDump(void);
 int tcpOpenActive(struct tcb *);
 void tcpAbort(struct tcb *, int);
 int tcpSetup(struct tcb *);
+struct tcb *tcpSpawn(struct tcb *, struct netaddr *, ushort);
+int tcpRangeAdd(struct tcpRange *, uint *, tcpseq, tcpseq);
 
 struct tcb *tcpDemux(ushort, ushort, struct netaddr *, struct netaddr *);
 int tcpRecv(struct packet *, struct netaddr *, struct netaddr *);
@@ -282,11 +467,12 @@ int tcpRecvAck(struct packet *, struct tcb *);
 int tcpRecvRtt(struct tcb *);
 
 int tcpSend(struct tcb *, uchar, uint, uint, uint, ushort);
-ushort tcpSendWindow(struct tcb *);
+uint tcpSendWindow(struct tcb *);
 int tcpSendAck(struct tcb *);
 int tcpSendSyn(struct tcb *);
 int tcpSendData(struct tcb *);
 int tcpSendRxt(struct tcb *);
+int tcpSendRecover(struct tcb *);
 int tcpSendPersist(struct tcb *);
 int tcpSendRst(struct packet *, struct netaddr *, struct netaddr *);
 
@@ -27,6 +27,7 @@
 #endif
 
 #define TELNET_PORT     23      /**< default telnet port                    */
+#define TELNET_BACKLOG  4     /**< connections held while servers are busy */
 #define TELNET_IBLEN    80    /**< input buffer length                    */
 #define TELNET_OBLEN    80    /**< output buffer length                   */
 
@@ -109,6 +110,7 @@ struct telnet
 };
 
 extern struct telnet telnettab[];
+extern int telnetlisten;        /**< listening TCP device, or SYSERR */
 
 /* Driver functions */
 int telnetAlloc(void);
@@ -121,6 +123,6 @@ devcall telnetGetc(device *);
 devcall telnetPutc(device *, char);
 devcall telnetControl(device *, int, long, long);
 devcall telnetFlush(device *);
-thread telnetServer(int, int, ushort, char *);
+thread telnetServer(int, ushort, char *);
 
 #endif                          /* _TELNET_H_ */
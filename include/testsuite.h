@@ -43,6 +43,8 @@ thread test_snoop(bool);
 thread test_udp(bool);
 thread test_raw(bool);
 thread test_ip(bool);
+thread test_route(bool);
+thread test_tcp(bool);
 thread test_umemory(bool);
 thread test_tlb(bool);
 
@@ -51,6 +53,21 @@ void testFail(bool, const char *);
 void testSkip(bool, const char *);
 void testPrint(bool, const char *);
 
+/* Demultiplexing benchmarks shared by the network tests */
+struct netaddr;
+
+/**
+ * Demultiplexing lookup timed by testBenchDemux()
+ * @param ctx     context given to testBenchDemux()
+ * @param key     benchmark key looked up
+ * @param remote  remote address testBenchAddr() builds for 0x100 + key
+ * @return entry found, NULL if none
+ */
+typedef void *(*testlookup) (void *ctx, uint key, struct netaddr *remote);
+
+void testBenchAddr(struct netaddr *, uint);
+bool testBenchDemux(bool, uint, uint, testlookup, testlookup, void *);
+
 /**
  * Causes the test to fail if condition is met and display failmsg in that
  * case.  Otherwise, the test will pass.
@@ -102,6 +102,7 @@ message recvtime(int);
 tid_typ create(void *procaddr, uint ssize, int priority,
                const char *name, int nargs, ...);
 tid_typ gettid(void);
+syscall chprio(tid_typ, int);
 syscall getprio(tid_typ);
 syscall kill(int);
 int ready(tid_typ, bool);
@@ -70,6 +70,24 @@
 #define UDP_PSTART  10000   /**< start port for allocating */
 #define UDP_PMAX    65000   /**< max UDP port */
 
+/* Demultiplexing tables */
+#define UDP_NHASH   64      /**< buckets per table, must be a power of 2 */
+
+/**
+ * Bucket for a socket bound to both remote port and remote IP address
+ * @param lpt local port
+ * @param rpt remote port
+ * @param rip remote IPv4 address
+ */
+#define udpHashExact(lpt, rpt, rip) \
+    (netPortHash(lpt, rpt, rip) & (UDP_NHASH - 1))
+
+/**
+ * Bucket for a socket with a wildcard remote port or IP address
+ * @param lpt local port
+ */
+#define udpHashWild(lpt)    ((lpt) & (UDP_NHASH - 1))
+
 #ifndef __ASSEMBLER__
 
 /*
@@ -140,9 +158,14 @@ struct udp
 
     uchar state;                        /**< UDP state                      */
     uchar flags;                        /**< UDP flags                      */
+
+    struct udp *hnext;                  /**< Next in demultiplexing chain   */
+    bool hashed;                        /**< In a demultiplexing table      */
 };
 
 extern struct udp udptab[];
+extern struct udp *udpexacttab[];
+extern struct udp *udpwildtab[];
 
 /** @} */
 
@@ -163,6 +186,8 @@ syscall udpSend(struct udp *, ushort, const void *);
 devcall udpControl(device *, int, long, long);
 struct udpPkt *udpGetbuf(struct udp *);
 syscall udpFreebuf(struct udpPkt *);
+void udpHashInsert(struct udp *);
+void udpHashRemove(struct udp *);
 
 #endif                          /* __ASSEMBLER__ */
 
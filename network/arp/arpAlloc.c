@@ -11,13 +11,17 @@
 /**
  * @ingroup arp
  *
- * Allocates an entry from the ARP table.
+ * Allocates an entry from the ARP table and adds it to the hash bucket for
+ * its protocol address.  If the table is full, the entry closest to
+ * expiring is freed and reused.
+ * @param praddr protocol address the entry is for
  * @return entry in ARP table, SYSERR if error occurs
  * @pre-condition interrupts are disabled
  * @post-condition interrupts are still disabled
  */
-struct arpEntry *arpAlloc(void)
+struct arpEntry *arpAlloc(const struct netaddr *praddr)
 {
+    struct arpEntry *entry = NULL;
     struct arpEntry *minexpires = NULL;
     int i = 0;
 
@@ -25,12 +29,12 @@ struct arpEntry *arpAlloc(void)
 
     for (i = 0; i < ARP_NENTRY; i++)
     {
-        /* If entry is free, return entry */
+        /* If entry is free, use entry */
         if (ARP_FREE == arptab[i].state)
         {
-            arptab[i].state = ARP_USED;
             ARP_TRACE("\tFree entry %d", i);
-            return &arptab[i];
+            entry = &arptab[i];
+            break;
         }
 
         if ((NULL == minexpires)
@@ -42,15 +46,26 @@ struct arpEntry *arpAlloc(void)
         }
     }
 
-    /* If no free or minimum expires entry was found an error occured */
-    if (NULL == minexpires)
+    /* Otherwise reuse entry with minimum expires */
+    if (NULL == entry)
     {
-        ARP_TRACE("\tNo free or minexpires entry");
-        return (struct arpEntry *)SYSERR;
+        /* If no free or minimum expires entry was found an error occured */
+        if (NULL == minexpires)
+        {
+            ARP_TRACE("\tNo free or minexpires entry");
+            return (struct arpEntry *)SYSERR;
+        }
+        arpFree(minexpires);
+        entry = minexpires;
     }
 
-    /* Return entry with minimum expires */
-    bzero(minexpires, sizeof(struct arpEntry));
-    minexpires->state = ARP_USED;
-    return minexpires;
+    entry->state = ARP_USED;
+    if (NULL != praddr)
+    {
+        netaddrcpy(&entry->praddr, praddr);
+        i = arpHash(praddr);
+        entry->next = arphash[i];
+        arphash[i] = entry;
+    }
+    return entry;
 }
@@ -7,16 +7,20 @@
 #include <stddef.h>
 #include <arp.h>
 #include <interrupt.h>
+#include <route.h>
 #include <stdlib.h>
 
 /**
  * @ingroup arp
  *
- * Frees an entry from the ARP table.
+ * Frees an entry from the ARP table, dropping any packets queued on it.
  * @return SYSERR if error occurs, otherwise OK
  */
 syscall arpFree(struct arpEntry *entry)
 {
+    struct arpEntry **prev;
+    int i;
+
     ARP_TRACE("Freeing ARP entry");
 
     /* Error check pointers */
@@ -32,8 +36,26 @@ syscall arpFree(struct arpEntry *entry)
         ARP_TRACE("Waiting threads notified");
     }
 
+    /* Unlink from hash bucket */
+    for (prev = &arphash[arpHash(&entry->praddr)]; NULL != *prev;
+         prev = &(*prev)->next)
+    {
+        if (*prev == entry)
+        {
+            *prev = entry->next;
+            break;
+        }
+    }
+
+    /* Drop packets that were waiting for resolution */
+    for (i = 0; i < entry->npending; i++)
+    {
+        netFreebuf(entry->pending[i]);
+    }
+
     /* Clear ARP table entry */
     bzero(entry, sizeof(struct arpEntry));
+    rtCacheFlush();
     entry->state = ARP_FREE;
     ARP_TRACE("Freed entry %d",
               ((int)entry - (int)arptab) / sizeof(struct arpEntry));
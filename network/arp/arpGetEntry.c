@@ -18,27 +18,22 @@
  */
 struct arpEntry *arpGetEntry(const struct netaddr *praddr)
 {
-    int i = 0;
     struct arpEntry *entry = NULL;  /**< pointer to ARP table entry   */
-    irqmask im;                         /**< interrupt state              */
+    struct arpEntry *next = NULL;   /**< next entry in hash bucket    */
+    irqmask im;                     /**< interrupt state              */
 
     ARP_TRACE("Getting ARP entry");
     im = disable();
 
-    /* Loop through ARP table */
-    for (i = 0; i < ARP_NENTRY; i++)
+    /* Loop through hash bucket for the address */
+    for (entry = arphash[arpHash(praddr)]; NULL != entry; entry = next)
     {
-        /* If ARP entry is not used, skip to next entry */
-        if (!(ARP_USED & arptab[i].state))
-        {
-            continue;
-        }
+        next = entry->next;
 
-        entry = &arptab[i];
         /* Check if entry has timed out */
         if (entry->expires < clktime)
         {
-            ARP_TRACE("\tEntry %d expired", i);
+            ARP_TRACE("\tEntry %d expired", entry - arptab);
             arpFree(entry);
             continue;
         }
@@ -47,7 +42,7 @@ struct arpEntry *arpGetEntry(const struct netaddr *praddr)
         if (netaddrequal(&entry->praddr, praddr))
         {
             restore(im);
-            ARP_TRACE("\tEntry %d matches", i);
+            ARP_TRACE("\tEntry %d matches", entry - arptab);
             return entry;
         }
     }
@@ -11,6 +11,7 @@
 #include <thread.h>
 
 struct arpEntry arptab[ARP_NENTRY];
+struct arpEntry *arphash[ARP_NHASH];
 mailbox arpqueue;
 
 /**
@@ -29,6 +30,10 @@ syscall arpInit(void)
         bzero(&arptab[i], sizeof(struct arpEntry));
         arptab[i].state = ARP_FREE;
     }
+    for (i = 0; i < ARP_NHASH; i++)
+    {
+        arphash[i] = NULL;
+    }
 
     /* Initialize ARP queue */
     arpqueue = mailboxAlloc(ARP_NQUEUE);
@@ -42,5 +47,10 @@ syscall arpInit(void)
           ((void *)arpDaemon, ARP_THR_STK, ARP_THR_PRIO, "arpDaemon", 0),
           RESCHED_NO);
 
+    /* Spawn arpRetryDaemon thread */
+    ready(create
+          ((void *)arpRetryDaemon, ARP_THR_STK, ARP_THR_PRIO,
+           "arpRetryDaemon", 0), RESCHED_NO);
+
     return OK;
 }
@@ -14,7 +14,9 @@
 /**
  * @ingroup arp
  *
- * Obtains a hardware address from the ARP table given a protocol address.
+ * Obtains a hardware address from the ARP table given a protocol address,
+ * blocking the calling thread until the address is resolved.  The
+ * transmit path uses arpResolve() instead, which never blocks.
  * @param netptr network interface
  * @param praddr protocol address
  * @param hwaddr buffer into which hardware address should be placed
@@ -52,7 +54,7 @@ syscall arpLookup(struct netif *netptr, const struct netaddr *praddr,
         if (NULL == entry)
         {
             ARP_TRACE("Entry does not exist");
-            entry = arpAlloc();
+            entry = arpAlloc(praddr);
             if (SYSERR == (int)entry)
             {
                 restore(im);
@@ -61,15 +63,16 @@ syscall arpLookup(struct netif *netptr, const struct netaddr *praddr,
 
             entry->state = ARP_UNRESOLVED;
             entry->nif = netptr;
-            netaddrcpy(&entry->praddr, praddr);
             entry->expires = clktime + ARP_TTL_UNRESOLVED;
             entry->count = 0;
+            entry->backoff = ARP_RETRY_INIT;
         }
 
         /* Place hardware address in buffer if entry is resolved */
         if (ARP_RESOLVED == entry->state)
         {
             netaddrcpy(hwaddr, &entry->hwaddr);
+            restore(im);
             ARP_TRACE("Entry exists");
             return OK;
         }
@@ -84,6 +87,7 @@ syscall arpLookup(struct netif *netptr, const struct netaddr *praddr,
         entry->waiting[entry->count] = gettid();
         entry->count++;
         ttl = (entry->expires - clktime) * CLKTICKS_PER_SEC;
+        entry->retry = clktime + entry->backoff;
         restore(im);
 
         /* Send an ARP request and wait for response */
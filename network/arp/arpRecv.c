@@ -11,7 +11,9 @@
 #include <interrupt.h>
 #include <ipv4.h>
 #include <mailbox.h>
+#include <mib.h>
 #include <network.h>
+#include <route.h>
 #include <string.h>
 
 /**
@@ -29,6 +31,10 @@ syscall arpRecv(struct packet *pkt)
     struct netaddr sha;             /**< source hardware address        */
     struct netaddr spa;             /**< source protocol address        */
     struct netaddr dpa;             /**< destination protocol address   */
+    struct packet *pending[ARP_NPENDING]; /**< packets now resolved     */
+    ushort pendtype[ARP_NPENDING];  /**< link-level type of each        */
+    int npending = 0;               /**< count of resolved packets      */
+    int i;
     irqmask im;                     /**< interrupt state                */
 
     /* Error check pointers */
@@ -54,6 +60,7 @@ syscall arpRecv(struct packet *pkt)
         || (ETH_ADDR_LEN != arp->hwalen))
     {
         ARP_TRACE("Hardware type not Ethernet");
+        mib.arp.inErrors++;
         netFreebuf(pkt);
         return SYSERR;
     }
@@ -63,10 +70,20 @@ syscall arpRecv(struct packet *pkt)
         || (IPv4_ADDR_LEN != arp->pralen))
     {
         ARP_TRACE("Protocol type not IPv4");
+        mib.arp.inErrors++;
         netFreebuf(pkt);
         return SYSERR;
     }
 
+    if (ARP_OP_RQST == net2hs(arp->op))
+    {
+        mib.arp.inRequests++;
+    }
+    else if (ARP_OP_REPLY == net2hs(arp->op))
+    {
+        mib.arp.inReplies++;
+    }
+
     /* Obtain source hardware address */
     sha.type = net2hs(arp->hwtype);
     sha.len = arp->hwalen;
@@ -83,6 +100,10 @@ syscall arpRecv(struct packet *pkt)
     if (entry != NULL)
     {
         ARP_TRACE("Entry already exists");
+        if (!netaddrequal(&entry->hwaddr, &sha))
+        {
+            rtCacheFlush();
+        }
         netaddrcpy(&entry->hwaddr, &sha);
         entry->expires = clktime + ARP_TTL_RESOLVED;
 
@@ -93,6 +114,29 @@ syscall arpRecv(struct packet *pkt)
             arpNotify(entry, ARP_MSG_RESOLVED);
             ARP_TRACE("Notified waiting threads");
         }
+
+        /* Take packets queued while the entry was unresolved */
+        npending = entry->npending;
+        for (i = 0; i < npending; i++)
+        {
+            pending[i] = entry->pending[i];
+            pendtype[i] = entry->pendtype[i];
+        }
+        entry->npending = 0;
+        entry->backoff = ARP_RETRY_INIT;
+    }
+
+    /* Send packets that were waiting for this address */
+    if (npending > 0)
+    {
+        restore(im);
+        for (i = 0; i < npending; i++)
+        {
+            netSend(pending[i], &sha, NULL, pendtype[i]);
+            netFreebuf(pending[i]);
+        }
+        ARP_TRACE("Sent %d pending packets", npending);
+        im = disable();
     }
 
     /* Obtain destination protocol address */
@@ -106,7 +150,7 @@ syscall arpRecv(struct packet *pkt)
         /* If entry did not already exist, then entry should be added */
         if (NULL == entry)
         {
-            entry = arpAlloc();
+            entry = arpAlloc(&spa);
             if (SYSERR == (int)entry)
             {
                 restore(im);
@@ -117,7 +161,6 @@ syscall arpRecv(struct packet *pkt)
             entry->state = ARP_RESOLVED;
             entry->nif = pkt->nif;
             netaddrcpy(&entry->hwaddr, &sha);
-            netaddrcpy(&entry->praddr, &spa);
             entry->expires = clktime + ARP_TTL_RESOLVED;
             ARP_TRACE("Added entry %d (state = %d)",
                       ((int)entry -
@@ -130,6 +173,7 @@ syscall arpRecv(struct packet *pkt)
         {
             if (mailboxCount(arpqueue) >= ARP_NQUEUE)
             {
+                mib.arp.inErrors++;
                 restore(im);
                 netFreebuf(pkt);
                 return SYSERR;
@@ -0,0 +1,154 @@
+/**
+ * @file arpResolve.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <arp.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <mib.h>
+#include <network.h>
+#include <string.h>
+
+static struct packet *arpCopy(struct packet *);
+
+/**
+ * @ingroup arp
+ *
+ * Obtains a hardware address from the ARP table without blocking.  If the
+ * address is not resolved yet, a copy of the packet is queued on the ARP
+ * entry and sent by arpRecv() when the reply arrives.  Once the queue is
+ * full, the oldest packet is dropped.  ARP requests for an unresolved entry
+ * are repeated at most once per backoff interval, which doubles up to
+ * ::ARP_RETRY_MAX seconds; arpRetryDaemon() repeats them while packets are
+ * queued even if no more traffic arrives.
+ * @param netptr network interface
+ * @param praddr protocol address
+ * @param hwaddr buffer into which hardware address should be placed
+ * @param pkt packet to queue if the address is unresolved, starting at the
+ *      network-level header; NULL to only start resolution.  The caller
+ *      keeps ownership of pkt.
+ * @param type link-level type to send the queued packet with
+ * @return OK if hardware address was obtained, ARP_PENDING if resolution
+ *      is in progress, otherwise SYSERR
+ */
+syscall arpResolve(struct netif *netptr, const struct netaddr *praddr,
+                   struct netaddr *hwaddr, struct packet *pkt, ushort type)
+{
+    struct arpEntry *entry = NULL;  /**< pointer to ARP table entry   */
+    struct packet *copy = NULL;     /**< packet queued on entry       */
+    bool rqst = FALSE;              /**< send an ARP request          */
+    irqmask im;                     /**< interrupt state              */
+
+    /* Error check pointers */
+    if ((NULL == netptr) || (NULL == praddr) || (NULL == hwaddr))
+    {
+        ARP_TRACE("Invalid args");
+        return SYSERR;
+    }
+
+    im = disable();
+    entry = arpGetEntry(praddr);
+
+    /* Place hardware address in buffer if entry is resolved */
+    if ((NULL != entry) && (ARP_RESOLVED == entry->state))
+    {
+        netaddrcpy(hwaddr, &entry->hwaddr);
+        restore(im);
+        return OK;
+    }
+
+    /* If ARP entry does not exist; create an unresolved entry */
+    if (NULL == entry)
+    {
+        ARP_TRACE("Entry does not exist");
+        entry = arpAlloc(praddr);
+        if (SYSERR == (int)entry)
+        {
+            restore(im);
+            return SYSERR;
+        }
+
+        entry->state = ARP_UNRESOLVED;
+        entry->nif = netptr;
+        entry->expires = clktime + ARP_TTL_UNRESOLVED;
+        entry->count = 0;
+        entry->retry = clktime;
+        entry->backoff = ARP_RETRY_INIT;
+    }
+
+    /* Queue a copy of the packet, dropping the oldest if the queue is
+     * full */
+    copy = arpCopy(pkt);
+    if ((NULL != copy) && (SYSERR != (int)copy))
+    {
+        if (ARP_NPENDING == entry->npending)
+        {
+            ARP_TRACE("Pending queue full");
+            mib.arp.pendingDrops++;
+            netFreebuf(entry->pending[0]);
+            entry->npending--;
+            memmove(&entry->pending[0], &entry->pending[1],
+                    entry->npending * sizeof(entry->pending[0]));
+            memmove(&entry->pendtype[0], &entry->pendtype[1],
+                    entry->npending * sizeof(entry->pendtype[0]));
+        }
+        entry->pending[entry->npending] = copy;
+        entry->pendtype[entry->npending] = type;
+        entry->npending++;
+    }
+
+    /* Send a request if the backoff interval has passed */
+    rqst = arpRetryDue(entry);
+    restore(im);
+
+    if (rqst && (SYSERR == arpSendRqst(entry)))
+    {
+        ARP_TRACE("Failed to send request");
+    }
+    if (SYSERR == (int)copy)
+    {
+        mib.arp.pendingDrops++;
+        return SYSERR;
+    }
+    return ARP_PENDING;
+}
+
+/**
+ * Copies a packet from its network-level header into a new buffer, which
+ * leaves room in front for the link-level header.
+ * @return copy of the packet, NULL if pkt is NULL, SYSERR if no buffer is
+ *      free
+ */
+static struct packet *arpCopy(struct packet *pkt)
+{
+    struct packet *copy;
+    uint buflen;
+    uint i;
+
+    if (NULL == pkt)
+    {
+        return NULL;
+    }
+
+    copy = netGetbufNowait();
+    if (SYSERR == (int)copy)
+    {
+        return copy;
+    }
+
+    copy->nif = pkt->nif;
+    copy->len = pkt->len;
+    copy->curr -= pkt->len;
+    copy->nethdr = copy->curr;
+    buflen = netBuflen(pkt);
+    memcpy(copy->curr, pkt->curr, buflen);
+    for (i = 0; i < pkt->nseg; i++)
+    {
+        memcpy(copy->curr + buflen, pkt->seg[i].data, pkt->seg[i].len);
+        buflen += pkt->seg[i].len;
+    }
+    return copy;
+}
@@ -0,0 +1,62 @@
+/**
+ * @file arpRetryDaemon.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <arp.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <thread.h>
+
+/**
+ * @ingroup arp
+ *
+ * ARP retry daemon; once a second it repeats the request for each
+ * unresolved entry that has packets queued and whose backoff interval has
+ * passed, so resolution does not depend on more outbound traffic.
+ * Unresolved entries that have expired are freed with their packets.
+ */
+thread arpRetryDaemon(void)
+{
+    struct arpEntry *entry;
+    irqmask im;
+    int i;
+
+    while (TRUE)
+    {
+        sleep(1000);
+
+        im = disable();
+        for (i = 0; i < ARP_NENTRY; i++)
+        {
+            entry = &arptab[i];
+            if ((ARP_UNRESOLVED != entry->state) || (0 == entry->npending))
+            {
+                continue;
+            }
+            if (entry->expires < clktime)
+            {
+                ARP_TRACE("Entry %d expired", i);
+                arpFree(entry);
+                continue;
+            }
+            if (!arpRetryDue(entry))
+            {
+                continue;
+            }
+            restore(im);
+
+            if (SYSERR == arpSendRqst(entry))
+            {
+                ARP_TRACE("Failed to resend request");
+            }
+
+            im = disable();
+        }
+        restore(im);
+    }
+
+    return OK;
+}
@@ -0,0 +1,32 @@
+/**
+ * @file arpRetryDue.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <arp.h>
+#include <clock.h>
+
+/**
+ * @ingroup arp
+ *
+ * Checks whether the backoff interval of an unresolved entry has passed,
+ * and if so starts the next one, doubling it up to ::ARP_RETRY_MAX
+ * seconds.  Must be called with interrupts disabled.
+ * @param entry unresolved ARP table entry
+ * @return TRUE if an ARP request should be sent now
+ */
+bool arpRetryDue(struct arpEntry *entry)
+{
+    if ((int)(clktime - entry->retry) < 0)
+    {
+        return FALSE;
+    }
+    entry->retry = clktime + entry->backoff;
+    if (entry->backoff < ARP_RETRY_MAX)
+    {
+        entry->backoff *= 2;
+    }
+    return TRUE;
+}
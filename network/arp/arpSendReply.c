@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <arp.h>
 #include <ethernet.h>
+#include <mib.h>
 #include <network.h>
 
 /**
@@ -51,5 +52,6 @@ syscall arpSendReply(struct packet *pkt)
     memcpy(dst.addr, &arp->addrs[ARP_ADDR_DHA(arp)], dst.len);
 
     /* Send packet */
+    mib.arp.outReplies++;
     return netSend(pkt, &dst, NULL, ETHER_TYPE_ARP);
 }
@@ -7,7 +7,9 @@
 #include <stddef.h>
 #include <arp.h>
 #include <ethernet.h>
+#include <mib.h>
 #include <network.h>
+#include <stdlib.h>
 
 /**
  * @ingroup arp
@@ -59,12 +61,17 @@ syscall arpSendRqst(struct arpEntry *entry)
     memcpy(&arp->addrs[ARP_ADDR_SHA(arp)], netptr->hwaddr.addr,
            arp->hwalen);
     memcpy(&arp->addrs[ARP_ADDR_SPA(arp)], netptr->ip.addr, arp->pralen);
+    bzero(&arp->addrs[ARP_ADDR_DHA(arp)], arp->hwalen);
     memcpy(&arp->addrs[ARP_ADDR_DPA(arp)], entry->praddr.addr,
            arp->pralen);
     ARP_TRACE("Filled in addrs");
 
     /* Send packet */
     result = netSend(pkt, &netptr->hwbrc, NULL, ETHER_TYPE_ARP);
+    if (OK == result)
+    {
+        mib.arp.outRequests++;
+    }
 
     ARP_TRACE("Sent packet");
 
@@ -0,0 +1,5 @@
+/**
+ * @defgroup bpf Packet filter
+ * @ingroup network
+ * @brief Berkeley Packet Filter interpreter and expression compiler
+ */
@@ -0,0 +1,649 @@
+/**
+ * @file bpfCompile.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <bpf.h>
+#include <ctype.h>
+#include <ethernet.h>
+#include <ipv4.h>
+#include <memory.h>
+#include <network.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BPF_NTOKEN      64      /**< tokens in an expression            */
+#define BPF_NNODE       64      /**< nodes in an expression tree        */
+#define BPF_NLABEL      128     /**< jump targets in generated code     */
+#define BPF_LNEXT       (-1)    /**< label of the next instruction      */
+
+/* Expression tree node types */
+#define BPF_NODE_AND    1
+#define BPF_NODE_OR     2
+#define BPF_NODE_NOT    3
+#define BPF_NODE_ETHER  4       /**< k is a link-level type             */
+#define BPF_NODE_PROTO  5       /**< k is an IPv4 protocol              */
+#define BPF_NODE_HOST   6       /**< k is an address, mask a netmask    */
+#define BPF_NODE_PORT   7       /**< k is a port, proto 0 for TCP/UDP   */
+
+/* Address and port directions */
+#define BPF_DIR_ANY     0
+#define BPF_DIR_SRC     1
+#define BPF_DIR_DST     2
+
+struct bpfNode
+{
+    uchar type;                 /**< BPF_NODE_* type                    */
+    uchar dir;                  /**< BPF_DIR_* direction                */
+    uchar proto;                /**< protocol of a port                 */
+    uint k;                     /**< value to compare against           */
+    uint mask;                  /**< netmask of an address              */
+    short left;                 /**< first operand                      */
+    short right;                /**< second operand                     */
+};
+
+struct bpfState
+{
+    char buf[2 * BPF_MAXEXPR];          /**< token text, NUL terminated */
+    char *tok[BPF_NTOKEN];              /**< tokens                     */
+    uint ntok;                          /**< number of tokens           */
+    uint pos;                           /**< next token to parse        */
+    struct bpfNode node[BPF_NNODE];     /**< expression tree            */
+    uint nnode;                         /**< nodes in use               */
+    uint linklen;                       /**< link-level header length   */
+    struct bpf_insn insn[BPF_MAXINSNS]; /**< generated code             */
+    short jt[BPF_MAXINSNS];             /**< label of true branch       */
+    short jf[BPF_MAXINSNS];             /**< label of false branch      */
+    uint ninsn;                         /**< instructions generated     */
+    short label[BPF_NLABEL];            /**< instruction of each label  */
+    uint nlabel;                        /**< labels in use              */
+    bool err;                           /**< code generation failed     */
+};
+
+static syscall bpfLex(struct bpfState *, const char *);
+static bool bpfAccept(struct bpfState *, const char *);
+static short bpfNew(struct bpfState *, uchar, short, short);
+static short bpfParseOr(struct bpfState *);
+static short bpfParseAnd(struct bpfState *);
+static short bpfParseNot(struct bpfState *);
+static short bpfParsePrim(struct bpfState *);
+static syscall bpfParseNum(const char *, uint, uint *);
+static void bpfGen(struct bpfState *, short, short, short);
+static void bpfGenIpv4(struct bpfState *, short);
+static void bpfEmit(struct bpfState *, ushort, uint, short, short);
+static short bpfLabel(struct bpfState *);
+static syscall bpfPatch(struct bpfState *);
+
+/**
+ * @ingroup bpf
+ *
+ * Compiles a filter expression into a filter program.  The expression
+ * language is a subset of tcpdump's:
+ *  - <tt>arp</tt>, <tt>ip</tt>, <tt>icmp</tt>, <tt>tcp</tt>, <tt>udp</tt>
+ *  - <tt>[src|dst] [host] A.B.C.D</tt>
+ *  - <tt>[src|dst] net A.B.C.D[/LEN]</tt>
+ *  - <tt>[tcp|udp] [src|dst] port N</tt>
+ *  - primitives combined with <tt>and</tt>, <tt>or</tt>, <tt>not</tt>
+ *    (or <tt>&&</tt>, <tt>||</tt>, <tt>!</tt>) and parentheses
+ *
+ * The instructions are allocated with memget() and must be released with
+ * bpfFree().
+ * @param prog program to fill in
+ * @param expr filter expression, an empty expression matches everything
+ * @param linklen length of the link-level header in front of the IPv4
+ *      header, ::ETH_HDR_LEN for Ethernet frames or 0 for bare datagrams
+ * @param snaplen bytes of each matching packet to accept
+ * @return OK if the expression was compiled, otherwise SYSERR
+ */
+syscall bpfCompile(struct bpf_program *prog, const char *expr,
+                   uint linklen, uint snaplen)
+{
+    struct bpfState *s;
+    short root = BPF_LNEXT;
+    short t, f;
+    uint size;
+
+    if ((NULL == prog) || (NULL == expr) || (1 == linklen)
+        || (strnlen(expr, BPF_MAXEXPR) >= BPF_MAXEXPR))
+    {
+        return SYSERR;
+    }
+
+    s = memget(sizeof(struct bpfState));
+    if (SYSERR == (int)s)
+    {
+        return SYSERR;
+    }
+    bzero(s, sizeof(struct bpfState));
+    s->linklen = linklen;
+
+    /* Parse the expression into a tree */
+    if (SYSERR == bpfLex(s, expr))
+    {
+        memfree(s, sizeof(struct bpfState));
+        return SYSERR;
+    }
+    if (s->ntok > 0)
+    {
+        root = bpfParseOr(s);
+        if ((BPF_LNEXT == root) || (s->pos < s->ntok))
+        {
+            memfree(s, sizeof(struct bpfState));
+            return SYSERR;
+        }
+    }
+
+    /* Generate code branching to an accept or a reject */
+    t = bpfLabel(s);
+    f = bpfLabel(s);
+    if (BPF_LNEXT != root)
+    {
+        bpfGen(s, root, t, f);
+    }
+    s->label[t] = s->ninsn;
+    bpfEmit(s, BPF_RET | BPF_K, snaplen, BPF_LNEXT, BPF_LNEXT);
+    s->label[f] = s->ninsn;
+    bpfEmit(s, BPF_RET | BPF_K, 0, BPF_LNEXT, BPF_LNEXT);
+
+    if (s->err || (SYSERR == bpfPatch(s))
+        || !bpfValidate(s->insn, s->ninsn))
+    {
+        memfree(s, sizeof(struct bpfState));
+        return SYSERR;
+    }
+
+    size = s->ninsn * sizeof(struct bpf_insn);
+    prog->bf_insns = memget(size);
+    if (SYSERR == (int)prog->bf_insns)
+    {
+        prog->bf_insns = NULL;
+        prog->bf_len = 0;
+        memfree(s, sizeof(struct bpfState));
+        return SYSERR;
+    }
+    memcpy(prog->bf_insns, s->insn, size);
+    prog->bf_len = s->ninsn;
+
+    memfree(s, sizeof(struct bpfState));
+    return OK;
+}
+
+/**
+ * Splits an expression into words and parentheses.
+ */
+static syscall bpfLex(struct bpfState *s, const char *expr)
+{
+    char *out = s->buf;
+
+    while ('\0' != *expr)
+    {
+        if (isspace(*expr))
+        {
+            expr++;
+            continue;
+        }
+        if (s->ntok >= BPF_NTOKEN)
+        {
+            return SYSERR;
+        }
+        s->tok[s->ntok++] = out;
+        if (('(' == *expr) || (')' == *expr) || ('!' == *expr))
+        {
+            *out++ = *expr++;
+        }
+        else
+        {
+            while (('\0' != *expr) && !isspace(*expr)
+                   && ('(' != *expr) && (')' != *expr))
+            {
+                *out++ = *expr++;
+            }
+        }
+        *out++ = '\0';
+    }
+    return OK;
+}
+
+/**
+ * Consumes the next token if it is the given word.
+ */
+static bool bpfAccept(struct bpfState *s, const char *word)
+{
+    if ((s->pos < s->ntok) && (0 == strcmp(s->tok[s->pos], word)))
+    {
+        s->pos++;
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/**
+ * Allocates an expression tree node.
+ * @return node index, BPF_LNEXT if the tree is full
+ */
+static short bpfNew(struct bpfState *s, uchar type, short left,
+                    short right)
+{
+    struct bpfNode *node;
+
+    if ((BPF_LNEXT == left) || (s->nnode >= BPF_NNODE))
+    {
+        return BPF_LNEXT;
+    }
+    node = &s->node[s->nnode];
+    node->type = type;
+    node->left = left;
+    node->right = right;
+    return s->nnode++;
+}
+
+/* expr := and { (or | ||) and } */
+static short bpfParseOr(struct bpfState *s)
+{
+    short left, right;
+
+    left = bpfParseAnd(s);
+    while ((BPF_LNEXT != left)
+           && (bpfAccept(s, "or") || bpfAccept(s, "||")))
+    {
+        right = bpfParseAnd(s);
+        if (BPF_LNEXT == right)
+        {
+            return BPF_LNEXT;
+        }
+        left = bpfNew(s, BPF_NODE_OR, left, right);
+    }
+    return left;
+}
+
+/* and := not { (and | &&) not } */
+static short bpfParseAnd(struct bpfState *s)
+{
+    short left, right;
+
+    left = bpfParseNot(s);
+    while ((BPF_LNEXT != left)
+           && (bpfAccept(s, "and") || bpfAccept(s, "&&")))
+    {
+        right = bpfParseNot(s);
+        if (BPF_LNEXT == right)
+        {
+            return BPF_LNEXT;
+        }
+        left = bpfNew(s, BPF_NODE_AND, left, right);
+    }
+    return left;
+}
+
+/* not := (not | !) not | ( expr ) | prim */
+static short bpfParseNot(struct bpfState *s)
+{
+    short n;
+
+    if (bpfAccept(s, "not") || bpfAccept(s, "!"))
+    {
+        return bpfNew(s, BPF_NODE_NOT, bpfParseNot(s), BPF_LNEXT);
+    }
+    if (bpfAccept(s, "("))
+    {
+        n = bpfParseOr(s);
+        if (!bpfAccept(s, ")"))
+        {
+            return BPF_LNEXT;
+        }
+        return n;
+    }
+    return bpfParsePrim(s);
+}
+
+/* prim := arp | ip | icmp | [tcp|udp] [src|dst] port N
+ *       | tcp | udp | [src|dst] net A.B.C.D[/LEN]
+ *       | [src|dst] [host] A.B.C.D */
+static short bpfParsePrim(struct bpfState *s)
+{
+    struct netaddr addr;
+    struct bpfNode *node;
+    uchar proto = 0;
+    uchar dir = BPF_DIR_ANY;
+    bool net = FALSE;
+    uint masklen = 32;
+    uint k;
+    char *slash;
+    short n;
+
+    if (bpfAccept(s, "arp"))
+    {
+        if (0 == s->linklen)
+        {
+            return BPF_LNEXT;
+        }
+        n = bpfNew(s, BPF_NODE_ETHER, 0, BPF_LNEXT);
+        k = ETHER_TYPE_ARP;
+    }
+    else if (bpfAccept(s, "ip"))
+    {
+        n = bpfNew(s, BPF_NODE_ETHER, 0, BPF_LNEXT);
+        k = ETHER_TYPE_IPv4;
+    }
+    else if (bpfAccept(s, "icmp"))
+    {
+        n = bpfNew(s, BPF_NODE_PROTO, 0, BPF_LNEXT);
+        k = IPv4_PROTO_ICMP;
+    }
+    else
+    {
+        if (bpfAccept(s, "tcp"))
+        {
+            proto = IPv4_PROTO_TCP;
+        }
+        else if (bpfAccept(s, "udp"))
+        {
+            proto = IPv4_PROTO_UDP;
+        }
+        if (bpfAccept(s, "src"))
+        {
+            dir = BPF_DIR_SRC;
+        }
+        else if (bpfAccept(s, "dst"))
+        {
+            dir = BPF_DIR_DST;
+        }
+
+        if (bpfAccept(s, "port"))
+        {
+            if ((s->pos >= s->ntok)
+                || (SYSERR == bpfParseNum(s->tok[s->pos++], 0xffff, &k)))
+            {
+                return BPF_LNEXT;
+            }
+            n = bpfNew(s, BPF_NODE_PORT, 0, BPF_LNEXT);
+        }
+        else if (0 != proto)
+        {
+            if (BPF_DIR_ANY != dir)
+            {
+                return BPF_LNEXT;
+            }
+            n = bpfNew(s, BPF_NODE_PROTO, 0, BPF_LNEXT);
+            k = proto;
+        }
+        else
+        {
+            if (bpfAccept(s, "net"))
+            {
+                net = TRUE;
+            }
+            else
+            {
+                bpfAccept(s, "host");
+            }
+            if (s->pos >= s->ntok)
+            {
+                return BPF_LNEXT;
+            }
+            slash = strchr(s->tok[s->pos], '/');
+            if (NULL != slash)
+            {
+                *slash = '\0';
+                if (!net
+                    || (SYSERR == bpfParseNum(slash + 1, 32, &masklen)))
+                {
+                    return BPF_LNEXT;
+                }
+            }
+            if (SYSERR == dot2ipv4(s->tok[s->pos++], &addr))
+            {
+                return BPF_LNEXT;
+            }
+            n = bpfNew(s, BPF_NODE_HOST, 0, BPF_LNEXT);
+            k = ((uint)addr.addr[0] << 24) | ((uint)addr.addr[1] << 16)
+                | ((uint)addr.addr[2] << 8) | addr.addr[3];
+        }
+    }
+
+    if (BPF_LNEXT == n)
+    {
+        return BPF_LNEXT;
+    }
+    node = &s->node[n];
+    node->dir = dir;
+    node->proto = proto;
+    node->mask = (0 == masklen) ? 0 : (0xffffffff << (32 - masklen));
+    node->k = (BPF_NODE_HOST == node->type) ? (k & node->mask) : k;
+    return n;
+}
+
+/**
+ * Parses a decimal number no greater than max.
+ */
+static syscall bpfParseNum(const char *str, uint max, uint *num)
+{
+    uint n = 0;
+
+    if ('\0' == *str)
+    {
+        return SYSERR;
+    }
+    for (; '\0' != *str; str++)
+    {
+        if (!isdigit(*str))
+        {
+            return SYSERR;
+        }
+        n = n * 10 + (*str - '0');
+        if (n > max)
+        {
+            return SYSERR;
+        }
+    }
+    *num = n;
+    return OK;
+}
+
+/**
+ * Generates code for an expression tree node that continues at label t if
+ * the node matches and at label f if it does not.
+ */
+static void bpfGen(struct bpfState *s, short n, short t, short f)
+{
+    struct bpfNode *node = &s->node[n];
+    uint link = s->linklen;
+    uint mask = node->mask;
+    short l;
+
+    switch (node->type)
+    {
+    case BPF_NODE_AND:
+        l = bpfLabel(s);
+        bpfGen(s, node->left, l, f);
+        s->label[l] = s->ninsn;
+        bpfGen(s, node->right, t, f);
+        break;
+
+    case BPF_NODE_OR:
+        l = bpfLabel(s);
+        bpfGen(s, node->left, t, l);
+        s->label[l] = s->ninsn;
+        bpfGen(s, node->right, t, f);
+        break;
+
+    case BPF_NODE_NOT:
+        bpfGen(s, node->left, f, t);
+        break;
+
+    case BPF_NODE_ETHER:
+        if (0 == link)
+        {
+            /* Without a link-level header, everything is IPv4 */
+            bpfEmit(s, BPF_JMP | BPF_JA, 0, t, BPF_LNEXT);
+            break;
+        }
+        bpfEmit(s, BPF_LD | BPF_H | BPF_ABS, link - 2, BPF_LNEXT,
+                BPF_LNEXT);
+        bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, node->k, t, f);
+        break;
+
+    case BPF_NODE_PROTO:
+        bpfGenIpv4(s, f);
+        bpfEmit(s, BPF_LD | BPF_B | BPF_ABS, link + 9, BPF_LNEXT,
+                BPF_LNEXT);
+        bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, node->k, t, f);
+        break;
+
+    case BPF_NODE_HOST:
+        bpfGenIpv4(s, f);
+        if (BPF_DIR_DST != node->dir)
+        {
+            bpfEmit(s, BPF_LD | BPF_W | BPF_ABS, link + 12, BPF_LNEXT,
+                    BPF_LNEXT);
+            if (0xffffffff != mask)
+            {
+                bpfEmit(s, BPF_ALU | BPF_AND | BPF_K, mask, BPF_LNEXT,
+                        BPF_LNEXT);
+            }
+            bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, node->k, t,
+                    (BPF_DIR_ANY == node->dir) ? BPF_LNEXT : f);
+        }
+        if (BPF_DIR_SRC != node->dir)
+        {
+            bpfEmit(s, BPF_LD | BPF_W | BPF_ABS, link + 16, BPF_LNEXT,
+                    BPF_LNEXT);
+            if (0xffffffff != mask)
+            {
+                bpfEmit(s, BPF_ALU | BPF_AND | BPF_K, mask, BPF_LNEXT,
+                        BPF_LNEXT);
+            }
+            bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, node->k, t, f);
+        }
+        break;
+
+    case BPF_NODE_PORT:
+        bpfGenIpv4(s, f);
+        bpfEmit(s, BPF_LD | BPF_B | BPF_ABS, link + 9, BPF_LNEXT,
+                BPF_LNEXT);
+        if (0 != node->proto)
+        {
+            bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, node->proto, BPF_LNEXT,
+                    f);
+        }
+        else
+        {
+            l = bpfLabel(s);
+            bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, IPv4_PROTO_TCP, l,
+                    BPF_LNEXT);
+            bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, IPv4_PROTO_UDP, l, f);
+            s->label[l] = s->ninsn;
+        }
+
+        /* Only first fragments carry ports */
+        bpfEmit(s, BPF_LD | BPF_H | BPF_ABS, link + 6, BPF_LNEXT,
+                BPF_LNEXT);
+        bpfEmit(s, BPF_JMP | BPF_JSET | BPF_K, IPv4_FROFF, f,
+                BPF_LNEXT);
+        bpfEmit(s, BPF_LDX | BPF_MSH | BPF_B, link, BPF_LNEXT, BPF_LNEXT);
+        if (BPF_DIR_DST != node->dir)
+        {
+            bpfEmit(s, BPF_LD | BPF_H | BPF_IND, link, BPF_LNEXT,
+                    BPF_LNEXT);
+            bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, node->k, t,
+                    (BPF_DIR_ANY == node->dir) ? BPF_LNEXT : f);
+        }
+        if (BPF_DIR_SRC != node->dir)
+        {
+            bpfEmit(s, BPF_LD | BPF_H | BPF_IND, link + 2, BPF_LNEXT,
+                    BPF_LNEXT);
+            bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, node->k, t, f);
+        }
+        break;
+
+    default:
+        s->err = TRUE;
+        break;
+    }
+}
+
+/**
+ * Generates code that continues at label f unless the packet is IPv4.
+ */
+static void bpfGenIpv4(struct bpfState *s, short f)
+{
+    if (0 == s->linklen)
+    {
+        return;
+    }
+    bpfEmit(s, BPF_LD | BPF_H | BPF_ABS, s->linklen - 2, BPF_LNEXT,
+            BPF_LNEXT);
+    bpfEmit(s, BPF_JMP | BPF_JEQ | BPF_K, ETHER_TYPE_IPv4, BPF_LNEXT, f);
+}
+
+/**
+ * Appends an instruction whose branches go to labels jt and jf.
+ */
+static void bpfEmit(struct bpfState *s, ushort code, uint k, short jt,
+                    short jf)
+{
+    if (s->ninsn >= BPF_MAXINSNS)
+    {
+        s->err = TRUE;
+        return;
+    }
+    s->insn[s->ninsn].code = code;
+    s->insn[s->ninsn].k = k;
+    s->jt[s->ninsn] = jt;
+    s->jf[s->ninsn] = jf;
+    s->ninsn++;
+}
+
+/**
+ * Allocates a label, which is placed by setting its instruction index.
+ */
+static short bpfLabel(struct bpfState *s)
+{
+    if (s->nlabel >= BPF_NLABEL)
+    {
+        s->err = TRUE;
+        return BPF_LNEXT;
+    }
+    s->label[s->nlabel] = -1;
+    return s->nlabel++;
+}
+
+/**
+ * Replaces branch labels with instruction offsets.
+ */
+static syscall bpfPatch(struct bpfState *s)
+{
+    struct bpf_insn *p;
+    int jt, jf;
+    uint i;
+
+    for (i = 0; i < s->ninsn; i++)
+    {
+        p = &s->insn[i];
+        if (BPF_JMP != BPF_CLASS(p->code))
+        {
+            continue;
+        }
+        jt = (BPF_LNEXT == s->jt[i]) ? 0 : s->label[s->jt[i]] - (int)(i + 1);
+        jf = (BPF_LNEXT == s->jf[i]) ? 0 : s->label[s->jf[i]] - (int)(i + 1);
+        if ((jt < 0) || (jf < 0))
+        {
+            return SYSERR;
+        }
+        if (BPF_JA == BPF_OP(p->code))
+        {
+            p->k = jt;
+            continue;
+        }
+        if ((jt > 0xff) || (jf > 0xff))
+        {
+            /* Branch too far for a conditional jump */
+            return SYSERR;
+        }
+        p->jt = jt;
+        p->jf = jf;
+    }
+    return OK;
+}
@@ -0,0 +1,289 @@
+/**
+ * @file bpfFilter.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <bpf.h>
+
+/* Big-endian loads from the packet */
+#define BPF_LDW(p)  (((uint)(p)[0] << 24) | ((uint)(p)[1] << 16) \
+                     | ((uint)(p)[2] << 8) | (uint)(p)[3])
+#define BPF_LDH(p)  (((uint)(p)[0] << 8) | (uint)(p)[1])
+
+/**
+ * @ingroup bpf
+ *
+ * Runs a filter program over a packet.  Loads outside the buffer reject
+ * the packet.  The program must have passed bpfValidate(); jumps and
+ * scratch memory indices are not checked here.
+ * @param pc first instruction of the filter program
+ * @param p packet data
+ * @param wirelen length of the packet on the wire
+ * @param buflen bytes of the packet present at p
+ * @return number of bytes of the packet to accept, 0 to reject it
+ */
+uint bpfFilter(const struct bpf_insn *pc, const uchar *p, uint wirelen,
+               uint buflen)
+{
+    uint A = 0;
+    uint X = 0;
+    uint k;
+    uint mem[BPF_MEMWORDS];
+
+    if (NULL == pc)
+    {
+        /* No filter accepts everything */
+        return (uint)-1;
+    }
+
+    for (pc--;;)
+    {
+        pc++;
+        switch (pc->code)
+        {
+        case BPF_RET | BPF_K:
+            return pc->k;
+
+        case BPF_RET | BPF_A:
+            return A;
+
+        case BPF_LD | BPF_W | BPF_ABS:
+            k = pc->k;
+            if ((k > buflen) || (4 > buflen - k))
+            {
+                return 0;
+            }
+            A = BPF_LDW(p + k);
+            continue;
+
+        case BPF_LD | BPF_H | BPF_ABS:
+            k = pc->k;
+            if ((k > buflen) || (2 > buflen - k))
+            {
+                return 0;
+            }
+            A = BPF_LDH(p + k);
+            continue;
+
+        case BPF_LD | BPF_B | BPF_ABS:
+            k = pc->k;
+            if (k >= buflen)
+            {
+                return 0;
+            }
+            A = p[k];
+            continue;
+
+        case BPF_LD | BPF_W | BPF_LEN:
+            A = wirelen;
+            continue;
+
+        case BPF_LDX | BPF_W | BPF_LEN:
+            X = wirelen;
+            continue;
+
+        case BPF_LD | BPF_W | BPF_IND:
+            k = X + pc->k;
+            if ((k < X) || (k > buflen) || (4 > buflen - k))
+            {
+                return 0;
+            }
+            A = BPF_LDW(p + k);
+            continue;
+
+        case BPF_LD | BPF_H | BPF_IND:
+            k = X + pc->k;
+            if ((k < X) || (k > buflen) || (2 > buflen - k))
+            {
+                return 0;
+            }
+            A = BPF_LDH(p + k);
+            continue;
+
+        case BPF_LD | BPF_B | BPF_IND:
+            k = X + pc->k;
+            if ((k < X) || (k >= buflen))
+            {
+                return 0;
+            }
+            A = p[k];
+            continue;
+
+        case BPF_LDX | BPF_MSH | BPF_B:
+            k = pc->k;
+            if (k >= buflen)
+            {
+                return 0;
+            }
+            X = (p[k] & 0xf) << 2;
+            continue;
+
+        case BPF_LD | BPF_IMM:
+            A = pc->k;
+            continue;
+
+        case BPF_LDX | BPF_IMM:
+            X = pc->k;
+            continue;
+
+        case BPF_LD | BPF_MEM:
+            A = mem[pc->k];
+            continue;
+
+        case BPF_LDX | BPF_MEM:
+            X = mem[pc->k];
+            continue;
+
+        case BPF_ST:
+            mem[pc->k] = A;
+            continue;
+
+        case BPF_STX:
+            mem[pc->k] = X;
+            continue;
+
+        case BPF_JMP | BPF_JA:
+            pc += pc->k;
+            continue;
+
+        case BPF_JMP | BPF_JGT | BPF_K:
+            pc += (A > pc->k) ? pc->jt : pc->jf;
+            continue;
+
+        case BPF_JMP | BPF_JGE | BPF_K:
+            pc += (A >= pc->k) ? pc->jt : pc->jf;
+            continue;
+
+        case BPF_JMP | BPF_JEQ | BPF_K:
+            pc += (A == pc->k) ? pc->jt : pc->jf;
+            continue;
+
+        case BPF_JMP | BPF_JSET | BPF_K:
+            pc += (A & pc->k) ? pc->jt : pc->jf;
+            continue;
+
+        case BPF_JMP | BPF_JGT | BPF_X:
+            pc += (A > X) ? pc->jt : pc->jf;
+            continue;
+
+        case BPF_JMP | BPF_JGE | BPF_X:
+            pc += (A >= X) ? pc->jt : pc->jf;
+            continue;
+
+        case BPF_JMP | BPF_JEQ | BPF_X:
+            pc += (A == X) ? pc->jt : pc->jf;
+            continue;
+
+        case BPF_JMP | BPF_JSET | BPF_X:
+            pc += (A & X) ? pc->jt : pc->jf;
+            continue;
+
+        case BPF_ALU | BPF_ADD | BPF_X:
+            A += X;
+            continue;
+
+        case BPF_ALU | BPF_SUB | BPF_X:
+            A -= X;
+            continue;
+
+        case BPF_ALU | BPF_MUL | BPF_X:
+            A *= X;
+            continue;
+
+        case BPF_ALU | BPF_DIV | BPF_X:
+            if (0 == X)
+            {
+                return 0;
+            }
+            A /= X;
+            continue;
+
+        case BPF_ALU | BPF_MOD | BPF_X:
+            if (0 == X)
+            {
+                return 0;
+            }
+            A %= X;
+            continue;
+
+        case BPF_ALU | BPF_AND | BPF_X:
+            A &= X;
+            continue;
+
+        case BPF_ALU | BPF_OR | BPF_X:
+            A |= X;
+            continue;
+
+        case BPF_ALU | BPF_XOR | BPF_X:
+            A ^= X;
+            continue;
+
+        /* Shifting a 32-bit word by 32 or more is undefined in C */
+        case BPF_ALU | BPF_LSH | BPF_X:
+            A <<= (X & 31);
+            continue;
+
+        case BPF_ALU | BPF_RSH | BPF_X:
+            A >>= (X & 31);
+            continue;
+
+        case BPF_ALU | BPF_ADD | BPF_K:
+            A += pc->k;
+            continue;
+
+        case BPF_ALU | BPF_SUB | BPF_K:
+            A -= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_MUL | BPF_K:
+            A *= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_DIV | BPF_K:
+            A /= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_MOD | BPF_K:
+            A %= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_AND | BPF_K:
+            A &= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_OR | BPF_K:
+            A |= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_XOR | BPF_K:
+            A ^= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_LSH | BPF_K:
+            A <<= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_RSH | BPF_K:
+            A >>= pc->k;
+            continue;
+
+        case BPF_ALU | BPF_NEG:
+            A = -A;
+            continue;
+
+        case BPF_MISC | BPF_TAX:
+            X = A;
+            continue;
+
+        case BPF_MISC | BPF_TXA:
+            A = X;
+            continue;
+
+        default:
+            /* Invalid instruction; bpfValidate() rejects these */
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,27 @@
+/**
+ * @file bpfFree.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <bpf.h>
+#include <memory.h>
+
+/**
+ * @ingroup bpf
+ *
+ * Releases the instructions of a filter program allocated by bpfCompile()
+ * and leaves the program empty.
+ * @param prog program to release
+ */
+void bpfFree(struct bpf_program *prog)
+{
+    if ((NULL == prog) || (NULL == prog->bf_insns))
+    {
+        return;
+    }
+    memfree(prog->bf_insns, prog->bf_len * sizeof(struct bpf_insn));
+    prog->bf_insns = NULL;
+    prog->bf_len = 0;
+}
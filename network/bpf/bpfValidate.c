@@ -0,0 +1,146 @@
+/**
+ * @file bpfValidate.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <bpf.h>
+
+/**
+ * @ingroup bpf
+ *
+ * Checks that a filter program is safe to run with bpfFilter().  Every
+ * instruction must be known, every jump must go forward and stay inside
+ * the program, scratch memory indices must be in range, no instruction may
+ * divide by a constant zero or shift by a constant of 32 or more, and the
+ * program must end in a return.  Since jumps only go forward, every valid
+ * program terminates.
+ * @param insns first instruction of the filter program
+ * @param len number of instructions
+ * @return TRUE if the program is valid, otherwise FALSE
+ */
+bool bpfValidate(const struct bpf_insn *insns, uint len)
+{
+    const struct bpf_insn *p;
+    uint remain;
+    uint i;
+
+    if ((NULL == insns) || (0 == len) || (len > BPF_MAXINSNS))
+    {
+        return FALSE;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        p = &insns[i];
+        remain = len - i - 1;
+        switch (BPF_CLASS(p->code))
+        {
+        case BPF_LD:
+        case BPF_LDX:
+            switch (BPF_MODE(p->code))
+            {
+            case BPF_IMM:
+            case BPF_LEN:
+                break;
+            case BPF_ABS:
+            case BPF_IND:
+            case BPF_MSH:
+                if ((BPF_LDX == BPF_CLASS(p->code))
+                    != (BPF_MSH == BPF_MODE(p->code)))
+                {
+                    return FALSE;
+                }
+                break;
+            case BPF_MEM:
+                if (p->k >= BPF_MEMWORDS)
+                {
+                    return FALSE;
+                }
+                break;
+            default:
+                return FALSE;
+            }
+            break;
+
+        case BPF_ST:
+        case BPF_STX:
+            if (p->k >= BPF_MEMWORDS)
+            {
+                return FALSE;
+            }
+            break;
+
+        case BPF_ALU:
+            switch (BPF_OP(p->code))
+            {
+            case BPF_ADD:
+            case BPF_SUB:
+            case BPF_MUL:
+            case BPF_OR:
+            case BPF_AND:
+            case BPF_XOR:
+            case BPF_NEG:
+                break;
+            case BPF_LSH:
+            case BPF_RSH:
+                if ((BPF_K == BPF_SRC(p->code)) && (p->k >= 32))
+                {
+                    return FALSE;
+                }
+                break;
+            case BPF_DIV:
+            case BPF_MOD:
+                if ((BPF_K == BPF_SRC(p->code)) && (0 == p->k))
+                {
+                    return FALSE;
+                }
+                break;
+            default:
+                return FALSE;
+            }
+            break;
+
+        case BPF_JMP:
+            switch (BPF_OP(p->code))
+            {
+            case BPF_JA:
+                if (p->k >= remain)
+                {
+                    return FALSE;
+                }
+                break;
+            case BPF_JEQ:
+            case BPF_JGT:
+            case BPF_JGE:
+            case BPF_JSET:
+                if ((p->jt >= remain) || (p->jf >= remain))
+                {
+                    return FALSE;
+                }
+                break;
+            default:
+                return FALSE;
+            }
+            break;
+
+        case BPF_RET:
+            if ((BPF_K != BPF_RVAL(p->code)) && (BPF_A != BPF_RVAL(p->code)))
+            {
+                return FALSE;
+            }
+            break;
+
+        case BPF_MISC:
+            if ((BPF_TAX != BPF_MISCOP(p->code))
+                && (BPF_TXA != BPF_MISCOP(p->code)))
+            {
+                return FALSE;
+            }
+            break;
+        }
+    }
+
+    return (BPF_RET == BPF_CLASS(insns[len - 1].code));
+}
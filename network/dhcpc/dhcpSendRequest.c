@@ -10,6 +10,7 @@
 #include <ethernet.h>
 #include <ipv4.h>
 #include <network.h>
+#include <stdlib.h>
 #include <string.h>
 #include <udp.h>
 
@@ -107,7 +108,10 @@ syscall dhcpSendRequest(int descrp, struct dhcpData *data)
     udp = (struct udpPkt *)ipv4->opts;
     dhcp = (struct dhcpPkt *)udp->data;
 
-    /* Construct the DHCP packet */
+    /* Construct the DHCP packet.  The packet buffer is not zeroed, so clear
+     * the fixed-size header first to zero the unused chaddr, sname and file
+     * fields.  */
+    bzero(dhcp, DHCP_HDR_LEN);
     dhcp->op = DHCP_OP_REQUEST;
     dhcp->htype = DHCP_HTYPE_ETHER;
     dhcp->hlen = ETH_ADDR_LEN;
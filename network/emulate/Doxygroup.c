@@ -1,5 +1,5 @@
 /**
  * @defgroup netemu Network Emulation
  * @ingroup network
- * @brief Automatically drop and corrupt packets for testing
+ * @brief Emulate loss, delay, rate limits and corruption on received packets
  */
@@ -4,19 +4,31 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <stddef.h>
 #include <network.h>
+#include <stdlib.h>
 #include <netemu.h>
-#include <route.h>
 
 /**
  * @ingroup netemu
  *
- * Corrupts packets as specified by user
+ * Corrupts packets with the interface's corrupt chance by flipping one
+ * random bit after the link-level header, where checksums catch it.
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
 syscall emuCorrupt(struct packet *pkt)
 {
+    struct netemu *emu = &emutab[pkt->nif - netiftab];
+    uint linklen = pkt->nif->linkhdrlen;
+    uint off;
 
-    return rtRecv(pkt);
+    if ((pkt->len > linklen) && emuChance(emu->corrupt))
+    {
+        off = linklen + rand() % (pkt->len - linklen);
+        pkt->linkhdr[off] ^= 1 << (rand() % 8);
+        emu->ncorrupt++;
+    }
+
+    return emuReorder(pkt);
 }
@@ -0,0 +1,57 @@
+/*
+ * @file emuDaemon.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <ipv4.h>
+#include <network.h>
+#include <netemu.h>
+#include <thread.h>
+
+/**
+ * @ingroup netemu
+ *
+ * Delivers packets from the delay queue to ipv4Recv() when they are due.
+ * The thread sleeps until the first packet is due, and emuEnqueue() wakes
+ * it early with a message when a packet is queued ahead of it.
+ * @return This thread never returns.
+ */
+thread emuDaemon(void)
+{
+    struct emuEntry *entry;
+    struct packet *pkt;
+    long wait;
+    irqmask im;
+
+    while (TRUE)
+    {
+        im = disable();
+        entry = emuqueue;
+        if (NULL == entry)
+        {
+            restore(im);
+            receive();
+            continue;
+        }
+        wait = (long)(entry->due - emuNow());
+        if (wait > 0)
+        {
+            restore(im);
+            recvtime(wait);
+            continue;
+        }
+        emuqueue = entry->next;
+        pkt = entry->pkt;
+        entry->next = emufree;
+        emufree = entry;
+        restore(im);
+
+        emutab[pkt->nif - netiftab].nout++;
+        ipv4Recv(pkt);
+    }
+
+    return SYSERR;
+}
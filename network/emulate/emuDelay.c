@@ -4,28 +4,113 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <stddef.h>
+#include <interrupt.h>
 #include <network.h>
 #include <stdlib.h>
-#include <thread.h>
 #include <netemu.h>
 
+static ulong emuRate(struct netemu *, uint, ulong);
+static int emuJitter(struct netemu *);
+
 /**
  * @ingroup netemu
  *
- * Delay packets as specified by user
+ * Delay packets by the interface's rate limit, base delay and jitter, then
+ * queue them for emuDaemon() to deliver.  Jitter can reorder packets, as
+ * on a real path.
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
 syscall emuDelay(struct packet *pkt)
 {
-    /*
-       short delayTime = 100;
-       short delayPercent = 100;
-
-       if ((rand() % 100) < delayPercent)
-       {
-       sleep(delayTime);
-       }
-     */
-    return emuDuplicate(pkt);
+    struct netemu *emu = &emutab[pkt->nif - netiftab];
+    ulong now;
+    ulong due;
+    int delay;
+    irqmask im;
+
+    im = disable();
+    now = emuNow();
+    due = now;
+    if (0 != emu->rate)
+    {
+        due += emuRate(emu, pkt->len, now);
+    }
+    restore(im);
+
+    delay = (int)emu->delay + emuJitter(emu);
+    if (delay > 0)
+    {
+        due += delay;
+    }
+
+    return emuEnqueue(pkt, due);
+}
+
+/**
+ * Token bucket holding up to burst bytes, filled at rate.  A packet larger
+ * than the tokens on hand puts the bucket in debt and waits until the
+ * debt is paid, so back-to-back packets leave at the configured rate.
+ * Must be called with interrupts disabled.
+ * @return ms the packet must wait for the link
+ */
+static ulong emuRate(struct netemu *emu, uint len, ulong now)
+{
+    ulong elapsed = now - emu->tlast;
+
+    emu->tlast = now;
+
+    /* Fill a second at a time so a long idle period cannot overflow */
+    while ((elapsed >= 1000) && (emu->tokens < (int)emu->burst))
+    {
+        emu->tokens += emu->rate * (1000 / 8);
+        elapsed -= 1000;
+    }
+    if (elapsed < 1000)
+    {
+        emu->tokens += elapsed * emu->rate / 8;
+    }
+    if (emu->tokens > (int)emu->burst)
+    {
+        emu->tokens = emu->burst;
+    }
+
+    emu->tokens -= len;
+    if (emu->tokens >= 0)
+    {
+        return 0;
+    }
+    return ((ulong)(-emu->tokens) * 8 + emu->rate - 1) / emu->rate;
+}
+
+/**
+ * Draws a jitter sample in ms from the interface's distribution.
+ */
+static int emuJitter(struct netemu *emu)
+{
+    int jitter = emu->jitter;
+    int sum;
+    int i;
+
+    if (0 == jitter)
+    {
+        return 0;
+    }
+
+    switch (emu->dist)
+    {
+    case NETEMU_DIST_NORMAL:
+        /* Sum of 12 uniforms on [0,1000) has mean 5994 and sd 1000 */
+        sum = 0;
+        for (i = 0; i < 12; i++)
+        {
+            sum += rand() % 1000;
+        }
+        return (sum - 5994) * jitter / 1000;
+
+    case NETEMU_DIST_UNIFORM:
+    default:
+        return (rand() % (2 * jitter + 1)) - jitter;
+    }
 }
@@ -4,33 +4,30 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <network.h>
 #include <netemu.h>
-#include <route.h>
-#include <date.h>
-#include <stdio.h>
-#include <udp.h>
 
 /**
  * @ingroup netemu
  *
- * Drop packets based on user settings
+ * Drop packets with the interface's loss chance.
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
 syscall emuDrop(struct packet *pkt)
 {
-    /* TODO: make this user specifiable */
-    short dropPercent = 0;
+    struct netemu *emu = &emutab[pkt->nif - netiftab];
 
-    /* drop packet when random value < percent to drop */
-    if ((rand() % 100) < dropPercent)
+    /* drop packet when random value < chance to drop */
+    if (emuChance(emu->loss))
     {
-        RT_TRACE("Dropped by Emulator: %d\n");
+        NETEMU_TRACE("Dropped by emulator");
+        emu->nloss++;
         netFreebuf(pkt);
         return OK;
     }
 
-    return emuDelay(pkt);
+    return emuDuplicate(pkt);
 }
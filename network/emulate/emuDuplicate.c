@@ -4,39 +4,45 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <stddef.h>
 #include <network.h>
 #include <stdlib.h>
+#include <string.h>
 #include <netemu.h>
 
-//int test(struct packet *pkt, int dupes);
 /**
  * @ingroup netemu
  *
- * Duplicate packets as specified by user
+ * Duplicate packets with the interface's duplicate chance.  The copy
+ * passes the remaining stages on its own.  No copy is made if no packet
+ * buffer is free.
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
 syscall emuDuplicate(struct packet *pkt)
 {
-    /*
-       short dupePercent = 100;
-       int dupes = 2;
+    struct netemu *emu = &emutab[pkt->nif - netiftab];
+    struct packet *copy;
+    uint off;
 
-       if ((rand() % 100) < dupePercent)
-       {
-       return test(pkt, dupes);
-       }
-     */
-    return emuReorder(pkt);
-}
-
-/*
-syscall test(struct packet *pkt, int dupes)
-{
-    if (dupes == 1)
+    if (emuChance(emu->duplicate))
     {
-        return emuReorder(pkt);
+        copy = netGetbufNowait();
+        if (SYSERR != (int)copy)
+        {
+            /* Received packets are held entirely in the buffer */
+            off = pkt->linkhdr - pkt->data;
+            memcpy(copy->data, pkt->data, off + pkt->len);
+            copy->nif = pkt->nif;
+            copy->len = pkt->len;
+            copy->linkhdr = copy->data + off;
+            copy->nethdr = copy->data + (pkt->nethdr - pkt->data);
+            copy->curr = copy->data + (pkt->curr - pkt->data);
+            copy->nseg = 0;
+            emu->ndup++;
+            emuCorrupt(copy);
+        }
     }
 
-    return (emuReorder(pkt) | test(pkt, dupes - 1));
-}*/
+    return emuCorrupt(pkt);
+}
@@ -0,0 +1,58 @@
+/*
+ * @file emuEnqueue.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <network.h>
+#include <netemu.h>
+
+/**
+ * @ingroup netemu
+ *
+ * Inserts a packet into the delay queue, after any packets due at the
+ * same time, and wakes emuDaemon() if it is now first.  The packet is
+ * dropped if the queue is full.
+ * @param pkt pointer to the incoming packet
+ * @param due time to deliver the packet, in ms
+ * @return OK if the packet was queued, otherwise SYSERR
+ */
+syscall emuEnqueue(struct packet *pkt, ulong due)
+{
+    struct emuEntry **link;
+    struct emuEntry *entry;
+    bool first;
+    irqmask im;
+
+    im = disable();
+    entry = emufree;
+    if (NULL == entry)
+    {
+        emutab[pkt->nif - netiftab].nqdrop++;
+        restore(im);
+        NETEMU_TRACE("Delay queue full");
+        netFreebuf(pkt);
+        return SYSERR;
+    }
+    emufree = entry->next;
+    entry->pkt = pkt;
+    entry->due = due;
+
+    link = &emuqueue;
+    while ((NULL != *link) && ((long)((*link)->due - due) <= 0))
+    {
+        link = &(*link)->next;
+    }
+    entry->next = *link;
+    *link = entry;
+    first = (emuqueue == entry);
+    restore(im);
+
+    if (first)
+    {
+        send(emuthr, 0);
+    }
+    return OK;
+}
@@ -4,18 +4,35 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <stddef.h>
+#include <interrupt.h>
 #include <network.h>
+#include <stdlib.h>
 #include <netemu.h>
 
 /**
  * @ingroup netemu
  *
- * Reorder packets as specified by the user
+ * Reorder packets with the interface's reorder chance.  A reordered packet
+ * skips the rate and delay stages, so it departs ahead of the packets
+ * already waiting in the delay queue.
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
 syscall emuReorder(struct packet *pkt)
 {
+    struct netemu *emu = &emutab[pkt->nif - netiftab];
+    ulong now;
+    irqmask im;
 
-    return emuCorrupt(pkt);
+    if (emuChance(emu->reorder))
+    {
+        emu->nreorder++;
+        im = disable();
+        now = emuNow();
+        restore(im);
+        return emuEnqueue(pkt, now);
+    }
+
+    return emuDelay(pkt);
 }
@@ -0,0 +1,52 @@
+/*
+ * @file emuStart.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <network.h>
+#include <netemu.h>
+#include <thread.h>
+
+/**
+ * @ingroup netemu
+ *
+ * Starts the network emulator thread, if it is not running yet.
+ * @return OK if the thread is running, otherwise SYSERR
+ */
+syscall emuStart(void)
+{
+    static struct emuEntry entries[NETEMU_QLEN];
+    tid_typ tid;
+    int i;
+    irqmask im;
+
+    im = disable();
+    if (!isbadtid(emuthr))
+    {
+        restore(im);
+        return OK;
+    }
+
+    emuqueue = NULL;
+    emufree = NULL;
+    for (i = 0; i < NETEMU_QLEN; i++)
+    {
+        entries[i].next = emufree;
+        emufree = &entries[i];
+    }
+
+    tid = create((void *)emuDaemon, NETEMU_THR_STK, NETEMU_THR_PRIO,
+                 "netemu", 0);
+    if (SYSERR == tid)
+    {
+        restore(im);
+        return SYSERR;
+    }
+    emuthr = tid;
+    ready(tid, RESCHED_NO);
+    restore(im);
+    return OK;
+}
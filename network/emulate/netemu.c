@@ -4,18 +4,40 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <stddef.h>
+#include <ipv4.h>
 #include <network.h>
 #include <netemu.h>
 
+#if NNETIF
+struct netemu emutab[NNETIF];
+#endif
+struct emuEntry *emuqueue = NULL;   /**< delay queue, by departure time */
+struct emuEntry *emufree = NULL;    /**< unused delay queue entries     */
+tid_typ emuthr = BADTID;            /**< emuDaemon() thread             */
+
 /**
  * @ingroup netemu
  *
- * Process a packet through the network emulator
+ * Process a received IPv4 packet through the network emulator.  Packets
+ * on interfaces without emulation go straight to ipv4Recv().
  * @param pkt pointer to the incoming packet
  * @return OK if packet was processed succesfully, otherwise SYSERR
  */
 syscall netemu(struct packet *pkt)
 {
+#if NNETIF
+    struct netemu *emu;
+
+    emu = &emutab[pkt->nif - netiftab];
+    if (!emu->enabled || isbadtid(emuthr))
+    {
+        return ipv4Recv(pkt);
+    }
+    emu->nin++;
 
     return emuDrop(pkt);
+#else
+    return ipv4Recv(pkt);
+#endif
 }
@@ -8,6 +8,7 @@
 #include <interrupt.h>
 #include <ipv4.h>
 #include <mailbox.h>
+#include <mib.h>
 #include <thread.h>
 #include <network.h>
 
@@ -31,11 +32,13 @@ syscall icmpRecv(struct packet *pkt)
     }
 
     icmp = (struct icmpPkt *)pkt->curr;
+    mib.icmp.inMsgs++;
 
     switch (icmp->type)
     {
     case ICMP_ECHOREPLY:
         ICMP_TRACE("Received Echo Reply");
+        mib.icmp.inEchoReps++;
         echo = (struct icmpEcho *)icmp->data;
         id = net2hs(echo->id);
         if ((id >= 0) && (id < NTHREAD))
@@ -60,6 +63,7 @@ syscall icmpRecv(struct packet *pkt)
                     if (((eq->head + 1) % NPINGHOLD) == eq->tail)
                     {
                         ICMP_TRACE("Queue full, discarding");
+                        mib.icmp.inErrors++;
                         restore(im);
                         netFreebuf(pkt);
                         return SYSERR;
@@ -74,18 +78,28 @@ syscall icmpRecv(struct packet *pkt)
             restore(im);
         }
         ICMP_TRACE("Reply id %d does not correspond to ping queue", id);
+        mib.icmp.inErrors++;
         netFreebuf(pkt);
         return SYSERR;
 
     case ICMP_ECHO:
         ICMP_TRACE("Enqueued Echo Request for daemon to reply");
+        mib.icmp.inEchos++;
         mailboxSend(icmpqueue, (int)pkt);
         return OK;
 
     case ICMP_UNREACH:
+        mib.icmp.inDestUnreachs++;
+        ICMP_TRACE("ICMP message type %d not handled", icmp->type);
+        break;
+
+    case ICMP_TIMEEXCD:
+        mib.icmp.inTimeExcds++;
+        ICMP_TRACE("ICMP message type %d not handled", icmp->type);
+        break;
+
     case ICMP_SRCQNCH:
     case ICMP_REDIRECT:
-    case ICMP_TIMEEXCD:
     case ICMP_PARAMPROB:
     case ICMP_TMSTMP:
     case ICMP_TMSTMPREPLY:
@@ -97,6 +111,7 @@ syscall icmpRecv(struct packet *pkt)
 
     default:
         ICMP_TRACE("ICMP message type %d unknown", icmp->type);
+        mib.icmp.inErrors++;
         break;
     }
 
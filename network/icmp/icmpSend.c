@@ -5,6 +5,7 @@
 
 #include <ipv4.h>
 #include <icmp.h>
+#include <mib.h>
 #include <network.h>
 
 /**
@@ -38,6 +39,7 @@ syscall icmpSend(struct packet *pkt, uchar type, uchar code,
                  uint datalen, struct netaddr *src, struct netaddr *dst)
 {
     struct icmpPkt *icmp;
+    int result;
 
     /* Error check pointers */
     if (NULL == pkt)
@@ -55,5 +57,31 @@ syscall icmpSend(struct packet *pkt, uchar type, uchar code,
     icmp->chksum = netChksum((uchar *)icmp, datalen + ICMP_HEADER_LEN);
 
     ICMP_TRACE("Sending ICMP packet type %d, code %d", type, code);
-    return ipv4Send(pkt, src, dst, IPv4_PROTO_ICMP);
+    result = ipv4Send(pkt, src, dst, IPv4_PROTO_ICMP);
+    if (OK != result)
+    {
+        mib.icmp.outErrors++;
+        return result;
+    }
+
+    mib.icmp.outMsgs++;
+    switch (type)
+    {
+    case ICMP_ECHO:
+        mib.icmp.outEchos++;
+        break;
+    case ICMP_ECHOREPLY:
+        mib.icmp.outEchoReps++;
+        break;
+    case ICMP_UNREACH:
+        mib.icmp.outDestUnreachs++;
+        break;
+    case ICMP_TIMEEXCD:
+        mib.icmp.outTimeExcds++;
+        break;
+    case ICMP_REDIRECT:
+        mib.icmp.outRedirects++;
+        break;
+    }
+    return result;
 }
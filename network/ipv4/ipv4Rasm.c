@@ -0,0 +1,182 @@
+/**
+ * @file ipv4Rasm.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <ipv4.h>
+#include <mib.h>
+#include <network.h>
+#include <string.h>
+
+static bool ipv4RasmAddHole(struct ipv4RasmEntry *, uint, uint);
+
+/**
+ * @ingroup ipv4
+ *
+ * Adds a fragment to the datagram it belongs to, using the hole descriptor
+ * algorithm of RFC 815.  The fragment is always consumed.
+ * @param pkt   fragment, with pkt->nethdr pointing to its IPv4 header
+ * @return the reassembled datagram once all fragments have arrived, set up
+ *         as if it had been received whole; otherwise NULL
+ */
+struct packet *ipv4Rasm(struct packet *pkt)
+{
+    struct ipv4Pkt *ip;
+    struct ipv4RasmEntry *rasm;
+    struct packet *whole = NULL;
+    uchar iphdr[IPv4_MAX_HDRLEN];
+    uint ihl, first, last, len;
+    uint hfirst, hlast;
+    uint linkhdrlen, hdrlen, datalen;
+    bool more;
+    irqmask im;
+    int i;
+
+    ip = (struct ipv4Pkt *)pkt->nethdr;
+    ihl = (ip->ver_ihl & IPv4_IHL) << 2;
+    first = (net2hs(ip->flags_froff) & IPv4_FROFF) << 3;
+    len = net2hs(ip->len) - ihl;
+    last = first + len - 1;
+    more = (0 != (net2hs(ip->flags_froff) & IPv4_FLAG_MF));
+
+    /* Every fragment but the last carries a multiple of 8 bytes */
+    if ((0 == len) || (more && (len & 0x7)))
+    {
+        IPv4_TRACE("Bad fragment length %d", len);
+        netFreebuf(pkt);
+        mib.ipv4.reasmFails++;
+        return NULL;
+    }
+
+    im = disable();
+    rasm = ipv4RasmGet(ip, pkt->nif);
+    if (NULL == rasm)
+    {
+        restore(im);
+        netFreebuf(pkt);
+        mib.ipv4.reasmFails++;
+        return NULL;
+    }
+
+    if ((rasm->hdrlen + last + 1 > IPv4_RASM_MAXLEN)
+        || ((0 != rasm->datalen) && (last >= rasm->datalen)))
+    {
+        IPv4_TRACE("Fragment beyond end of datagram");
+        ipv4RasmFree(rasm);
+        restore(im);
+        netFreebuf(pkt);
+        mib.ipv4.reasmFails++;
+        return NULL;
+    }
+
+    /* Remove every hole the fragment overlaps, leaving the parts of it
+     * that are still missing.  A hole moved into slot i is examined next. */
+    i = 0;
+    while (i < rasm->nhole)
+    {
+        hfirst = rasm->hole[i].first;
+        hlast = rasm->hole[i].last;
+        if ((first > hlast) || ((last < hfirst) && more))
+        {
+            i++;
+            continue;
+        }
+
+        rasm->nhole--;
+        rasm->hole[i] = rasm->hole[rasm->nhole];
+        if (((first > hfirst)
+             && !ipv4RasmAddHole(rasm, hfirst, first - 1))
+            || ((last < hlast) && more
+                && !ipv4RasmAddHole(rasm, last + 1, hlast)))
+        {
+            IPv4_TRACE("Too many holes");
+            ipv4RasmFree(rasm);
+            restore(im);
+            netFreebuf(pkt);
+            mib.ipv4.reasmFails++;
+            return NULL;
+        }
+    }
+    if (!more)
+    {
+        rasm->datalen = last + 1;
+    }
+
+    memcpy(rasm->pkt->data + rasm->hdrlen + first, (uchar *)ip + ihl, len);
+
+    /* The first fragment supplies the link and IP headers */
+    if ((0 == first) && !rasm->first)
+    {
+        memcpy(rasm->pkt->data, pkt->linkhdr, pkt->nif->linkhdrlen);
+        memcpy(rasm->iphdr, ip, ihl);
+        rasm->ihl = ihl;
+        rasm->first = TRUE;
+    }
+
+    if (0 == rasm->nhole)
+    {
+        whole = rasm->pkt;
+        rasm->pkt = NULL;
+        ihl = rasm->ihl;
+        memcpy(iphdr, rasm->iphdr, ihl);
+        hdrlen = rasm->hdrlen;
+        datalen = rasm->datalen;
+        ipv4RasmFree(rasm);
+    }
+    restore(im);
+    netFreebuf(pkt);
+
+    if (NULL == whole)
+    {
+        return NULL;
+    }
+
+    /* Put the first fragment's header in front of the payload */
+    linkhdrlen = hdrlen - IPv4_HDR_LEN;
+    if (linkhdrlen + ihl + datalen > IPv4_RASM_MAXLEN)
+    {
+        netFreebuf(whole);
+        mib.ipv4.reasmFails++;
+        return NULL;
+    }
+    if (IPv4_HDR_LEN != ihl)
+    {
+        memmove(whole->data + linkhdrlen + ihl, whole->data + hdrlen,
+                datalen);
+    }
+    memcpy(whole->data + linkhdrlen, iphdr, ihl);
+
+    ip = (struct ipv4Pkt *)(whole->data + linkhdrlen);
+    ip->len = hs2net(ihl + datalen);
+    ip->flags_froff = hs2net(net2hs(ip->flags_froff) & IPv4_FLAG_DF);
+    ip->chksum = 0;
+    ip->chksum = netChksum((uchar *)ip, ihl);
+
+    whole->linkhdr = whole->data;
+    whole->nethdr = whole->data + linkhdrlen;
+    whole->curr = whole->nethdr;
+    whole->len = linkhdrlen + ihl + datalen;
+
+    IPv4_TRACE("Reassembled %d byte datagram", ihl + datalen);
+    return whole;
+}
+
+/**
+ * Appends a hole to a reassembly entry.
+ * @return FALSE if the entry has no room for another hole
+ */
+static bool ipv4RasmAddHole(struct ipv4RasmEntry *rasm, uint first,
+                            uint last)
+{
+    if (rasm->nhole >= IPv4_RASM_NHOLE)
+    {
+        return FALSE;
+    }
+    rasm->hole[rasm->nhole].first = first;
+    rasm->hole[rasm->nhole].last = last;
+    rasm->nhole++;
+    return TRUE;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file ipv4RasmDaemon.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <clock.h>
+#include <icmp.h>
+#include <interrupt.h>
+#include <ipv4.h>
+#include <mib.h>
+#include <network.h>
+#include <string.h>
+#include <thread.h>
+
+/**
+ * @ingroup ipv4
+ *
+ * Reassembly daemon; once a second it discards datagrams whose fragments
+ * have not all arrived within ::IPv4_RASM_TTL seconds.  If the first
+ * fragment was received, the sender is told with an ICMP Time Exceeded
+ * message (RFC 792).
+ */
+thread ipv4RasmDaemon(void)
+{
+    struct ipv4RasmEntry *rasm;
+    struct packet *pkt;
+    uint linkhdrlen;
+    bool first;
+    irqmask im;
+    int i;
+
+    while (TRUE)
+    {
+        sleep(1000);
+
+        im = disable();
+        for (i = 0; i < IPv4_RASM_NENTRY; i++)
+        {
+            rasm = &ipv4rasmtab[i];
+            if ((IPv4_RASM_USED != rasm->state)
+                || ((int)(clktime - rasm->expires) < 0))
+            {
+                continue;
+            }
+
+            IPv4_TRACE("Reassembly entry %d expired", i);
+            mib.ipv4.reasmTimeouts++;
+            mib.ipv4.reasmFails++;
+            pkt = rasm->pkt;
+            rasm->pkt = NULL;
+            first = rasm->first;
+
+            /* Rebuild the original header and leading data for ICMP */
+            if (first)
+            {
+                linkhdrlen = rasm->hdrlen - IPv4_HDR_LEN;
+                pkt->nethdr = pkt->data + linkhdrlen;
+                if (IPv4_HDR_LEN != rasm->ihl)
+                {
+                    memmove(pkt->nethdr + rasm->ihl,
+                            pkt->data + rasm->hdrlen, ICMP_DEF_DATALEN);
+                }
+                memcpy(pkt->nethdr, rasm->iphdr, rasm->ihl);
+            }
+            ipv4RasmFree(rasm);
+            restore(im);
+
+            if (first)
+            {
+                icmpTimeExceeded(pkt, ICMP_FRA_EXC);
+            }
+            netFreebuf(pkt);
+
+            im = disable();
+        }
+        restore(im);
+    }
+
+    return SYSERR;
+}
@@ -0,0 +1,40 @@
+/**
+ * @file ipv4RasmFree.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <ipv4.h>
+#include <network.h>
+
+/**
+ * @ingroup ipv4
+ *
+ * Discards a reassembly entry and the partial datagram it holds, if any.
+ * Must be called with interrupts disabled.
+ * @param rasm  reassembly entry to free
+ */
+void ipv4RasmFree(struct ipv4RasmEntry *rasm)
+{
+    struct ipv4RasmEntry **prev;
+
+    /* Unlink from hash bucket */
+    for (prev = &ipv4rasmhash[ipv4RasmHash(rasm)]; NULL != *prev;
+         prev = &(*prev)->next)
+    {
+        if (*prev == rasm)
+        {
+            *prev = rasm->next;
+            break;
+        }
+    }
+
+    if (NULL != rasm->pkt)
+    {
+        netFreebuf(rasm->pkt);
+    }
+    rasm->pkt = NULL;
+    rasm->next = NULL;
+    rasm->state = IPv4_RASM_FREE;
+}
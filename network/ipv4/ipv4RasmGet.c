@@ -0,0 +1,113 @@
+/**
+ * @file ipv4RasmGet.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <bufpool.h>
+#include <clock.h>
+#include <ipv4.h>
+#include <network.h>
+#include <semaphore.h>
+#include <string.h>
+
+/**
+ * @ingroup ipv4
+ *
+ * Finds the reassembly entry for the datagram a fragment belongs to,
+ * allocating a new entry if this is the first fragment seen.  When the
+ * table or the reassembly buffers are exhausted the oldest incomplete
+ * datagram is discarded to make room.  Must be called with interrupts
+ * disabled.
+ * @param ip    IPv4 header of the fragment
+ * @param nif   interface the fragment arrived on
+ * @return reassembly entry, NULL if none could be allocated
+ */
+struct ipv4RasmEntry *ipv4RasmGet(const struct ipv4Pkt *ip,
+                                  struct netif *nif)
+{
+    static ulong seq = 0;
+    struct ipv4RasmEntry *rasm;
+    struct ipv4RasmEntry *oldest;
+    struct packet *pkt;
+    int i;
+
+    /* Look for the datagram in its hash bucket */
+    for (rasm = ipv4rasmhash[ipv4RasmHash(ip)]; NULL != rasm;
+         rasm = rasm->next)
+    {
+        if ((rasm->id == ip->id) && (rasm->proto == ip->proto)
+            && (0 == memcmp(rasm->src, ip->src, IPv4_ADDR_LEN))
+            && (0 == memcmp(rasm->dst, ip->dst, IPv4_ADDR_LEN)))
+        {
+            return rasm;
+        }
+    }
+
+    /* Find a free entry and buffer, evicting the oldest datagram */
+    while (TRUE)
+    {
+        rasm = NULL;
+        oldest = NULL;
+        for (i = 0; i < IPv4_RASM_NENTRY; i++)
+        {
+            if (IPv4_RASM_FREE == ipv4rasmtab[i].state)
+            {
+                if (NULL == rasm)
+                {
+                    rasm = &ipv4rasmtab[i];
+                }
+            }
+            else if ((NULL == oldest)
+                     || ((long)(ipv4rasmtab[i].seq - oldest->seq) < 0))
+            {
+                oldest = &ipv4rasmtab[i];
+            }
+        }
+
+        if ((NULL != rasm)
+            && (semcount(bfptab[ipv4rasmpool].freebuf) > 0))
+        {
+            break;
+        }
+        if (NULL == oldest)
+        {
+            return NULL;
+        }
+        IPv4_TRACE("Evicting reassembly entry %d", oldest - ipv4rasmtab);
+        ipv4RasmFree(oldest);
+    }
+
+    pkt = bufget(ipv4rasmpool);
+    if (SYSERR == (int)pkt)
+    {
+        return NULL;
+    }
+    netClearbuf(pkt);
+    pkt->nif = nif;
+
+    /* Payload is placed as if the IP header had no options */
+    rasm->state = IPv4_RASM_USED;
+    memcpy(rasm->src, ip->src, IPv4_ADDR_LEN);
+    memcpy(rasm->dst, ip->dst, IPv4_ADDR_LEN);
+    rasm->id = ip->id;
+    rasm->proto = ip->proto;
+    rasm->expires = clktime + IPv4_RASM_TTL;
+    rasm->seq = seq++;
+    rasm->pkt = pkt;
+    rasm->hdrlen = nif->linkhdrlen + IPv4_HDR_LEN;
+    rasm->first = FALSE;
+    rasm->ihl = 0;
+    rasm->datalen = 0;
+    rasm->nhole = 1;
+    rasm->hole[0].first = 0;
+    rasm->hole[0].last = IPv4_RASM_INF;
+
+    /* Insert into hash bucket */
+    i = ipv4RasmHash(rasm);
+    rasm->next = ipv4rasmhash[i];
+    ipv4rasmhash[i] = rasm;
+
+    return rasm;
+}
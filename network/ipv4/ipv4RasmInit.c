@@ -0,0 +1,54 @@
+/**
+ * @file ipv4RasmInit.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <bufpool.h>
+#include <ipv4.h>
+#include <network.h>
+#include <stdlib.h>
+#include <thread.h>
+
+struct ipv4RasmEntry ipv4rasmtab[IPv4_RASM_NENTRY];
+struct ipv4RasmEntry *ipv4rasmhash[IPv4_RASM_NHASH];
+int ipv4rasmpool;
+
+/**
+ * @ingroup ipv4
+ *
+ * Initializes the IPv4 fragment reassembly table, its buffer pool and the
+ * thread that expires incomplete datagrams.
+ * @return OK if initialization is successful, otherwise SYSERR
+ */
+syscall ipv4RasmInit(void)
+{
+    int i;
+
+    /* Initialize reassembly table */
+    for (i = 0; i < IPv4_RASM_NENTRY; i++)
+    {
+        bzero(&ipv4rasmtab[i], sizeof(struct ipv4RasmEntry));
+        ipv4rasmtab[i].state = IPv4_RASM_FREE;
+    }
+    for (i = 0; i < IPv4_RASM_NHASH; i++)
+    {
+        ipv4rasmhash[i] = NULL;
+    }
+
+    /* Allocate reassembly buffers; their total size is the memory cap */
+    ipv4rasmpool = bfpalloc(sizeof(struct packet) + IPv4_RASM_MAXLEN,
+                            IPv4_RASM_NBUF);
+    if (SYSERR == ipv4rasmpool)
+    {
+        return SYSERR;
+    }
+
+    /* Spawn ipv4RasmDaemon thread */
+    ready(create
+          ((void *)ipv4RasmDaemon, IPv4_RASM_THR_STK, IPv4_RASM_THR_PRIO,
+           "ipv4RasmDaemon", 0), RESCHED_NO);
+
+    return OK;
+}
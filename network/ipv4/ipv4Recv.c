@@ -6,13 +6,13 @@
 
 #include <stddef.h>
 #include <ipv4.h>
+#include <mib.h>
 #include <network.h>
 #include <raw.h>
 #include <route.h>
 #include <udp.h>
 #include <tcp.h>
 #include <icmp.h>
-#include <netemu.h>
 
 /**
  * @ingroup ipv4
@@ -34,6 +34,8 @@ syscall ipv4Recv(struct packet *pkt)
         return SYSERR;
     }
 
+    mib.ipv4.inReceives++;
+
     /* Setup pointer to IPv4 header */
     pkt->nethdr = pkt->curr;
     ip = (struct ipv4Pkt *)pkt->curr;
@@ -42,6 +44,7 @@ syscall ipv4Recv(struct packet *pkt)
     if (FALSE == ipv4RecvValid(ip))
     {
         IPv4_TRACE("Invalid packet");
+        mib.ipv4.inHdrErrors++;
         netFreebuf(pkt);
         return SYSERR;
     }
@@ -59,25 +62,7 @@ syscall ipv4Recv(struct packet *pkt)
     if (FALSE == ipv4RecvDemux(&dst))
     {
         IPv4_TRACE("Packet sent to routing subsystem");
-
-#if NETEMU
-        /* Run the packet through the network emulator if enabled */
-        return netemu(pkt);
-#else
         return rtRecv(pkt);
-#endif
-    }
-
-    /* Check if packet is fragmented */
-    if ((IPv4_FLAG_MF & net2hs(ip->flags_froff))
-        || (0 != (net2hs(ip->flags_froff) & IPv4_FROFF)))
-    {
-        // TODO: Handle fragmenting of packet
-        // TODO: Should send icmp time exceeded
-        // return ipRecvSendFrag(pkt, &dst);
-        IPv4_TRACE("Packet fragmented");
-        netFreebuf(pkt);
-        return SYSERR;
     }
 
     /* The Ethernet driver pads packets less than 60 bytes in length.
@@ -90,6 +75,21 @@ syscall ipv4Recv(struct packet *pkt)
         pkt->len = pkt->nif->linkhdrlen + iplen;
     }
 
+    /* Reassemble fragmented packets before passing them up */
+    if ((IPv4_FLAG_MF & net2hs(ip->flags_froff))
+        || (0 != (net2hs(ip->flags_froff) & IPv4_FROFF)))
+    {
+        IPv4_TRACE("Packet fragmented");
+        mib.ipv4.reasmReqds++;
+        pkt = ipv4Rasm(pkt);
+        if (NULL == pkt)
+        {
+            return OK;
+        }
+        mib.ipv4.reasmOKs++;
+        ip = (struct ipv4Pkt *)pkt->nethdr;
+    }
+
     /* Move current pointer to application level header */
     pkt->curr += ((ip->ver_ihl & IPv4_IHL) << 2);
 
@@ -99,12 +99,14 @@ syscall ipv4Recv(struct packet *pkt)
     {
         /* ICMP Packet */
     case IPv4_PROTO_ICMP:
+        mib.ipv4.inDelivers++;
         icmpRecv(pkt);
         break;
 
 #if NUDP
         /* UDP Packet */
     case IPv4_PROTO_UDP:
+        mib.ipv4.inDelivers++;
         udpRecv(pkt, &src, &dst);
         break;
 #endif
@@ -112,6 +114,7 @@ syscall ipv4Recv(struct packet *pkt)
 #if NTCP
         /* TCP Packet */
     case IPv4_PROTO_TCP:
+        mib.ipv4.inDelivers++;
         tcpRecv(pkt, &src, &dst);
         break;
 #endif
@@ -121,6 +124,7 @@ syscall ipv4Recv(struct packet *pkt)
 #if NRAW
         rawRecv(pkt, &src, &dst, ip->proto);
 #else
+        mib.ipv4.inUnknownProtos++;
         netFreebuf(pkt);
 #endif
         break;
@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <ipv4.h>
+#include <mib.h>
 #include <network.h>
 #include <string.h>
 #include <route.h>
@@ -18,7 +19,7 @@
  * @param src source IP address
  * @param dst destination IP address
  * @param proto the protocol of the ip pkt
- * @return OK if packet was sent, TIMEOUT if ARP request timed out,
+ * @return OK if packet was sent or queued awaiting ARP resolution,
  * IPv4_NO_INTERFACE if interface does not exist, IPv4_NO_HOP if next hop
  * is unknown, SYSERR otherwise.
  */
@@ -41,11 +42,14 @@ syscall ipv4Send(struct packet *pkt, struct netaddr *src,
         return SYSERR;
     }
 
+    mib.ipv4.outRequests++;
+
     /* Lookup destination in route table */
     rtptr = rtLookup(dst);
     if (NULL == rtptr)
     {
         IPv4_TRACE("No route");
+        mib.ipv4.outNoRoutes++;
         return SYSERR;
     }
 
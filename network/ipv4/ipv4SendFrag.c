@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <ipv4.h>
 #include <icmp.h>
+#include <mib.h>
 #include <network.h>
 #include <stdlib.h>
 #include <string.h>
@@ -56,10 +57,20 @@ syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
         return netSend(pkt, NULL, nxthop, ETHER_TYPE_IPv4);
     }
 
+    // Fragments are cut from a contiguous packet
+    if (SYSERR == netFlatten(pkt))
+    {
+        IPv4_TRACE("flattening pkt");
+        mib.ipv4.fragFails++;
+        return SYSERR;
+    }
+    ip = (struct ipv4Pkt *)pkt->curr;
+
     // Verify header does not have DF
     if (net2hs(ip->flags_froff) & IPv4_FLAG_DF)
     {
         IPv4_TRACE("net2hs of froff");
+        mib.ipv4.fragFails++;
         /* Send ICMP message */
         icmpDestUnreach(pkt, ICMP_FOFF_DFSET);
         return SYSERR;
@@ -79,13 +90,14 @@ syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
     ip->len = hs2net(pkt->len);
 
     // Set more fragments flag
-    ip->flags_froff = IPv4_FLAG_MF & froff;
+    ip->flags_froff = IPv4_FLAG_MF | froff;
     ip->flags_froff = hs2net(ip->flags_froff);
 
     ip->chksum = 0;
     ip->chksum = netChksum((uchar *)ip, ihl);
 
     netSend(pkt, NULL, nxthop, ETHER_TYPE_IPv4);
+    mib.ipv4.fragCreates++;
     dRem -= dLen;
     data += dLen;
     froff += (dLen / 8);
@@ -96,6 +108,7 @@ syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
     if (SYSERR == (int)outpkt)
     {
         IPv4_TRACE("allocating outpkt");
+        mib.ipv4.fragFails++;
         return SYSERR;
     }
 
@@ -109,7 +122,7 @@ syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
     // While packet must be fragmented
     while (dRem > 0)
     {
-        if (((dRem + 7) & ~0x7) > pkt->nif->mtu + IPv4_HDR_LEN)
+        if (((dRem + 7) & ~0x7) > pkt->nif->mtu - IPv4_HDR_LEN)
         {
             dLen = (pkt->nif->mtu - IPv4_HDR_LEN) & ~0x7;
         }
@@ -123,11 +136,11 @@ syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
         // Set more fragments flag
         if (dLen == dRem)
         {
-            outip->flags_froff = lastFlag & froff;
+            outip->flags_froff = lastFlag | froff;
         }
         else
         {
-            outip->flags_froff = IPv4_FLAG_MF & froff;
+            outip->flags_froff = IPv4_FLAG_MF | froff;
         }
         outip->flags_froff = hs2net(outip->flags_froff);
 
@@ -136,17 +149,20 @@ syscall ipv4SendFrag(struct packet *pkt, struct netaddr *nxthop)
         outip->chksum = 0;
         outip->chksum = netChksum((uchar *)outip, IPv4_HDR_LEN);
 
-        // Update outgoing packet length
+        // Update outgoing packet pointer and length
+        outpkt->curr = (uchar *)outip;
         outpkt->len = net2hs(outip->len);
 
         // Send fragment
         netSend(outpkt, NULL, nxthop, ETHER_TYPE_IPv4);
+        mib.ipv4.fragCreates++;
 
         dRem -= dLen;
         data += dLen;
         froff += (dLen / 8);
     }
 
+    mib.ipv4.fragOKs++;
     IPv4_TRACE("freeing outpkt");
     netFreebuf(outpkt);
     return OK;
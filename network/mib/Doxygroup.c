@@ -0,0 +1,5 @@
+/**
+ * @defgroup mib Statistics
+ * @ingroup network
+ * @brief Network statistics counters
+ */
@@ -0,0 +1,48 @@
+/**
+ * @file mibReset.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <mib.h>
+#include <network.h>
+#include <stdlib.h>
+
+struct mib mib;
+
+/**
+ * @ingroup mib
+ *
+ * Clears the network statistics, including the packet counters of every
+ * network interface and its receive workers.
+ */
+void mibReset(void)
+{
+    irqmask im;
+#if NNETIF
+    struct netif *netptr;
+    int nif;
+    uint i;
+#endif
+
+    im = disable();
+    bzero(&mib, sizeof(mib));
+#if NNETIF
+    for (nif = 0; nif < NNETIF; nif++)
+    {
+        netptr = &netiftab[nif];
+        netptr->nin = 0;
+        netptr->nproc = 0;
+        netptr->nout = 0;
+        netptr->ndrop = 0;
+        for (i = 0; i < NET_NTHR; i++)
+        {
+            netptr->worker[i].nproc = 0;
+            netptr->worker[i].ndrop = 0;
+        }
+    }
+#endif
+    restore(im);
+}
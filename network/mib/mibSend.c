@@ -0,0 +1,73 @@
+/**
+ * @file mibSend.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <clock.h>
+#include <device.h>
+#include <mib.h>
+#include <network.h>
+#include <route.h>
+#include <udp.h>
+
+/**
+ * @ingroup mib
+ *
+ * Sends a snapshot of the network statistics in one UDP datagram, laid
+ * out as a struct mibSnapshot in network byte order.
+ * @param dst address of the monitoring host
+ * @param port UDP port of the monitoring host
+ * @return OK if the snapshot was sent, otherwise SYSERR
+ */
+syscall mibSend(const struct netaddr *dst, ushort port)
+{
+#if NUDP
+    struct mibSnapshot snap;
+    const uint *words;
+    struct rtEntry *rtptr;
+    int dev;
+    int result;
+    uint i;
+
+    if ((NULL == dst) || (NETADDR_IPv4 != dst->type))
+    {
+        return SYSERR;
+    }
+
+    /* Send from the address of the interface that reaches dst */
+    rtptr = rtLookup(dst);
+    if ((NULL == rtptr) || (SYSERR == (int)rtptr))
+    {
+        return SYSERR;
+    }
+
+    snap.magic = hl2net(MIB_MAGIC);
+    snap.version = hl2net(MIB_VERSION);
+    snap.time = hl2net(clktime);
+    snap.nwords = hl2net(sizeof(snap.words) / sizeof(uint));
+    words = (const uint *)&mib;
+    for (i = 0; i < sizeof(snap.words) / sizeof(uint); i++)
+    {
+        snap.words[i] = hl2net(words[i]);
+    }
+
+    dev = udpAlloc();
+    if (SYSERR == dev)
+    {
+        return SYSERR;
+    }
+    if (SYSERR == open(dev, &rtptr->nif->ip, dst, 0, port))
+    {
+        udptab[dev - UDP0].state = UDP_FREE;
+        return SYSERR;
+    }
+    result = write(dev, &snap, sizeof(snap));
+    close(dev);
+
+    return (sizeof(snap) == result) ? OK : SYSERR;
+#else
+    return SYSERR;
+#endif                          /* NUDP */
+}
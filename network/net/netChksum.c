@@ -39,3 +39,73 @@ ushort netChksum(void *data, uint len)
 
     return (~sum);
 }
+
+/**
+ * @ingroup network
+ *
+ * Compute the Internet checksum of the concatenation of a list of segments.
+ * Segments may have any length and alignment; a segment that starts on an
+ * odd offset into the combined data is summed a byte at a time.
+ *
+ * @param segs
+ *      array of segments
+ * @param nsegs
+ *      number of segments in @p segs
+ *
+ * @return checksum, in the same form as returned by netChksum()
+ */
+ushort netChksumSg(const struct netseg *segs, uint nsegs)
+{
+    uint sum;
+    uint i;
+    uint len;
+    const uchar *ptr;
+    bool odd;
+
+    sum = 0;
+    odd = FALSE;
+    for (i = 0; i < nsegs; i++)
+    {
+        ptr = segs[i].data;
+        len = segs[i].len;
+
+        /* Add whole words while the segment is word aligned and the combined
+         * data is at an even offset */
+        if (!odd && (0 == ((ulong)ptr & 1)))
+        {
+            while (len > 1)
+            {
+                sum += *((ushort *)ptr);
+                ptr += 2;
+                len -= 2;
+            }
+        }
+
+        /* Add remaining bytes as the high or low half of a word */
+        while (len > 0)
+        {
+            if (odd)
+            {
+                sum += net2hs(*ptr);
+            }
+            else
+            {
+                sum += net2hs(*ptr << 8);
+            }
+            odd = !odd;
+            ptr++;
+            len--;
+        }
+
+        /* Fold so the sum cannot overflow across many segments */
+        sum = (sum >> 16) + (sum & 0xFFFF);
+    }
+
+    /* Fold 32-bit sum into 16 bits */
+    while (sum >> 16)
+    {
+        sum = (sum >> 16) + (sum & 0xFFFF);
+    }
+
+    return (~sum);
+}
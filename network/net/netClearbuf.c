@@ -0,0 +1,28 @@
+/**
+ * @file netClearbuf.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <network.h>
+
+/**
+ * @ingroup network
+ *
+ * Resets the metadata of a packet buffer so it can be reused for a new
+ * packet.  The packet data area is not touched.
+ *
+ * @param pkt
+ *      packet buffer to reset
+ */
+void netClearbuf(struct packet *pkt)
+{
+    pkt->nif = NULL;
+    pkt->len = 0;
+    pkt->linkhdr = NULL;
+    pkt->nethdr = NULL;
+    /* Initialize curr to point to end of buffer */
+    pkt->curr = pkt->data + NET_MAX_PKTLEN;
+    pkt->nseg = 0;
+}
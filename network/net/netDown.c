@@ -26,7 +26,6 @@ syscall netDown(int descrp)
 {
     struct netif *netptr;
     irqmask im;
-    uint i;
 
     im = disable();
 
@@ -44,10 +43,8 @@ syscall netDown(int descrp)
     /* Kill receiver threads.  TODO: There is a known bug here: this can kill
      * the receiver threads at inopportune times and leak resources (such as
      * packet buffers allocated with netGetbuf()).  */
-    for (i = 0; i < NET_NTHR; i++)
-    {
-        kill(netptr->recvthr[i]);
-    }
+    kill(netptr->recvthr);
+    netRecvWorkers(netptr, 0);
 
     /* Clear all entries in the route table for this network interface.  */
     rtClear(netptr);
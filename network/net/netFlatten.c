@@ -0,0 +1,56 @@
+/**
+ * @file netFlatten.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <network.h>
+#include <string.h>
+
+/**
+ * @ingroup network
+ *
+ * Copies the external payload segments of a packet into its buffer, so
+ * the whole packet is contiguous starting at pkt->curr.  The bytes already
+ * in the buffer are moved toward the start of the buffer to make room, so
+ * the end of the packet does not move.  Packets without segments are left
+ * as they are.
+ *
+ * @param pkt
+ *      packet to flatten
+ * @return OK if the packet is contiguous, SYSERR if it does not fit in the
+ *      packet buffer
+ */
+syscall netFlatten(struct packet *pkt)
+{
+    uint buflen;
+    uint seglen;
+    uchar *dst;
+    uint i;
+
+    if (0 == pkt->nseg)
+    {
+        return OK;
+    }
+
+    seglen = netSeglen(pkt);
+    buflen = pkt->len - seglen;
+    if (pkt->curr - seglen < pkt->data)
+    {
+        return SYSERR;
+    }
+
+    /* Move buffer contents back, then append the segments after them */
+    memmove(pkt->curr - seglen, pkt->curr, buflen);
+    pkt->curr -= seglen;
+    dst = pkt->curr + buflen;
+    for (i = 0; i < pkt->nseg; i++)
+    {
+        memcpy(dst, pkt->seg[i].data, pkt->seg[i].len);
+        dst += pkt->seg[i].len;
+    }
+    pkt->nseg = 0;
+
+    return OK;
+}
@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <bufpool.h>
+#include <mib.h>
 #include <network.h>
 #include <stdlib.h>
 
@@ -13,6 +14,13 @@
  * @ingroup network
  *
  * Provides a buffer for storing a packet.
+ *
+ * Only the packet metadata is initialized; the contents of the data area are
+ * left as they were when the buffer was last freed.  Callers that build
+ * headers in the buffer must explicitly set every header field (including
+ * reserved fields, checksums and option padding) rather than relying on the
+ * buffer being zeroed.
+ *
  * @return pointer to a packet buffer, SYSERR if an error occured
  */
 struct packet *netGetbuf(void)
@@ -23,16 +31,11 @@ struct packet *netGetbuf(void)
     pkt = bufget(netpool);
     if (SYSERR == (int)pkt)
     {
+        mib.net.noBufs++;
         return (struct packet *)SYSERR;
     }
 
-    bzero(pkt, sizeof(struct packet) + NET_MAX_PKTLEN);
-
-    /* Initialize packet buffer */
-    pkt->nif = NULL;
-    pkt->len = 0;
-    /* Initialize curr to point to end of buffer */
-    pkt->curr = pkt->data + NET_MAX_PKTLEN;
+    netClearbuf(pkt);
 
     return pkt;
 }
@@ -0,0 +1,47 @@
+/**
+ * @file netGetbufNowait.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <bufpool.h>
+#include <interrupt.h>
+#include <mib.h>
+#include <network.h>
+#include <semaphore.h>
+
+/**
+ * @ingroup network
+ *
+ * Provides a buffer for storing a packet without blocking.  This is intended
+ * for network drivers that receive frames into network pool buffers from
+ * interrupt context, where waiting for a buffer to be freed is not an option.
+ *
+ * @return pointer to a packet buffer, SYSERR if no buffer is free
+ */
+struct packet *netGetbufNowait(void)
+{
+    struct packet *pkt;
+    irqmask im;
+
+    im = disable();
+    if (isbadpool(netpool) || semcount(bfptab[netpool].freebuf) < 1)
+    {
+        restore(im);
+        mib.net.noBufs++;
+        return (struct packet *)SYSERR;
+    }
+
+    /* A buffer is free, so bufget() will not block */
+    pkt = bufget(netpool);
+    restore(im);
+    if (SYSERR == (int)pkt)
+    {
+        return (struct packet *)SYSERR;
+    }
+
+    netClearbuf(pkt);
+
+    return pkt;
+}
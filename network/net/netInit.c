@@ -6,6 +6,7 @@
 #include <stddef.h>
 #include <arp.h>
 #include <icmp.h>
+#include <ipv4.h>
 #include <bufpool.h>
 #include <network.h>
 #include <route.h>
@@ -57,6 +58,12 @@ syscall netInit()
         return SYSERR;
     }
 
+    /* Initialize IPv4 fragment reassembly */
+    if (SYSERR == ipv4RasmInit())
+    {
+        return SYSERR;
+    }
+
     /* Initialize ICMP */
     if (SYSERR == icmpInit())
     {
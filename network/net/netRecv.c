@@ -5,9 +5,10 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
-#include <arp.h>
 #include <device.h>
 #include <ethernet.h>
+#include <interrupt.h>
+#include <mib.h>
 #include <network.h>
 #include <ipv4.h>
 #include <snoop.h>
@@ -15,10 +16,16 @@
 #include <string.h>
 #include <thread.h>
 
+static uint netFlowHash(struct packet *, ushort);
+
 /**
  * @ingroup network
  *
- * Receive thread to handle one incoming packet at a time
+ * Receive thread to handle incoming packets.  Where the driver supports it,
+ * each wakeup takes a burst of up to ::NET_NBURST frames before waiting
+ * again.  Frames for this interface are hashed on their addresses and
+ * ports and queued to the netRecvWorker() that owns the flow; the workers
+ * are woken once the whole burst has been queued.
  *
  * @param netptr
  *      network interface device to open netRecv on
@@ -30,97 +37,220 @@ thread netRecv(struct netif *netptr)
 {
     uint maxlen;                            /**< maximum packet length */
     maxlen = netptr->linkhdrlen + netptr->mtu;
+    struct packet *pkts[NET_NBURST];
     struct packet *pkt;
     struct etherPkt *ether;
     struct netaddr dst;
+    struct netWorker *worker;
+    uint nqueued[NET_NTHR];                 /**< pkts queued per worker */
+    uint hash;
+    ushort type;
+    irqmask im;
+    bool rxburst = TRUE;                    /**< driver hands up bursts */
+    bool rxpkt = TRUE;                      /**< driver hands up packets */
+    int npkt;
+    int i;
 
     /* Processing incoming packets */
     while (TRUE)
     {
         int len;
 
-        /* Get a buffer for incoming packet */
-        pkt = netGetbuf();
-        if (SYSERR == (int)pkt)
+        if (rxburst)
         {
-            continue;
+            /* Take every frame the driver has ready, up to a burst.  This
+             * thread will wait until there is at least one.  */
+            npkt = control(netptr->dev, NET_RECV_BURST, (long)pkts,
+                           NET_NBURST);
+            if (SYSERR == npkt)
+            {
+                rxburst = FALSE;
+                continue;
+            }
         }
-
-        /* Read in packet from the underlying network device.
-         * This thread will wait until there is a packet to read.
-         * It is the responsibility of the network driver to tell this
-         * thread to run, signifying that there is a packet to read
-         */
-        len = read(netptr->dev, pkt->data, maxlen);
-        if (ETH_HDR_LEN > len || SYSERR == len)
+        else if (rxpkt)
         {
-            netFreebuf(pkt);
-            continue;
+            /* Take a frame the driver has already received into a network
+             * pool buffer.  This thread will wait until there is one.  If
+             * the driver does not support this, fall back to read().  */
+            len = control(netptr->dev, NET_RECV_PKT, (long)&pkts[0], 0);
+            if (SYSERR == len)
+            {
+                rxpkt = FALSE;
+                continue;
+            }
+            npkt = 1;
         }
+        else
+        {
+            /* Get a buffer for incoming packet */
+            pkt = netGetbuf();
+            if (SYSERR == (int)pkt)
+            {
+                continue;
+            }
 
-        pkt->len = len;
-        pkt->curr = pkt->data;
-        pkt->nif = netptr;
-        netptr->nin++;
+            /* Read in packet from the underlying network device.
+             * This thread will wait until there is a packet to read.
+             * It is the responsibility of the network driver to tell this
+             * thread to run, signifying that there is a packet to read
+             */
+            len = read(netptr->dev, pkt->data, maxlen);
+            if (SYSERR == len)
+            {
+                netFreebuf(pkt);
+                continue;
+            }
 
-        /* Point to packet location in the incoming packet buffer */
-        pkt->linkhdr = pkt->curr;
-        ether = (struct etherPkt *)pkt->curr;
+            pkt->len = len;
+            pkt->curr = pkt->data;
+            pkts[0] = pkt;
+            npkt = 1;
+        }
 
-        /* Snoop if we are in promiscuous mode */
-        if (netptr->capture != NULL)
+        bzero(nqueued, sizeof(nqueued));
+        for (i = 0; i < npkt; i++)
         {
-            snoopCapture(netptr->capture, pkt);
-        }
+            pkt = pkts[i];
+            if (ETH_HDR_LEN > pkt->len)
+            {
+                netptr->ndrop++;
+                mib.net.inRunts++;
+                netFreebuf(pkt);
+                continue;
+            }
+
+            pkt->nif = netptr;
+            netptr->nin++;
+
+            /* Point to packet location in the incoming packet buffer */
+            pkt->linkhdr = pkt->curr;
+            ether = (struct etherPkt *)pkt->curr;
+
+            /* Snoop if we are in promiscuous mode */
+            if (netptr->capture != NULL)
+            {
+                snoopCapture(netptr->capture, pkt);
+            }
 
-        /* Obtain destination hardware address */
-        dst.type = NETADDR_ETHERNET;
-        dst.len = ETH_ADDR_LEN;
-        memcpy(dst.addr, ether->dst, ETH_ADDR_LEN);
+            /* Obtain destination hardware address */
+            dst.type = NETADDR_ETHERNET;
+            dst.len = ETH_ADDR_LEN;
+            memcpy(dst.addr, ether->dst, ETH_ADDR_LEN);
 
 #ifdef TRACE_NET
-        char str[20];
-        NET_TRACE("Read packet len %d", pkt->len);
-        netaddrsprintf(str, &dst);
-        NET_TRACE("\tPacket dst %s", str);
-        NET_TRACE("\tPacket proto 0x%04X", net2hs(ether->type));
+            char str[20];
+            NET_TRACE("Read packet len %d", pkt->len);
+            netaddrsprintf(str, &dst);
+            NET_TRACE("\tPacket dst %s", str);
+            NET_TRACE("\tPacket proto 0x%04X", net2hs(ether->type));
 #endif
 
-        /* Verify that packet belongs to our mac or is broadcast mac */
-        if ((netaddrequal(&dst, &netptr->hwaddr))
-            || (netaddrequal(&dst, &netptr->hwbrc)))
-        {
+            /* Verify that packet belongs to our mac or is broadcast mac */
+            if ((!netaddrequal(&dst, &netptr->hwaddr))
+                && (!netaddrequal(&dst, &netptr->hwbrc)))
+            {
+                netptr->ndrop++;
+                mib.net.inNotOurs++;
+                netFreebuf(pkt);
+                continue;
+            }
+
+            /* Drop unknown ether packet types before queuing */
+            type = net2hs(ether->type);
+            if ((ETHER_TYPE_IPv4 != type) && (ETHER_TYPE_ARP != type))
+            {
+                netptr->ndrop++;
+                mib.net.inUnknownTypes++;
+                netFreebuf(pkt);
+                continue;
+            }
+
             /* Move current pointer to network level header */
             pkt->curr = pkt->data + netptr->linkhdrlen;
+            hash = netFlowHash(pkt, type);
 
-            /* Call necessary routine based on packet type */
-            switch (net2hs(ether->type))
+            /* Queue packet on the worker that owns its flow */
+            im = disable();
+            if (0 == netptr->nworker)
             {
-                /* IP Packet */
-            case ETHER_TYPE_IPv4:
-                ipv4Recv(pkt);
-                netptr->nproc++;
-                break;
-
-                /* ARP Packet */
-            case ETHER_TYPE_ARP:
-                arpRecv(pkt);
-                netptr->nproc++;
-                break;
-
-                /* Unknown ether packet type */
-            default:
+                netptr->ndrop++;
+                mib.net.inQueueDrops++;
+                restore(im);
                 netFreebuf(pkt);
-                break;
+                continue;
             }
-
+            hash %= netptr->nworker;
+            worker = &netptr->worker[hash];
+            if (worker->count >= NET_WORKQLEN)
+            {
+                worker->ndrop++;
+                netptr->ndrop++;
+                mib.net.inQueueDrops++;
+                restore(im);
+                netFreebuf(pkt);
+                continue;
+            }
+            worker->pkt[(worker->head + worker->count) % NET_WORKQLEN] =
+                pkt;
+            worker->count++;
+            nqueued[hash]++;
+            restore(im);
         }
-        else
+
+        /* Wake the workers now that the burst is queued */
+        for (i = 0; i < NET_NTHR; i++)
         {
-            netFreebuf(pkt);
+            if (nqueued[i] > 0)
+            {
+                signaln(netptr->worker[i].sema, nqueued[i]);
+            }
         }
     }
 
     return SYSERR;
 
 }
+
+/**
+ * Hashes the flow a packet belongs to.  IPv4 packets hash on addresses and
+ * protocol, plus ports for TCP and UDP; fragments leave out the ports,
+ * which only the first fragment carries.  ARP packets all hash to zero.
+ * @param pkt packet, with curr at the network-level header
+ * @param type ether packet type
+ * @return flow hash
+ */
+static uint netFlowHash(struct packet *pkt, ushort type)
+{
+    struct ipv4Pkt *ip;
+    uint hash, ports, ihl;
+    int i;
+
+    if (ETHER_TYPE_IPv4 != type)
+    {
+        return 0;
+    }
+
+    ip = (struct ipv4Pkt *)pkt->curr;
+    ihl = (ip->ver_ihl & IPv4_IHL) * 4;
+    hash = 0;
+    for (i = 0; i < IPv4_ADDR_LEN; i++)
+    {
+        hash = (hash << 8) | (ip->src[i] ^ ip->dst[i]);
+    }
+    hash ^= ip->proto;
+
+    if (((IPv4_PROTO_TCP == ip->proto) || (IPv4_PROTO_UDP == ip->proto))
+        && (0 == (net2hs(ip->flags_froff) & (IPv4_FLAG_MF | IPv4_FROFF)))
+        && (pkt->curr + ihl + sizeof(ports) <= pkt->linkhdr + pkt->len))
+    {
+        memcpy(&ports, pkt->curr + ihl, sizeof(ports));
+        hash ^= ports;
+    }
+
+    /* Mix the bits so the low ones depend on the whole key */
+    hash ^= hash >> 16;
+    hash *= 0x45D9F3B;
+    hash ^= hash >> 16;
+    return hash;
+}
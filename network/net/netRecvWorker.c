@@ -0,0 +1,90 @@
+/**
+ * @file     netRecvWorker.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <arp.h>
+#include <ethernet.h>
+#include <interrupt.h>
+#include <ipv4.h>
+#include <netemu.h>
+#include <network.h>
+#include <semaphore.h>
+
+/**
+ * @ingroup network
+ *
+ * Receive worker thread.  Processes, in arrival order, the packets that
+ * netRecv() has queued for the flows hashed to this worker.  Once told to
+ * stop, it drains its queue and exits.
+ *
+ * @param netptr
+ *      network interface the worker belongs to
+ * @param worker
+ *      worker queue to take packets from
+ *
+ * @return
+ *      OK once the worker has been stopped.
+ */
+thread netRecvWorker(struct netif *netptr, struct netWorker *worker)
+{
+    struct packet *pkt;
+    struct etherPkt *ether;
+    irqmask im;
+
+    while (TRUE)
+    {
+        /* A stopping worker takes what is queued without waiting, since
+         * netRecv() may not have signalled every packet yet */
+        if (!worker->stop)
+        {
+            wait(worker->sema);
+        }
+
+        im = disable();
+        if (0 == worker->count)
+        {
+            restore(im);
+            if (worker->stop)
+            {
+                break;
+            }
+            continue;
+        }
+        pkt = worker->pkt[worker->head];
+        worker->head = (worker->head + 1) % NET_WORKQLEN;
+        worker->count--;
+        restore(im);
+
+        /* Call necessary routine based on packet type */
+        ether = (struct etherPkt *)pkt->linkhdr;
+        switch (net2hs(ether->type))
+        {
+            /* IP Packet */
+        case ETHER_TYPE_IPv4:
+#if NETEMU
+            /* Run the packet through the network emulator if enabled */
+            netemu(pkt);
+#else
+            ipv4Recv(pkt);
+#endif
+            break;
+
+            /* ARP Packet */
+        case ETHER_TYPE_ARP:
+            arpRecv(pkt);
+            break;
+
+        default:
+            netFreebuf(pkt);
+            break;
+        }
+        worker->nproc++;
+        netptr->nproc++;
+    }
+
+    signal(worker->done);
+    return OK;
+}
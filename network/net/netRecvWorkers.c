@@ -0,0 +1,117 @@
+/**
+ * @file     netRecvWorkers.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <device.h>
+#include <interrupt.h>
+#include <network.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread.h>
+
+static void netWorkerStop(struct netWorker *);
+
+/**
+ * @ingroup network
+ *
+ * Sets the number of receive worker threads on a network interface.  The
+ * current workers first process the packets still queued to them and
+ * exit, since flows hash to different workers once the count changes.
+ *
+ * @param netptr
+ *      network interface
+ * @param nworker
+ *      number of workers, at most ::NET_NTHR; 0 stops all workers, and
+ *      packets received until workers are started again are dropped
+ *
+ * @return
+ *      OK if the workers were started; otherwise SYSERR, in which case the
+ *      interface is left with no workers.
+ */
+syscall netRecvWorkers(struct netif *netptr, uint nworker)
+{
+    struct netWorker *worker;
+    char thrname[DEVMAXNAME + 30];
+    irqmask im;
+    uint i;
+
+    if ((NULL == netptr) || (nworker > NET_NTHR))
+    {
+        return SYSERR;
+    }
+
+    im = disable();
+
+    /* Stop queueing to the current workers, then stop them */
+    i = netptr->nworker;
+    netptr->nworker = 0;
+    while (i > 0)
+    {
+        netWorkerStop(&netptr->worker[--i]);
+    }
+
+    /* Start the new ones */
+    for (i = 0; i < nworker; i++)
+    {
+        worker = &netptr->worker[i];
+        bzero(worker, sizeof(struct netWorker));
+        worker->tid = BADTID;
+        worker->sema = semcreate(0);
+        worker->done = semcreate(0);
+        if ((SYSERR == (int)worker->sema) || (SYSERR == (int)worker->done))
+        {
+            netWorkerStop(worker);
+            break;
+        }
+
+        sprintf(thrname, "%swork%02d", devtab[netptr->dev].name, i);
+        worker->tid = create(netRecvWorker, NET_THR_STK, NET_THR_PRIO,
+                             thrname, 2, netptr, worker);
+        if (SYSERR == worker->tid)
+        {
+            worker->tid = BADTID;
+            netWorkerStop(worker);
+            break;
+        }
+        ready(worker->tid, RESCHED_NO);
+    }
+
+    /* Failed to start all workers; stop the ones that were started */
+    if (i < nworker)
+    {
+        NET_TRACE("Failed to start receive worker %d", i);
+        while (i > 0)
+        {
+            netWorkerStop(&netptr->worker[--i]);
+        }
+        restore(im);
+        return SYSERR;
+    }
+
+    netptr->nworker = nworker;
+    restore(im);
+    return OK;
+}
+
+/**
+ * Stops a worker thread and frees its semaphores.  The worker is never
+ * killed, since it may hold a TCB mutex or a packet; it drains its queue
+ * and exits on its own.  Must be called with interrupts disabled, once
+ * netRecv() no longer queues packets to the worker.
+ */
+static void netWorkerStop(struct netWorker *worker)
+{
+    if (!isbadtid(worker->tid))
+    {
+        worker->stop = TRUE;
+        signal(worker->sema);
+        wait(worker->done);
+    }
+    worker->tid = BADTID;
+    semfree(worker->sema);
+    semfree(worker->done);
+}
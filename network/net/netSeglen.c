@@ -0,0 +1,31 @@
+/**
+ * @file netSeglen.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <network.h>
+
+/**
+ * @ingroup network
+ *
+ * Computes the number of bytes of a packet held in external payload
+ * segments rather than in the packet buffer.
+ *
+ * @param pkt
+ *      packet to examine
+ * @return total length of the packet's payload segments
+ */
+uint netSeglen(const struct packet *pkt)
+{
+    uint i;
+    uint len = 0;
+
+    for (i = 0; i < pkt->nseg; i++)
+    {
+        len += pkt->seg[i].len;
+    }
+
+    return len;
+}
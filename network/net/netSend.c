@@ -21,7 +21,7 @@
  * @param hwaddr hardware address of the destination, NULL if should lookup
  * @param praddr protocol address of the destination, NULL if hwaddr is known
  * @param type type of the packet to put in link level header
- * @return OK if packet was sent, TIMEOUT if ARP request timed out,
+ * @return OK if packet was sent or queued awaiting ARP resolution,
  * 	otherwise SYSERR
  */
 syscall netSend(struct packet *pkt, const struct netaddr *hwaddr,
@@ -31,6 +31,8 @@ syscall netSend(struct packet *pkt, const struct netaddr *hwaddr,
     struct etherPkt *ether = NULL;      /**< pointer to Ethernet header   */
     int result;                         /**< result of ARP lookup         */
     struct netaddr addr;
+    struct netseg segs[NET_MAX_SEGS + 1];
+    uint i;
 
     /* Setup and error check pointers */
     if (NULL == pkt)
@@ -45,6 +47,23 @@ syscall netSend(struct packet *pkt, const struct netaddr *hwaddr,
 
     NET_TRACE("Send packet of type 0x%04X", type);
 
+    /* If no hardware address was specified, lookup using protocol address;
+     * an unresolved packet is queued and sent once the reply arrives */
+    if (NULL == hwaddr)
+    {
+        NET_TRACE("Hardware address lookup required");
+        result = arpResolve(netptr, praddr, &addr, pkt, type);
+        if (ARP_PENDING == result)
+        {
+            return OK;
+        }
+        if (result != OK)
+        {
+            return result;
+        }
+        hwaddr = &addr;
+    }
+
     /* Make space for Link-Level header */
     pkt->curr -= netptr->linkhdrlen;
     pkt->len += netptr->linkhdrlen;
@@ -59,27 +78,42 @@ syscall netSend(struct packet *pkt, const struct netaddr *hwaddr,
     NET_TRACE("Src = %s", str);
 #endif
 
-    /* If no hardware address was specified, lookup using protocol address */
-    if (NULL == hwaddr)
-    {
-        NET_TRACE("Hardware address lookup required");
-        hwaddr = &addr;
-        result = arpLookup(netptr, praddr, (struct netaddr*)hwaddr);
-        if (result != OK)
-        {
-            return result;
-        }
-    }
-
     /* Copy destination hardware address into link-level header */
     memcpy(ether->dst, hwaddr->addr, hwaddr->len);
 
     /* Write the packet to the underlying device */
-    if (pkt->len != write(netptr->dev, pkt->curr, pkt->len))
+    if (pkt->nseg > 0)
+    {
+        /* Hand the driver the header and payload segments in place */
+        segs[0].data = pkt->curr;
+        segs[0].len = netBuflen(pkt);
+        for (i = 0; i < pkt->nseg; i++)
+        {
+            segs[i + 1] = pkt->seg[i];
+        }
+        result = control(netptr->dev, NET_SEND_SG, (long)segs,
+                         pkt->nseg + 1);
+        if (SYSERR == result)
+        {
+            /* Driver needs a contiguous frame */
+            if (SYSERR == netFlatten(pkt))
+            {
+                return SYSERR;
+            }
+        }
+        else if (pkt->len != result)
+        {
+            return SYSERR;
+        }
+    }
+    if ((0 == pkt->nseg)
+        && (pkt->len != write(netptr->dev, pkt->curr, pkt->len)))
     {
         return SYSERR;
     }
 
+    netptr->nout++;
+
     /* Snoop packet */
     if (netptr->capture != NULL)
     {
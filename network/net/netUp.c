@@ -39,7 +39,7 @@ syscall netUp(int descrp, const struct netaddr *ip, const struct netaddr *mask,
     int nif;
     struct netif *netptr;
     uint i;
-    uint nthreads;
+    char thrname[DEVMAXNAME + 30];
     int retval = SYSERR;
 
     /* Error check arguments */
@@ -141,33 +141,26 @@ syscall netUp(int descrp, const struct netaddr *ip, const struct netaddr *mask,
         rtDefault(&netptr->gateway, netptr);
     }
 
-    /*  Spawn receive threads associated with this interface */
-    for (i = 0; i < NET_NTHR; i++)
+    /* Spawn the receive workers, then the receive thread that dispatches
+     * flows to them */
+    if (SYSERR == netRecvWorkers(netptr, NET_NTHR))
     {
-        char thrname[DEVMAXNAME + 30];
-        tid_typ tid;
-
-        sprintf(thrname, "%srecv%02d", devtab[descrp].name, i);
-        tid = create(netRecv, NET_THR_STK, NET_THR_PRIO, thrname, 1, netptr);
-        if (SYSERR == tid)
-        {
-            /* Failed to create all receive threads; kill the ones that have
-             * already been spawned.  */
-            nthreads = i;
-            goto out_kill_recv_threads;
-        }
-        netptr->recvthr[i] = tid;
-        ready(tid, RESCHED_NO);
+        NET_TRACE("Failed to start receive workers");
+        goto out_free_nif;
     }
+    sprintf(thrname, "%srecv", devtab[descrp].name);
+    netptr->recvthr = create(netRecv, NET_THR_STK, NET_THR_PRIO, thrname, 1,
+                             netptr);
+    if (SYSERR == netptr->recvthr)
+    {
+        netRecvWorkers(netptr, 0);
+        goto out_free_nif;
+    }
+    ready(netptr->recvthr, RESCHED_NO);
 
     retval = OK;
     goto out_restore;
 
-out_kill_recv_threads:
-    for (i = 0; i < nthreads; i++)
-    {
-        kill(netptr->recvthr[i]);
-    }
 out_free_nif:
     netptr->state = NET_FREE;
 out_restore:
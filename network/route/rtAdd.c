@@ -5,25 +5,42 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <interrupt.h>
 #include <network.h>
 #include <route.h>
 
 /**
  * @ingroup route
+ *
+ * Adds a route to the routing table, replacing any route to the same
+ * destination and mask.
+ * @param dst destination network
+ * @param gate gateway, NULL if the destination is directly connected
+ * @param mask destination subnet mask; must be contiguous
+ * @param nif network interface for the route
+ * @return OK if the route is added successfully, otherwise SYSERR
  */
 syscall rtAdd(const struct netaddr *dst, const struct netaddr *gate,
               const struct netaddr *mask, struct netif *nif)
 {
     struct rtEntry *rtptr;
+    struct rtEntry *old;
     uchar octet;
     ushort length;
     int i;
+    irqmask im;
 
     /* Error check pointers */
     if ((NULL == dst) || (NULL == mask) || (NULL == nif))
     {
         return SYSERR;
     }
+
+    /* Only IPv4 destinations are routed */
+    if ((NETADDR_IPv4 != dst->type) || (NETADDR_IPv4 != mask->type))
+    {
+        return SYSERR;
+    }
     RT_TRACE("Dest = %d.%d.%d.%d", dst->addr[0], dst->addr[1],
              dst->addr[2], dst->addr[3]);
     RT_TRACE("Mask = %d.%d.%d.%d", mask->addr[0], mask->addr[1],
@@ -71,6 +88,30 @@ syscall rtAdd(const struct netaddr *dst, const struct netaddr *gate,
     }
     rtptr->masklen = length;
 
+    /* Longest prefix match needs the mask bits to be contiguous */
+    if (rtKey(mask->addr) != rtMask(length))
+    {
+        RT_TRACE("Non-contiguous mask");
+        rtptr->state = RT_FREE;
+        return SYSERR;
+    }
+
+    /* Make the route visible to lookups */
+    im = disable();
+    old = rtTrieInsert(rtptr);
+    if (SYSERR == (int)old)
+    {
+        rtptr->state = RT_FREE;
+        restore(im);
+        return SYSERR;
+    }
+    if (NULL != old)
+    {
+        old->state = RT_FREE;
+        old->nif = NULL;
+    }
     rtptr->state = RT_USED;
+    rtCacheFlush();
+    restore(im);
     return OK;
 }
@@ -32,10 +32,12 @@ syscall rtClear(struct netif *nif)
     {
         if ((RT_USED == rttab[i].state) && (nif == rttab[i].nif))
         {
+            rtTrieRemove(&rttab[i]);
             rttab[i].state = RT_FREE;
             rttab[i].nif = NULL;
         }
     }
+    rtCacheFlush();
     restore(im);
     return OK;
 }
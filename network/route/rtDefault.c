@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <interrupt.h>
 #include <network.h>
 #include <route.h>
 #include <stdlib.h>
@@ -22,6 +23,7 @@ syscall rtDefault(const struct netaddr *gate, struct netif *nif)
     struct rtEntry *rtptr;
     int i;
     struct netaddr mask;
+    irqmask im;
 
     /* Error check pointers */
     if ((NULL == gate) || (NULL == nif) || (gate->len > NET_MAX_ALEN))
@@ -64,7 +66,17 @@ syscall rtDefault(const struct netaddr *gate, struct netif *nif)
     /* Calculate mask length */
     rtptr->masklen = 0;
 
+    /* Make the route visible to lookups */
+    im = disable();
+    if (SYSERR == (int)rtTrieInsert(rtptr))
+    {
+        rtptr->state = RT_FREE;
+        restore(im);
+        return SYSERR;
+    }
     rtptr->state = RT_USED;
+    rtCacheFlush();
+    restore(im);
     RT_TRACE("Populated default route");
     return OK;
 }
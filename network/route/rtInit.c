@@ -12,6 +12,13 @@
 #include <thread.h>
 
 struct rtEntry rttab[RT_NENTRY];
+struct rtNode rtnodetab[RT_NNODE];
+struct rtNode *rtroot;
+struct rtNode *rtnodefree;
+struct rtCacheEntry rtcache[RT_NCACHE];
+ulong rtcachegen;
+ulong rtcachehits;
+ulong rtcachemisses;
 mailbox rtqueue;
 
 /**
@@ -31,6 +38,22 @@ syscall rtInit(void)
         rttab[i].state = RT_FREE;
     }
 
+    /* Initialize empty lookup trie; free nodes are linked by child[0] */
+    rtroot = NULL;
+    rtnodefree = NULL;
+    for (i = 0; i < RT_NNODE; i++)
+    {
+        bzero(&rtnodetab[i], sizeof(struct rtNode));
+        rtnodetab[i].child[0] = rtnodefree;
+        rtnodefree = &rtnodetab[i];
+    }
+
+    /* Initialize flow cache; generation 0 marks never filled entries */
+    bzero(rtcache, sizeof(rtcache));
+    rtcachegen = 1;
+    rtcachehits = 0;
+    rtcachemisses = 0;
+
     /* Initialize route queue */
     rtqueue = mailboxAlloc(RT_NQUEUE);
     if (SYSERR == rtqueue)
@@ -12,15 +12,15 @@
 /**
  * @ingroup route
  *
- * Looks up an entry in the routing table
+ * Looks up the route with the longest prefix matching an address.
  * @param addr the IP address that needs routing
  * @return a route table entry, NULL if none matches, SYSERR on error
  */
 struct rtEntry *rtLookup(const struct netaddr *addr)
 {
-    int i;
+    struct rtNode *node;
     struct rtEntry *rtptr;
-    struct netaddr masked;
+    uint key;
     irqmask im;
 
     rtptr = NULL;
@@ -28,29 +28,32 @@ struct rtEntry *rtLookup(const struct netaddr *addr)
     RT_TRACE("Addr = %d.%d.%d.%d", addr->addr[0], addr->addr[1],
              addr->addr[2], addr->addr[3]);
 
+    if (NETADDR_IPv4 != addr->type)
+    {
+        return NULL;
+    }
+    key = rtKey(addr->addr);
+
+    /* Walk down the trie, remembering the longest matching route */
     im = disable();
-    for (i = 0; i < RT_NENTRY; i++)
+    for (node = rtroot; NULL != node;
+         node = node->child[rtBit(key, node->len)])
     {
-        if (RT_USED == rttab[i].state)
+        if (0 != ((key ^ node->key) & rtMask(node->len)))
         {
-            /* Mask off address */
-            netaddrcpy(&masked, addr);
-            netaddrmask(&masked, &rttab[i].mask);
-
-            /* Check if match  */
-            if (netaddrequal(&masked, &rttab[i].dst))
-            {
-                RT_TRACE("Matched entry %d", i);
-                /* Remember match if no match so far or match is better */
-                if ((NULL == rtptr)
-                    || (rtptr->masklen < rttab[i].masklen))
-                {
-                    rtptr = &rttab[i];
-                }
-            }
+            break;
+        }
+        if (NULL != node->route)
+        {
+            rtptr = node->route;
+        }
+        if (RT_KEYLEN == node->len)
+        {
+            break;
         }
     }
     restore(im);
 
+    RT_TRACE("Matched entry %d", (NULL == rtptr) ? -1 : rtptr - rttab);
     return rtptr;
 }
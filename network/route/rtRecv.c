@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <interrupt.h>
 #include <mailbox.h>
+#include <mib.h>
 #include <network.h>
 #include <route.h>
 
@@ -29,6 +30,7 @@ syscall rtRecv(struct packet *pkt)
     {
         restore(im);
         RT_TRACE("Route queue full");
+        mib.ipv4.forwDiscards++;
         netFreebuf(pkt);
         return OK;
     }
@@ -38,10 +40,12 @@ syscall rtRecv(struct packet *pkt)
     {
         restore(im);
         RT_TRACE("Failed to enqueue packet");
+        mib.ipv4.forwDiscards++;
         netFreebuf(pkt);
         return SYSERR;
     }
 
+    mib.ipv4.forwDatagrams++;
     restore(im);
     RT_TRACE("Enqueued packet for routing");
     return OK;
@@ -33,10 +33,12 @@ syscall rtRemove(const struct netaddr *dst)
         if ((RT_USED == rttab[i].state)
             && netaddrequal(dst, &rttab[i].dst))
         {
+            rtTrieRemove(&rttab[i]);
             rttab[i].state = RT_FREE;
             rttab[i].nif = NULL;
         }
     }
+    rtCacheFlush();
     restore(im);
     return OK;
 }
@@ -5,6 +5,9 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <arp.h>
+#include <clock.h>
+#include <interrupt.h>
 #include <network.h>
 #include <route.h>
 #include <ipv4.h>
@@ -13,7 +16,10 @@
 /**
  * @ingroup route
  *
- * Attempt to route a packet.
+ * Attempt to route a packet.  The route and next-hop hardware address for
+ * each destination are kept in the flow cache, so a packet to a recently
+ * seen destination needs a single cache probe before it is handed to the
+ * driver.
  * @param pkt incoming packet to route
  * @return OK if packet is routed successfully, otherwise SYSERR
  */
@@ -23,6 +29,14 @@ syscall rtSend(struct packet *pkt)
     struct netaddr dst;
     struct rtEntry *route;
     struct netaddr *nxthop;
+    struct rtCacheEntry *cache;
+    struct arpEntry *entry;
+    struct netaddr hwaddr;
+    bool resolved;
+    ulong gen;
+    uint key;
+    irqmask im;
+    int result;
 
     /* Error check pointers */
     if (NULL == pkt)
@@ -35,7 +49,31 @@ syscall rtSend(struct packet *pkt)
     dst.len = IPv4_ADDR_LEN;
     memcpy(dst.addr, ip->dst, dst.len);
 
-    route = rtLookup(&dst);
+    /* Probe the flow cache */
+    key = rtKey(ip->dst);
+    cache = &rtcache[rtCacheHash(key)];
+    im = disable();
+    gen = rtcachegen;
+    if ((cache->gen == gen) && (cache->key == key)
+        && ((int)(clktime - cache->expires) < 0))
+    {
+        route = cache->route;
+        netaddrcpy(&hwaddr, &cache->hwaddr);
+        resolved = TRUE;
+        rtcachehits++;
+    }
+    else
+    {
+        route = NULL;
+        resolved = FALSE;
+        rtcachemisses++;
+    }
+    restore(im);
+
+    if (NULL == route)
+    {
+        route = rtLookup(&dst);
+    }
 
     if ((SYSERR == (ulong)route) || (NULL == (ulong)route))
     {
@@ -68,8 +106,11 @@ syscall rtSend(struct packet *pkt)
     ip->chksum = 0;
     ip->chksum = netChksum((uchar *)ip, IPv4_HDR_LEN);
 
-    /* Change packet to new network interface */
+    /* Change packet to new network interface; the outgoing link-level
+     * header is added in front of the IP header */
     pkt->nif = route->nif;
+    pkt->curr = pkt->nethdr;
+    pkt->len = net2hs(ip->len);
 
     /* Determine if packet should be send to destination or gateway */
     if (NULL == route->gateway.type)
@@ -81,7 +122,33 @@ syscall rtSend(struct packet *pkt)
         nxthop = &route->gateway;
     }
 
-    if (SYSERR == ipv4SendFrag(pkt, nxthop))
+    /* Resolve the next hop and remember it for this destination */
+    if (!resolved && !netaddrequal(&pkt->nif->ipbrc, nxthop)
+        && (OK == arpResolve(pkt->nif, nxthop, &hwaddr, NULL, 0)))
+    {
+        resolved = TRUE;
+        im = disable();
+        entry = arpGetEntry(nxthop);
+        if ((NULL != entry) && (ARP_RESOLVED == entry->state))
+        {
+            cache->gen = gen;
+            cache->key = key;
+            cache->expires = entry->expires;
+            cache->route = route;
+            netaddrcpy(&cache->hwaddr, &entry->hwaddr);
+        }
+        restore(im);
+    }
+
+    if (resolved && (pkt->len <= pkt->nif->mtu))
+    {
+        result = netSend(pkt, &hwaddr, NULL, ETHER_TYPE_IPv4);
+    }
+    else
+    {
+        result = ipv4SendFrag(pkt, nxthop);
+    }
+    if (SYSERR == result)
     {
         RT_TRACE("Routed packet: Host unreachable.");
         icmpDestUnreach(pkt, ICMP_HST_UNR);
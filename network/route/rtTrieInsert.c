@@ -0,0 +1,124 @@
+/**
+ * @file rtTrieInsert.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <route.h>
+
+static struct rtNode *rtNodeAlloc(uint, ushort, struct rtEntry *);
+
+/**
+ * @ingroup route
+ *
+ * Adds a route to the lookup trie, keyed by its destination and mask
+ * length.  A route already present for the same prefix is replaced.  Must
+ * be called with interrupts disabled.
+ * @param rtptr route table entry to add
+ * @return the route replaced, NULL if there was none, SYSERR if the trie
+ *         has no free nodes
+ */
+struct rtEntry *rtTrieInsert(struct rtEntry *rtptr)
+{
+    struct rtNode **link;
+    struct rtNode *node;
+    struct rtNode *leaf;
+    struct rtNode *glue;
+    struct rtEntry *old;
+    uint key, diff;
+    ushort len, common;
+
+    len = rtptr->masklen;
+    key = rtKey(rtptr->dst.addr) & rtMask(len);
+
+    link = &rtroot;
+    while (NULL != (node = *link))
+    {
+        common = (len < node->len) ? len : node->len;
+        diff = (key ^ node->key) & rtMask(common);
+
+        /* Prefixes diverge; join them under a node for their common part */
+        if (0 != diff)
+        {
+            common = 0;
+            while (0 == (diff & 0x80000000))
+            {
+                diff <<= 1;
+                common++;
+            }
+            leaf = rtNodeAlloc(key, len, rtptr);
+            if (NULL == leaf)
+            {
+                return (struct rtEntry *)SYSERR;
+            }
+            glue = rtNodeAlloc(key & rtMask(common), common, NULL);
+            if (NULL == glue)
+            {
+                leaf->child[0] = rtnodefree;
+                rtnodefree = leaf;
+                return (struct rtEntry *)SYSERR;
+            }
+            glue->child[rtBit(key, common)] = leaf;
+            glue->child[rtBit(node->key, common)] = node;
+            *link = glue;
+            return NULL;
+        }
+
+        /* New prefix is shorter; it goes above this node */
+        if (len < node->len)
+        {
+            leaf = rtNodeAlloc(key, len, rtptr);
+            if (NULL == leaf)
+            {
+                return (struct rtEntry *)SYSERR;
+            }
+            leaf->child[rtBit(node->key, len)] = node;
+            *link = leaf;
+            return NULL;
+        }
+
+        /* Same prefix; replace its route */
+        if (len == node->len)
+        {
+            old = node->route;
+            node->route = rtptr;
+            return old;
+        }
+
+        link = &node->child[rtBit(key, node->len)];
+    }
+
+    leaf = rtNodeAlloc(key, len, rtptr);
+    if (NULL == leaf)
+    {
+        return (struct rtEntry *)SYSERR;
+    }
+    *link = leaf;
+    return NULL;
+}
+
+/**
+ * Takes a node from the free list.
+ * @return initialized node, NULL if none are free
+ */
+static struct rtNode *rtNodeAlloc(uint key, ushort len,
+                                  struct rtEntry *rtptr)
+{
+    struct rtNode *node;
+
+    node = rtnodefree;
+    if (NULL == node)
+    {
+        RT_TRACE("No free trie node");
+        return NULL;
+    }
+    rtnodefree = node->child[0];
+
+    node->key = key;
+    node->len = len;
+    node->route = rtptr;
+    node->child[0] = NULL;
+    node->child[1] = NULL;
+    return node;
+}
@@ -0,0 +1,72 @@
+/**
+ * @file rtTrieRemove.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <route.h>
+
+static void rtTrieCompress(struct rtNode **);
+
+/**
+ * @ingroup route
+ *
+ * Removes a route from the lookup trie, merging away nodes that no longer
+ * branch.  Must be called with interrupts disabled.
+ * @param rtptr route table entry to remove
+ * @return OK if the route was in the trie, otherwise SYSERR
+ */
+syscall rtTrieRemove(struct rtEntry *rtptr)
+{
+    struct rtNode **link;
+    struct rtNode **parent;
+    struct rtNode *node;
+    uint key;
+    ushort len;
+
+    len = rtptr->masklen;
+    key = rtKey(rtptr->dst.addr) & rtMask(len);
+
+    parent = NULL;
+    link = &rtroot;
+    while ((NULL != (node = *link)) && (node->len < len))
+    {
+        parent = link;
+        link = &node->child[rtBit(key, node->len)];
+    }
+
+    if ((NULL == node) || (node->len != len) || (node->key != key)
+        || (node->route != rtptr))
+    {
+        return SYSERR;
+    }
+
+    node->route = NULL;
+    rtTrieCompress(link);
+    if (NULL != parent)
+    {
+        rtTrieCompress(parent);
+    }
+    return OK;
+}
+
+/**
+ * Frees the node at *link if it has no route and fewer than two children,
+ * moving its child (if any) up in its place.
+ */
+static void rtTrieCompress(struct rtNode **link)
+{
+    struct rtNode *node = *link;
+
+    if ((NULL != node->route)
+        || ((NULL != node->child[0]) && (NULL != node->child[1])))
+    {
+        return;
+    }
+
+    *link = (NULL != node->child[0]) ? node->child[0] : node->child[1];
+    node->child[0] = rtnodefree;
+    node->child[1] = NULL;
+    rtnodefree = node;
+}
@@ -4,8 +4,15 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <pcap.h>
+#include <platform.h>
 #include <snoop.h>
 
+static int snoopCaptureRing(struct snoop *, struct packet *);
+static void snoopStamp(struct snoop *, struct pcap_pkthdr *);
+
 /**
  * @ingroup snoop
  *
@@ -15,7 +22,9 @@
 int snoopCapture(struct snoop *cap, struct packet *pkt)
 {
     struct packet *buf;
-    int len;
+    uint len;
+    uint seglen;
+    uint i;
 
     /* Error check pointers */
     if ((NULL == cap) || (NULL == pkt))
@@ -38,6 +47,11 @@ int snoopCapture(struct snoop *cap, struct packet *pkt)
     /* Increment count of packets matching filter */
     cap->nmatch++;
 
+    if (NULL != cap->ring)
+    {
+        return snoopCaptureRing(cap, pkt);
+    }
+
     /* Try to get a buffer to put packet into */
     buf = netGetbuf();
     if (SYSERR == (int)buf)
@@ -49,13 +63,24 @@ int snoopCapture(struct snoop *cap, struct packet *pkt)
     /* Copy packet header into buffer */
     memcpy(buf, pkt, sizeof(struct packet));
 
-    /* Copy packet contents into buffer */
-    len = pkt->len;
+    /* Copy packet contents into buffer, gathering any payload segments */
+    len = netBuflen(pkt);
     if (len > cap->caplen)
     {
         len = cap->caplen;
     }
     memcpy(buf->data, pkt->curr, len);
+    for (i = 0; (i < pkt->nseg) && (len < cap->caplen); i++)
+    {
+        seglen = pkt->seg[i].len;
+        if (seglen > cap->caplen - len)
+        {
+            seglen = cap->caplen - len;
+        }
+        memcpy(buf->data + len, pkt->seg[i].data, seglen);
+        len += seglen;
+    }
+    buf->nseg = 0;
     buf->curr = buf->data;
 
     /* Queue packet */
@@ -75,3 +100,91 @@ int snoopCapture(struct snoop *cap, struct packet *pkt)
 
     return OK;
 }
+
+/**
+ * Copies a packet into the next free slot of the capture ring.  Nothing
+ * is allocated, so a full ring only drops packets.
+ */
+static int snoopCaptureRing(struct snoop *cap, struct packet *pkt)
+{
+    struct pcap_pkthdr *hdr;
+    uchar *data;
+    uint len;
+    uint seglen;
+    uint i;
+    irqmask im;
+
+    im = disable();
+    if (cap->rcount >= cap->nslot)
+    {
+        cap->novrn++;
+        restore(im);
+        SNOOP_TRACE("Capture ring full");
+        return SYSERR;
+    }
+    hdr = (struct pcap_pkthdr *)(cap->ring
+                                 + ((cap->rstart + cap->rcount) % cap->nslot)
+                                 * cap->slotlen);
+    data = (uchar *)(hdr + 1);
+
+    /* Copy packet contents into slot, gathering any payload segments */
+    len = netBuflen(pkt);
+    if (len > cap->snaplen)
+    {
+        len = cap->snaplen;
+    }
+    memcpy(data, pkt->curr, len);
+    for (i = 0; (i < pkt->nseg) && (len < cap->snaplen); i++)
+    {
+        seglen = pkt->seg[i].len;
+        if (seglen > cap->snaplen - len)
+        {
+            seglen = cap->snaplen - len;
+        }
+        memcpy(data + len, pkt->seg[i].data, seglen);
+        len += seglen;
+    }
+    hdr->caplen = len;
+    hdr->len = pkt->len;
+    snoopStamp(cap, hdr);
+
+    cap->rcount++;
+    restore(im);
+    signal(cap->rsema);
+
+    return OK;
+}
+
+/**
+ * Timestamps a record from clkcount(), carrying whole seconds of cycles
+ * into the seconds field.  If clkcount() may have wrapped since the last
+ * packet, the timestamp restarts from clktime.  Must be called with
+ * interrupts disabled.
+ */
+static void snoopStamp(struct snoop *cap, struct pcap_pkthdr *hdr)
+{
+    ulong now;
+    ulong cps;
+
+    now = clkcount();
+    cap->tscyc += now - cap->tslast;
+    cap->tslast = now;
+    while (cap->tscyc >= platform.clkfreq)
+    {
+        cap->tscyc -= platform.clkfreq;
+        cap->tssec++;
+    }
+    if ((long)(clktime - cap->tssec) > 1)
+    {
+        cap->tssec = clktime;
+        cap->tscyc = 0;
+    }
+
+    cps = platform.clkfreq / 1000000;
+    if (0 == cps)
+    {
+        cps = 1;
+    }
+    hdr->sec = cap->tssec;
+    hdr->usec = cap->tscyc / cps;
+}
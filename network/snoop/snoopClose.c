@@ -56,5 +56,11 @@ int snoopClose(struct snoop *cap)
         return SYSERR;
     }
 
+    /* Free capture ring */
+    if ((NULL != cap->ring) && (SYSERR == snoopRingFree(cap)))
+    {
+        return SYSERR;
+    }
+
     return OK;
 }
@@ -0,0 +1,86 @@
+/**
+ * @file snoopExport.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <device.h>
+#include <interrupt.h>
+#include <pcap.h>
+#include <snoop.h>
+
+/**
+ * @ingroup snoop
+ *
+ * Streams the ring of a capture as a PCAP file to a device, normally a UDP
+ * or TCP socket connected to a collector.  The file header is written
+ * first, then each record straight from its ring slot; the slot is only
+ * reused after the write returns.  Over UDP each record is one datagram.
+ * To stop the exporter between records, set cap->stop and signal
+ * cap->rsema.
+ * @param cap capture with a ring allocated by snoopRingAlloc()
+ * @param dev device to write to
+ * @param count number of packets to export, 0 for no limit
+ * @return OK after count packets or when stopped, SYSERR if a write fails
+ */
+thread snoopExport(struct snoop *cap, int dev, uint count)
+{
+    struct pcap_file_header pcap;
+    struct pcap_pkthdr *hdr;
+    bool forever = FALSE;
+    int len;
+    int result;
+    irqmask im;
+
+    if ((NULL == cap) || (NULL == cap->ring))
+    {
+        return SYSERR;
+    }
+    if (0 == count)
+    {
+        forever = TRUE;
+    }
+
+    pcap.magic = PCAP_MAGIC;
+    pcap.version_major = PCAP_VERSION_MAJOR;
+    pcap.version_minor = PCAP_VERSION_MINOR;
+    pcap.thiszone = 0;
+    pcap.sigfigs = 0;
+    pcap.snaplen = cap->snaplen;
+    pcap.linktype = PCAP_LINKTYPE_ETHERNET;
+    if (sizeof(pcap) != write(dev, &pcap, sizeof(pcap)))
+    {
+        SNOOP_TRACE("Failed to write file header");
+        return SYSERR;
+    }
+
+    while (forever || count > 0)
+    {
+        wait(cap->rsema);
+        if (cap->stop)
+        {
+            break;
+        }
+        hdr = (struct pcap_pkthdr *)(cap->ring
+                                     + cap->rstart * cap->slotlen);
+        len = sizeof(struct pcap_pkthdr) + hdr->caplen;
+        result = write(dev, hdr, len);
+
+        /* Release slot */
+        im = disable();
+        cap->rstart = (cap->rstart + 1) % cap->nslot;
+        cap->rcount--;
+        restore(im);
+
+        if (result != len)
+        {
+            SNOOP_TRACE("Failed to write record");
+            return SYSERR;
+        }
+        cap->nprint++;
+        count--;
+    }
+
+    return OK;
+}
@@ -5,6 +5,7 @@
 
 #include <stddef.h>
 #include <arp.h>
+#include <bpf.h>
 #include <ipv4.h>
 #include <network.h>
 #include <snoop.h>
@@ -22,6 +23,13 @@ bool snoopFilter(struct snoop *s, struct packet *pkt)
     struct arpPkt *arp = NULL;
     struct ipv4Pkt *ip = NULL;
 
+    /* A filter program is run over the headers in the packet buffer */
+    if (s->filter.bf_len > 0)
+    {
+        return (0 != bpfFilter(s->filter.bf_insns, pkt->curr, pkt->len,
+                               netBuflen(pkt)));
+    }
+
     /* Packet matches filter if there is no filter */
     if ((NULL == s->type)
         && (NULL == s->srcaddr.type) && (NULL == s->srcport)
@@ -0,0 +1,60 @@
+/**
+ * @file snoopRingAlloc.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <clock.h>
+#include <memory.h>
+#include <pcap.h>
+#include <snoop.h>
+
+/**
+ * @ingroup snoop
+ *
+ * Allocates a ring of fixed-size slots for a capture.  Each slot holds a
+ * PCAP record header followed by up to snaplen bytes of the packet.  Once
+ * a capture has a ring, snoopCapture() stores packets in it instead of
+ * queueing packet buffers, and snoopExport() streams it.  Must be called
+ * before snoopOpen().
+ * @param cap pointer to capture structure
+ * @param nslot number of slots in the ring
+ * @param snaplen bytes of each packet to keep
+ * @return OK if the ring was allocated, otherwise SYSERR
+ */
+syscall snoopRingAlloc(struct snoop *cap, uint nslot, uint snaplen)
+{
+    if ((NULL == cap) || (0 == nslot) || (0 == snaplen))
+    {
+        return SYSERR;
+    }
+
+    /* Keep record headers word aligned */
+    cap->slotlen = sizeof(struct pcap_pkthdr) + ((snaplen + 3) & ~3);
+    cap->ring = memget(nslot * cap->slotlen);
+    if (SYSERR == (int)cap->ring)
+    {
+        SNOOP_TRACE("Failed to allocate ring");
+        cap->ring = NULL;
+        return SYSERR;
+    }
+    cap->rsema = semcreate(0);
+    if (SYSERR == (int)cap->rsema)
+    {
+        SNOOP_TRACE("Failed to create ring semaphore");
+        memfree(cap->ring, nslot * cap->slotlen);
+        cap->ring = NULL;
+        return SYSERR;
+    }
+
+    cap->nslot = nslot;
+    cap->snaplen = snaplen;
+    cap->rstart = 0;
+    cap->rcount = 0;
+    cap->stop = FALSE;
+    cap->tssec = clktime;
+    cap->tscyc = 0;
+    cap->tslast = clkcount();
+    return OK;
+}
@@ -0,0 +1,31 @@
+/**
+ * @file snoopRingFree.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <memory.h>
+#include <snoop.h>
+
+/**
+ * @ingroup snoop
+ *
+ * Frees the ring of a capture.  The capture must be closed and no thread
+ * may be exporting the ring.
+ * @param cap pointer to capture structure
+ * @return OK if the ring was freed, otherwise SYSERR
+ */
+syscall snoopRingFree(struct snoop *cap)
+{
+    if ((NULL == cap) || (NULL == cap->ring))
+    {
+        return SYSERR;
+    }
+
+    semfree(cap->rsema);
+    memfree(cap->ring, cap->nslot * cap->slotlen);
+    cap->ring = NULL;
+    cap->rcount = 0;
+    return OK;
+}
@@ -5,8 +5,48 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <clock.h>
+#include <ctype.h>
+#include <device.h>
+#include <interrupt.h>
+#include <netemu.h>
+#include <network.h>
+#include <stdio.h>
 #include <stdlib.h>
-#include <date.h>
+#include <string.h>
+
+#if NETEMU
+#define NETEMU_MAXDELAY 60000   /**< longest delay or jitter, in ms     */
+
+static void netemuShow(struct netif *);
+static int netemuChance(const char *);
+
+static void usage(char *command)
+{
+    printf("Usage:\n");
+    printf("\t%s [--help]\n", command);
+    printf("\t%s <iface> off\n", command);
+    printf("\t%s <iface> [delay <ms>] [jitter <ms>] [uniform | normal]\n",
+           command);
+    printf("\t      [rate <kbit/s>] [burst <bytes>] [loss <pct>]\n");
+    printf("\t      [duplicate <pct>] [corrupt <pct>] [reorder <pct>]\n");
+    printf("Description:\n");
+    printf("\tEmulates a wide area link on the IPv4 packets received on\n");
+    printf("\tan interface.  Without arguments, shows the emulation and\n");
+    printf("\tits counters for every interface.  Settings not given are\n");
+    printf("\toff.  Percentages may have two decimal places.\n");
+    printf("Options:\n");
+    printf("\tdelay\tDelay every packet by <ms>.\n");
+    printf("\tjitter\tVary the delay by up to <ms>, from a uniform\n");
+    printf("\t\t(default) or normal distribution.\n");
+    printf("\trate\tLimit bandwidth with a token bucket of <bytes>,\n");
+    printf("\t\tby default 10 ms worth of traffic.\n");
+    printf("\tloss\tDrop <pct> of packets.\n");
+    printf("\tduplicate\tDeliver <pct> of packets twice.\n");
+    printf("\tcorrupt\tFlip a random bit in <pct> of packets.\n");
+    printf("\treorder\tSend <pct> of packets ahead of delayed ones.\n");
+    printf("\t--help\tdisplay this help and exit\n");
+}
 
 /**
  * @ingroup shell
@@ -18,7 +58,233 @@
  */
 shellcmd xsh_netemu(int nargs, char *args[])
 {
-    srand(getRdate("192.168.6.10"));
+    struct netif *netptr;
+    struct netemu set;
+    struct netemu *emu;
+    int descrp;
+    int value;
+    int a;
+    irqmask im;
+
+    /* Output help, if '--help' argument was supplied */
+    if (nargs == 2 && strcmp(args[1], "--help") == 0)
+    {
+        usage(args[0]);
+        return 0;
+    }
+
+    if (1 == nargs)
+    {
+#if NNETIF
+        for (a = 0; a < NNETIF; a++)
+        {
+            netemuShow(&netiftab[a]);
+        }
+#endif
+        return 0;
+    }
+
+    descrp = getdev(args[1]);
+    netptr = (SYSERR == descrp) ? NULL : netLookup(descrp);
+    if (NULL == netptr)
+    {
+        fprintf(stderr, "%s: %s is not a running interface\n", args[0],
+                args[1]);
+        return 1;
+    }
+    emu = &emutab[netptr - netiftab];
+
+    if ((3 == nargs) && (0 == strcmp(args[2], "off")))
+    {
+        emu->enabled = FALSE;
+        return 0;
+    }
+
+    /* Parse settings */
+    bzero(&set, sizeof(set));
+    set.dist = NETEMU_DIST_UNIFORM;
+    for (a = 2; a < nargs; a++)
+    {
+        if (0 == strcmp(args[a], "uniform"))
+        {
+            set.dist = NETEMU_DIST_UNIFORM;
+            continue;
+        }
+        if (0 == strcmp(args[a], "normal"))
+        {
+            set.dist = NETEMU_DIST_NORMAL;
+            continue;
+        }
+        if (a + 1 >= nargs)
+        {
+            fprintf(stderr, "%s: missing value for %s\n", args[0], args[a]);
+            return 1;
+        }
+
+        if ((0 == strcmp(args[a], "loss"))
+            || (0 == strcmp(args[a], "duplicate"))
+            || (0 == strcmp(args[a], "corrupt"))
+            || (0 == strcmp(args[a], "reorder")))
+        {
+            value = netemuChance(args[a + 1]);
+        }
+        else
+        {
+            value = isdigit(args[a + 1][0]) ? atoi(args[a + 1]) : -1;
+        }
+        if (value < 0)
+        {
+            fprintf(stderr, "%s: invalid value '%s' for %s\n", args[0],
+                    args[a + 1], args[a]);
+            return 1;
+        }
+
+        if (0 == strcmp(args[a], "delay") && value <= NETEMU_MAXDELAY)
+        {
+            set.delay = value;
+        }
+        else if (0 == strcmp(args[a], "jitter")
+                 && value <= NETEMU_MAXDELAY)
+        {
+            set.jitter = value;
+        }
+        else if (0 == strcmp(args[a], "rate") && value <= 1000000)
+        {
+            set.rate = value;
+        }
+        else if (0 == strcmp(args[a], "burst"))
+        {
+            set.burst = value;
+        }
+        else if (0 == strcmp(args[a], "loss"))
+        {
+            set.loss = value;
+        }
+        else if (0 == strcmp(args[a], "duplicate"))
+        {
+            set.duplicate = value;
+        }
+        else if (0 == strcmp(args[a], "corrupt"))
+        {
+            set.corrupt = value;
+        }
+        else if (0 == strcmp(args[a], "reorder"))
+        {
+            set.reorder = value;
+        }
+        else
+        {
+            fprintf(stderr, "%s: invalid setting '%s %s'\n", args[0],
+                    args[a], args[a + 1]);
+            return 1;
+        }
+        a++;
+    }
+
+    /* Default bucket holds 10 ms of traffic, and at least a full frame */
+    if ((0 != set.rate) && (0 == set.burst))
+    {
+        set.burst = set.rate * 10 / 8;
+    }
+    if ((0 != set.rate) && (set.burst < netptr->linkhdrlen + netptr->mtu))
+    {
+        set.burst = netptr->linkhdrlen + netptr->mtu;
+    }
+
+    if (SYSERR == emuStart())
+    {
+        fprintf(stderr, "%s: failed to start emulator\n", args[0]);
+        return 1;
+    }
+    srand(clkcount());
+
+    /* Replace settings; counters are kept */
+    im = disable();
+    emu->delay = set.delay;
+    emu->jitter = set.jitter;
+    emu->dist = set.dist;
+    emu->rate = set.rate;
+    emu->burst = set.burst;
+    emu->loss = set.loss;
+    emu->duplicate = set.duplicate;
+    emu->corrupt = set.corrupt;
+    emu->reorder = set.reorder;
+    emu->tokens = set.burst;
+    emu->tlast = emuNow();
+    emu->enabled = TRUE;
+    restore(im);
+
     return 0;
+}
+
+static void netemuShow(struct netif *netptr)
+{
+    struct netemu *emu;
+
+    /* Skip interface if not allocated */
+    if ((NULL == netptr) || (netptr->state != NET_ALLOC))
+    {
+        return;
+    }
+    emu = &emutab[netptr - netiftab];
+
+    printf("%s: %s\n", devtab[netptr->dev].name,
+           emu->enabled ? "emulating" : "off");
+    printf("\tDelay: %u ms +/- %u ms %s\n", emu->delay, emu->jitter,
+           (NETEMU_DIST_NORMAL == emu->dist) ? "normal" : "uniform");
+    printf("\tRate: %u kbit/s   Burst: %u bytes\n", emu->rate,
+           emu->burst);
+    printf("\tLoss: %u.%02u%%   Duplicate: %u.%02u%%   "
+           "Corrupt: %u.%02u%%   Reorder: %u.%02u%%\n",
+           emu->loss / 100, emu->loss % 100,
+           emu->duplicate / 100, emu->duplicate % 100,
+           emu->corrupt / 100, emu->corrupt % 100,
+           emu->reorder / 100, emu->reorder % 100);
+    printf("\tIn: %u   Out: %u   Lost: %u   Duplicated: %u\n",
+           emu->nin, emu->nout, emu->nloss, emu->ndup);
+    printf("\tCorrupted: %u   Reordered: %u   Queue Drops: %u\n",
+           emu->ncorrupt, emu->nreorder, emu->nqdrop);
+}
+
+/**
+ * Parses a percentage with up to two decimal places.
+ * @return chance out of ::NETEMU_CHANCE, -1 if invalid
+ */
+static int netemuChance(const char *str)
+{
+    int value = 0;
+    int frac = 0;
+    int scale = 10;
 
+    if (!isdigit(*str))
+    {
+        return -1;
+    }
+    while (isdigit(*str))
+    {
+        value = value * 10 + (*str++ - '0');
+        if (value > 100)
+        {
+            return -1;
+        }
+    }
+    if ('.' == *str)
+    {
+        str++;
+        while (isdigit(*str) && (scale > 0))
+        {
+            frac += scale * (*str++ - '0');
+            scale /= 10;
+        }
+    }
+    if ('%' == *str)
+    {
+        str++;
+    }
+    if (('\0' != *str) || (value * 100 + frac > NETEMU_CHANCE))
+    {
+        return -1;
+    }
+    return value * 100 + frac;
 }
+#endif /* NETEMU */
@@ -5,12 +5,21 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <ctype.h>
+#include <device.h>
+#include <ipv4.h>
+#include <mib.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <network.h>
+#include <thread.h>
 
 #if NETHER
 static void netStat(struct netif *);
+static void netStatMib(void);
+static shellcmd netStatExport(int, char *[]);
+static shellcmd netStatWorkers(int, char *[]);
 
 /**
  * @ingroup shell
@@ -28,14 +37,40 @@ shellcmd xsh_netstat(int nargs, char *args[])
     /* Output help, if '--help' argument was supplied */
     if (nargs == 2 && strcmp(args[1], "--help") == 0)
     {
-        printf("Usage: %s\n\n", args[0]);
+        printf("Usage: %s [-s | -z | -w <device> <count> |\n", args[0]);
+        printf("\t-x <host> <port> [<seconds>]]\n\n");
         printf("Description:\n");
         printf("\tDisplays Network Information\n");
         printf("Options:\n");
+        printf("\t-s\tdisplay protocol statistics\n");
+        printf("\t-z\treset all statistics\n");
+        printf("\t-w\tset the number of receive workers of a network\n");
+        printf("\t\tinterface, at most %d\n", NET_NTHR);
+        printf("\t-x\tsend a binary statistics snapshot to a UDP port,\n");
+        printf("\t\tevery <seconds> if given\n");
         printf("\t--help\tdisplay this help and exit\n");
         return OK;
     }
 
+    if (nargs == 2 && strcmp(args[1], "-s") == 0)
+    {
+        netStatMib();
+        return OK;
+    }
+    if (nargs == 2 && strcmp(args[1], "-z") == 0)
+    {
+        mibReset();
+        return OK;
+    }
+    if (nargs >= 2 && strcmp(args[1], "-x") == 0)
+    {
+        return netStatExport(nargs, args);
+    }
+    if (nargs >= 2 && strcmp(args[1], "-w") == 0)
+    {
+        return netStatWorkers(nargs, args);
+    }
+
     /* Check for correct number of arguments */
     if (nargs > 1)
     {
@@ -70,6 +105,7 @@ static void netStat(struct netif *netptr)
     device *pdev;
     char strA[20];
     char strB[20];
+    uint i;
 
     /* Skip interface if not allocated */
     if ((NULL == netptr) || (netptr->state != NET_ALLOC))
@@ -96,7 +132,154 @@ static void netStat(struct netif *netptr)
            netptr->linkhdrlen);
     printf("\t");
     printf("Num Rcv: %-15d   Num Proc: %d\n", netptr->nin, netptr->nproc);
+    printf("\t");
+    printf("Num Drop: %-14d   Num Sent: %d\n", netptr->ndrop, netptr->nout);
+    for (i = 0; i < netptr->nworker; i++)
+    {
+        printf("\t");
+        printf("Worker %u Proc: %-10u   Dropped: %u\n", i,
+               netptr->worker[i].nproc, netptr->worker[i].ndrop);
+    }
 
     return;
 }
+
+/* Prints one counter, "netstat -s" style */
+#define netStatCtr(group, name) \
+    printf("\t%-16s %u\n", #name, mib.group.name)
+
+static void netStatMib(void)
+{
+    printf("Net:\n");
+    netStatCtr(net, inRunts);
+    netStatCtr(net, inNotOurs);
+    netStatCtr(net, inUnknownTypes);
+    netStatCtr(net, inQueueDrops);
+    netStatCtr(net, noBufs);
+
+    printf("IPv4:\n");
+    netStatCtr(ipv4, inReceives);
+    netStatCtr(ipv4, inHdrErrors);
+    netStatCtr(ipv4, inUnknownProtos);
+    netStatCtr(ipv4, inDiscards);
+    netStatCtr(ipv4, inDelivers);
+    netStatCtr(ipv4, forwDatagrams);
+    netStatCtr(ipv4, forwDiscards);
+    netStatCtr(ipv4, outRequests);
+    netStatCtr(ipv4, outNoRoutes);
+    netStatCtr(ipv4, reasmReqds);
+    netStatCtr(ipv4, reasmOKs);
+    netStatCtr(ipv4, reasmFails);
+    netStatCtr(ipv4, reasmTimeouts);
+    netStatCtr(ipv4, fragOKs);
+    netStatCtr(ipv4, fragFails);
+    netStatCtr(ipv4, fragCreates);
+
+    printf("ICMP:\n");
+    netStatCtr(icmp, inMsgs);
+    netStatCtr(icmp, inErrors);
+    netStatCtr(icmp, inEchos);
+    netStatCtr(icmp, inEchoReps);
+    netStatCtr(icmp, inDestUnreachs);
+    netStatCtr(icmp, inTimeExcds);
+    netStatCtr(icmp, outMsgs);
+    netStatCtr(icmp, outErrors);
+    netStatCtr(icmp, outEchos);
+    netStatCtr(icmp, outEchoReps);
+    netStatCtr(icmp, outDestUnreachs);
+    netStatCtr(icmp, outTimeExcds);
+    netStatCtr(icmp, outRedirects);
+
+    printf("UDP:\n");
+    netStatCtr(udp, inDatagrams);
+    netStatCtr(udp, noPorts);
+    netStatCtr(udp, inErrors);
+    netStatCtr(udp, inCsumErrors);
+    netStatCtr(udp, rcvbufErrors);
+    netStatCtr(udp, outDatagrams);
+
+    printf("TCP:\n");
+    netStatCtr(tcp, activeOpens);
+    netStatCtr(tcp, passiveOpens);
+    netStatCtr(tcp, inSegs);
+    netStatCtr(tcp, inErrs);
+    netStatCtr(tcp, noPorts);
+    netStatCtr(tcp, outSegs);
+    netStatCtr(tcp, retransSegs);
+    netStatCtr(tcp, outRsts);
+
+    printf("ARP:\n");
+    netStatCtr(arp, inRequests);
+    netStatCtr(arp, inReplies);
+    netStatCtr(arp, inErrors);
+    netStatCtr(arp, outRequests);
+    netStatCtr(arp, outReplies);
+    netStatCtr(arp, pendingDrops);
+}
+
+/* netstat -x <host> <port> [<seconds>] */
+static shellcmd netStatExport(int nargs, char *args[])
+{
+    struct netaddr host;
+    ushort port;
+    uint period = 0;
+
+    if ((nargs < 4) || (nargs > 5) || !isdigit(args[3][0])
+        || (SYSERR == dot2ipv4(args[2], &host)))
+    {
+        fprintf(stderr, "Usage: %s -x <host> <port> [<seconds>]\n",
+                args[0]);
+        return SYSERR;
+    }
+    port = atoi(args[3]);
+    if (5 == nargs)
+    {
+        period = atoi(args[4]);
+    }
+
+    do
+    {
+        if (SYSERR == mibSend(&host, port))
+        {
+            fprintf(stderr, "%s: failed to send statistics\n", args[0]);
+            return SYSERR;
+        }
+        if (period > 0)
+        {
+            sleep(period * 1000);
+        }
+    }
+    while (period > 0);
+
+    return OK;
+}
+
+/* netstat -w <device> <count> */
+static shellcmd netStatWorkers(int nargs, char *args[])
+{
+    struct netif *netptr;
+    int descrp;
+
+    if ((nargs != 4) || !isdigit(args[3][0]))
+    {
+        fprintf(stderr, "Usage: %s -w <device> <count>\n", args[0]);
+        return SYSERR;
+    }
+    descrp = getdev(args[2]);
+    netptr = (SYSERR == descrp) ? NULL : netLookup(descrp);
+    if (NULL == netptr)
+    {
+        fprintf(stderr, "%s: %s is not a running network interface\n",
+                args[0], args[2]);
+        return SYSERR;
+    }
+    if (SYSERR == netRecvWorkers(netptr, atoi(args[3])))
+    {
+        fprintf(stderr, "%s: failed to start %s receive workers\n",
+                args[0], args[3]);
+        return SYSERR;
+    }
+
+    return OK;
+}
 #endif /* NETHER */
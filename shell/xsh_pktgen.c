@@ -7,14 +7,19 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <shell.h>
 
 #include <clock.h>
+#include <date.h>
 #include <ether.h>
 #include <device.h>
+#include <interrupt.h>
+#include <platform.h>
 
 #include <ethernet.h>
 #include <ipv4.h>
+#include <network.h>
 #include <udp.h>
 
 #if NETHER
@@ -25,8 +30,29 @@
 #define DEF_SRCIP "192.168.1.254"
 #define DEF_DSTPT 1
 #define DEF_SRCPT 65535
-#define DEF_MINLEN 60
+#define DEF_MINLEN 64
 #define DEF_MAXLEN 1518
+#define DEF_BURST 1
+#define DEF_THREADS 1
+
+/* pktgen limits */
+#define PKTGEN_MAXTHR   8       /**< generator threads and sink streams */
+#define PKTGEN_MAXBURST 256     /**< packets sent back to back          */
+#define PKTGEN_STK      8192    /**< generator thread stack size        */
+#define PKTGEN_MAGIC    0x50475831      /**< "PGX1" marks pktgen payloads */
+
+/** Header at the start of every generated UDP payload */
+struct pktgen_hdr
+{
+    uint magic;                 /**< ::PKTGEN_MAGIC                     */
+    uint stream;                /**< generator thread that sent it      */
+    uint seq;                   /**< per stream sequence number         */
+    uint sec;                   /**< send time, seconds                 */
+    uint usec;                  /**< send time, microseconds            */
+};
+
+#define PKTGEN_MINLEN (ETH_HDR_LEN + IPv4_HDR_LEN + UDP_HDR_LEN \
+                       + sizeof(struct pktgen_hdr))
 
 /* structure with pktgen request and tracking values */
 struct pktgen_info
@@ -46,45 +72,99 @@ struct pktgen_info
     /* other */
     uint minsize;
     uint maxsize;
-    uint pktcount;
-    uint interval;
+    uint pktcount;              /* per generator thread */
+    uint interval;              /* ms between bursts, if gap is 0 */
+    ulong gap;                  /* clock cycles between bursts */
+    uint burst;
+};
+
+/* state of one generator thread */
+struct pktgen_thr
+{
+    struct pktgen_info *info;
+    uint stream;
+    tid_typ tid;
 
     /* stats */
-    uint start;
-    uint stop;
+    ulong start;
+    ulong stop;
     uint tries;
     uint errors;
+    uint bytes;
+};
+
+/* receive-side statistics of one stream */
+struct pktsink_stream
+{
+    uint nrecv;
+    uint next;                  /* one past the highest seq seen */
+    uint nreorder;
+};
+
+/* structure with pktsink state and statistics */
+struct pktsink_info
+{
+    int dev_id;
+    uint nbad;
+    struct pktsink_stream stream[PKTGEN_MAXTHR];
+
+    /* one-way latency in microseconds */
+    uint nlat;
+    long latmin;
+    long latmax;
+    long latavg;
 };
 
-thread pktgen(struct pktgen_info *);
+thread pktgen(struct pktgen_thr *);
+thread pktsink(struct pktsink_info *);
+static int pktgenSink(char *, char *, ushort);
+static void pktgenStamp(uint *, uint *);
+static ulong pktgenMsec(void);
 
 static void usage(char *prog)
 {
     printf("usage: %s [options] <iface> <dst-mac>\n", prog);
+    printf("       %s -s [-p <port>] <iface>\n", prog);
     printf("\t<iface>        interface to send packets on\n");
     printf("\t<dst-mac>      MAC address to send packets to\n");
     printf("\n");
     printf("options (and their [defaults]):\n");
-    printf("\t-c <count>     number of packets to send [%d]\n",
+    printf("\t-c <count>     number of packets per thread [%d]\n",
            DEF_COUNT);
-    printf("\t-i <interval>  milliseconds between packet sends [%d]\n",
+    printf("\t-i <interval>  milliseconds between bursts [%d]\n",
            DEF_INTERVAL);
+    printf("\t-r <pps>       total packets per second, overrides -i\n");
+    printf("\t-b <kbit/s>    total bandwidth, overrides -i and -r\n");
+    printf("\t-B <burst>     packets sent back to back [%d]\n", DEF_BURST);
+    printf("\t-t <threads>   generator threads, up to %d [%d]\n",
+           PKTGEN_MAXTHR, DEF_THREADS);
     printf("\t-h <dst-ip>    destination IP for header [%s]\n",
            DEF_DSTIP);
     printf("\t-H <src-ip>    source IP for header [%s]\n", DEF_SRCIP);
     printf("\t-p <dst-port>  destination port for header [%d]\n",
            DEF_DSTPT);
-    printf("\t-P <src-port>  source port for header [%d]\n", DEF_SRCPT);
+    printf("\t-P <src-port>  source port of the first thread [%d]\n",
+           DEF_SRCPT);
     printf("\t-l <min-length> minimum packet size [%d]\n", DEF_MINLEN);
     printf("\t-L <max-length> maximum packet size [%d]\n", DEF_MAXLEN);
+    printf("\t-s             count packets received on <port> instead\n");
+    printf("\n");
+    printf("Each thread sends its own stream from its own source port,\n");
+    printf("cycling lengths from min to max.  Payloads carry a stream,\n");
+    printf("sequence number and send time that the sink uses to count\n");
+    printf("loss, reordering and one-way latency.  Latency is only\n");
+    printf("meaningful when both clocks are synchronized, e.g. by rdate.\n");
 }
 
 /**
  * @ingroup shell
  *
  * pktgen lets a "user" start up a slightly parameterized packet generator
- * from the shell.  In theory it should be able to saturuate the full 100
- * Mbps, in reality it probably doesn't but it'll try its best.
+ * from the shell.  Every generator thread builds its frame once and then
+ * only patches lengths, sequence numbers, timestamps and the IP checksum
+ * before writing the frame straight to the device, paced to a target
+ * packet or bit rate.  With -s, pktgen instead counts the packets another
+ * pktgen sends to this host.
  * @param nargs number of arguments
  * @param args  array of arguments
  * @return non-zero value on error
@@ -92,13 +172,16 @@ static void usage(char *prog)
 shellcmd xsh_pktgen(int nargs, char *args[])
 {
     int arg;
-    tid_typ tid;
     struct pktgen_info info;
-    uint count, interval;
+    struct pktgen_thr thr[PKTGEN_MAXTHR];
+    uint count, interval, rate, kbps, burst, nthr;
     char *prog = args[0];
     char *dstip, *srcip;
     ushort dstpt, srcpt;
     uint minlen, maxlen;
+    bool sink;
+    uint tries, errors, bytes, i;
+    ulong start, stop, msec;
 
     /* defaults */
     interval = DEF_INTERVAL;
@@ -109,11 +192,17 @@ shellcmd xsh_pktgen(int nargs, char *args[])
     srcpt = DEF_SRCPT;
     minlen = DEF_MINLEN;
     maxlen = DEF_MAXLEN;
+    burst = DEF_BURST;
+    nthr = DEF_THREADS;
+    rate = 0;
+    kbps = 0;
+    sink = FALSE;
 
     /* parse args */
     struct getopt opts;
     opts.optreset = TRUE;
-    while ((arg = getopt(nargs, args, "c:i:h:H:p:P:l:L:", &opts)) != -1)
+    while ((arg =
+            getopt(nargs, args, "c:i:r:b:B:t:h:H:p:P:l:L:s", &opts)) != -1)
     {
         switch (arg)
         {
@@ -123,6 +212,18 @@ shellcmd xsh_pktgen(int nargs, char *args[])
         case 'i':
             interval = atoi(opts.optarg);
             break;
+        case 'r':
+            rate = atoi(opts.optarg);
+            break;
+        case 'b':
+            kbps = atoi(opts.optarg);
+            break;
+        case 'B':
+            burst = atoi(opts.optarg);
+            break;
+        case 't':
+            nthr = atoi(opts.optarg);
+            break;
         case 'h':
             dstip = opts.optarg;
             break;
@@ -141,6 +242,9 @@ shellcmd xsh_pktgen(int nargs, char *args[])
         case 'L':
             maxlen = atoi(opts.optarg);
             break;
+        case 's':
+            sink = TRUE;
+            break;
         default:
             usage(prog);
             return 1;
@@ -149,6 +253,16 @@ shellcmd xsh_pktgen(int nargs, char *args[])
     nargs -= opts.optind;
     args += opts.optind;
 
+    if (sink)
+    {
+        if (1 != nargs)
+        {
+            usage(prog);
+            return 1;
+        }
+        return pktgenSink(prog, args[0], dstpt);
+    }
+
     /* grab the mac addr */
     if (2 != nargs)
     {
@@ -156,8 +270,34 @@ shellcmd xsh_pktgen(int nargs, char *args[])
         return 1;
     }
 
+    /* check the args */
+    if ((minlen < PKTGEN_MINLEN) || (maxlen > DEF_MAXLEN)
+        || (minlen > maxlen))
+    {
+        fprintf(stderr, "%s: lengths must be within %d and %d\n", prog,
+                PKTGEN_MINLEN, DEF_MAXLEN);
+        return 1;
+    }
+    if ((nthr < 1) || (nthr > PKTGEN_MAXTHR)
+        || (burst < 1) || (burst > PKTGEN_MAXBURST))
+    {
+        usage(prog);
+        return 1;
+    }
+    if (srcpt + nthr - 1 > 0xFFFF)
+    {
+        fprintf(stderr, "%s: %u threads need source ports %u and up\n",
+                prog, nthr, srcpt);
+        return 1;
+    }
+
     /* prep the args */
     info.dev_id = getdev(args[0]);
+    if (SYSERR == info.dev_id)
+    {
+        fprintf(stderr, "%s: %s is not a device\n", prog, args[0]);
+        return 1;
+    }
     colon2mac(args[1], info.dstmac);
 
     dot2ipv4(dstip, &info.dstip);
@@ -169,112 +309,376 @@ shellcmd xsh_pktgen(int nargs, char *args[])
     info.maxsize = maxlen;
     info.pktcount = count;
     info.interval = interval;
+    info.burst = burst;
+    info.gap = 0;
 
-    /* spawn proper pktgen thread */
-    tid = create(pktgen, INITSTK, INITPRIO, "pktgen", 1, &info);
-    ready(tid, RESCHED_NO);
+    /* bandwidth becomes a packet rate over the average length */
+    if (0 != kbps)
+    {
+        rate = kbps * 125 / ((minlen + maxlen) / 2);
+        if (0 == rate)
+        {
+            rate = 1;
+        }
+    }
+
+    /* split the rate over the threads, in clock cycles between bursts */
+    if (0 != rate)
+    {
+        rate = (rate + nthr - 1) / nthr;
+        if (rate > burst)
+        {
+            info.gap = platform.clkfreq / rate * burst;
+        }
+        else
+        {
+            info.interval = 1000 * burst / rate;
+        }
+    }
+
+    /* spawn pktgen threads, one stream each */
+    for (i = 0; i < nthr; i++)
+    {
+        bzero(&thr[i], sizeof(thr[i]));
+        thr[i].info = &info;
+        thr[i].stream = i;
+        thr[i].tid = create(pktgen, PKTGEN_STK, INITPRIO, "pktgen", 1,
+                            &thr[i]);
+    }
+    for (i = 0; i < nthr; i++)
+    {
+        if (!isbadtid(thr[i].tid))
+        {
+            ready(thr[i].tid, RESCHED_NO);
+        }
+    }
 
     /* listen for keypress to force stop */
     printf("Press enter/return to stop.\n");
     getchar();
-    kill(tid);
 
-    if (0 == info.stop)
+    tries = errors = bytes = 0;
+    start = stop = 0;
+    for (i = 0; i < nthr; i++)
     {
-        info.stop = clktime;
+        if (isbadtid(thr[i].tid))
+        {
+            continue;
+        }
+        kill(thr[i].tid);
+        if (0 == thr[i].stop)
+        {
+            thr[i].stop = pktgenMsec();
+        }
+        if ((0 == start) || ((long)(thr[i].start - start) < 0))
+        {
+            start = thr[i].start;
+        }
+        if ((long)(thr[i].stop - stop) > 0)
+        {
+            stop = thr[i].stop;
+        }
+        tries += thr[i].tries;
+        errors += thr[i].errors;
+        bytes += thr[i].bytes;
     }
+    msec = (stop - start) ? (stop - start) : 1;
 
     /* print some stats about what we just did */
-    printf("Tried to send %d packets (%d errors) over %d seconds.\n",
-           info.tries, info.errors, info.stop - info.start);
+    printf("Tried to send %u packets (%u errors) over %lu.%03lu seconds.\n",
+           tries, errors, msec / 1000, msec % 1000);
+    tries -= errors;
+    printf("%lu pps, %lu kbit/s\n",
+           tries / msec * 1000 + (tries % msec) * 1000 / msec,
+           bytes / msec * 8 + (bytes % msec) * 8 / msec);
 
     return 0;
 }
 
-thread pktgen(struct pktgen_info *info)
+/**
+ * Generator thread.  Builds the largest frame once, then for every packet
+ * patches only the lengths, IP identification and checksum, and the
+ * payload sequence number and timestamp.  The UDP checksum is left zero,
+ * which means "no checksum" and keeps the per-packet cost independent of
+ * length.
+ */
+thread pktgen(struct pktgen_thr *thr)
 {
-    struct packet *pkt;
+    struct pktgen_info *info = thr->info;
+    uint frame[(DEF_MAXLEN + 3) / 4];
     uchar *data;
     struct etherPkt *ethhdr;
     struct ipv4Pkt *iphdr;
     struct udpPkt *udphdr;
+    struct pktgen_hdr *hdr;
+    uint len, span, n, sec, usec;
+    ulong next, cycms;
+    long wait;
+
+    /* Ethernet */
+    bzero(frame, sizeof(frame));
+    data = (uchar *)frame;
+    ethhdr = (struct etherPkt *)data;
+    memcpy(ethhdr->dst, info->dstmac, ETH_ADDR_LEN);
+    control(info->dev_id, ETH_CTRL_GET_MAC, (long)ethhdr->src, NULL);
+    ethhdr->type = hs2net(ETHER_TYPE_IPv4);
+    data += ETH_HDR_LEN;
+
+    /* IP */
+    iphdr = (struct ipv4Pkt *)data;
+    iphdr->ver_ihl = (IPv4_VERSION << 4) | (IPv4_HDR_LEN >> 2);
+    iphdr->tos = IPv4_TOS_ROUTINE;
+    iphdr->flags_froff = 0;
+    iphdr->ttl = IPv4_TTL;
+    iphdr->proto = info->l3_proto;
+    memcpy(iphdr->src, info->srcip.addr, IPv4_ADDR_LEN);
+    memcpy(iphdr->dst, info->dstip.addr, IPv4_ADDR_LEN);
+    data += IPv4_HDR_LEN;
+
+    /* UDP, one source port per stream */
+    udphdr = (struct udpPkt *)data;
+    udphdr->srcPort = hs2net(info->srcpt + thr->stream);
+    udphdr->dstPort = hs2net(info->dstpt);
+    udphdr->chksum = 0;
+    data += UDP_HDR_LEN;
+
+    /* pktgen header, fields read by the sink */
+    hdr = (struct pktgen_hdr *)data;
+    hdr->magic = hl2net(PKTGEN_MAGIC);
+    hdr->stream = hl2net(thr->stream);
+
+    span = info->maxsize - info->minsize + 1;
+    cycms = platform.clkfreq / 1000;
 
     /* start the clock */
-    info->start = clktime;
-    info->stop = 0;
-    info->tries = 0;
-    info->errors = 0;
+    thr->start = pktgenMsec();
+    next = clkcount();
 
-    while (info->pktcount == 0 || info->tries < info->pktcount)
+    while (info->pktcount == 0 || thr->tries < info->pktcount)
     {
-        /* update the counter */
-        info->tries += 1;
+        for (n = 0; n < info->burst
+             && (info->pktcount == 0 || thr->tries < info->pktcount); n++)
+        {
+            /* patch the template */
+            len = info->minsize + (thr->tries % span);
+            iphdr->len = hs2net(len - ETH_HDR_LEN);
+            iphdr->id = hs2net(thr->tries);
+            iphdr->chksum = 0;
+            iphdr->chksum = netChksum(iphdr, IPv4_HDR_LEN);
+            udphdr->len = hs2net(len - ETH_HDR_LEN - IPv4_HDR_LEN);
+            hdr->seq = hl2net(thr->tries);
+            pktgenStamp(&sec, &usec);
+            hdr->sec = hl2net(sec);
+            hdr->usec = hl2net(usec);
+            thr->tries += 1;
+
+            /* send the packet -- don't care about routing, right to the ether! */
+            if (SYSERR == write(info->dev_id, frame, len))
+            {
+                /* count the errors */
+                thr->errors += 1;
+            }
+            else
+            {
+                thr->bytes += len;
+            }
+        }
 
-        /* prepare the packet */
-        pkt = netGetbuf();
-        if (SYSERR == (int)pkt)
+        if (0 == info->gap)
         {
-            info->errors += 1;
+            sleep(info->interval);
             continue;
         }
 
-        /* take some liberties with headers (ETH, IP, UDP) */
-        pkt->len =
-            info->minsize +
-            ((info->tries - 1) % (info->maxsize - info->minsize));
-        pkt->curr -= (pkt->len + 03) & ~03;
-
-        /* push on headers one-by-one */
-        data = pkt->curr;
-
-        /* Ethernet */
-        ethhdr = (struct etherPkt *)data;
-        memcpy(ethhdr->dst, info->dstmac, ETH_ADDR_LEN);
-        control(info->dev_id, ETH_CTRL_GET_MAC, (long)ethhdr->src, NULL);
-        ethhdr->type = ETHER_TYPE_IPv4;
-        data += sizeof(*ethhdr);
-
-        /* IP */
-        iphdr = (struct ipv4Pkt *)data;
-        // this looks magic, it is not.
-        iphdr->ver_ihl = (IPv4_VERSION << 4) | (sizeof(*iphdr) >> 2);;
-        iphdr->tos = IPv4_TOS_ROUTINE;
-        iphdr->len = hs2net(pkt->len - sizeof(*ethhdr));
-        iphdr->id = 0;
-        iphdr->flags_froff = 0;
-        iphdr->ttl = IPv4_TTL;
-        iphdr->proto = info->l3_proto;
-        iphdr->chksum = 0;
-        memcpy(iphdr->src, info->srcip.addr, IPv4_ADDR_LEN);
-        memcpy(iphdr->dst, info->dstip.addr, IPv4_ADDR_LEN);
-        iphdr->chksum = netChksum(iphdr, IPv4_HDR_LEN);
-        data += sizeof(*iphdr);
-
-        if (IPv4_PROTO_UDP == info->l3_proto)
+        /* pace bursts; a generator that falls behind does not catch up */
+        next += info->gap;
+        wait = (long)(next - clkcount());
+        if (wait < -(long)info->gap)
         {
-            /* UDP */
-            udphdr = (struct udpPkt *)data;
-            udphdr->srcPort = hs2net(info->srcpt);
-            udphdr->dstPort = hs2net(info->dstpt);
-            udphdr->len =
-                hs2net(pkt->len - sizeof(*ethhdr) - sizeof(*iphdr));
-            udphdr->chksum = 0;
-            data += sizeof(*udphdr);
+            next = clkcount();
+            continue;
         }
-
-        /* send the packet -- don't care about routing, right to the ether! */
-        if (SYSERR == write(info->dev_id, pkt->curr, pkt->len))
+        if (wait > (long)(2 * cycms))
         {
-            /* count the errors */
-            info->errors += 1;
+            sleep(wait / cycms - 1);
+        }
+        while ((long)(next - clkcount()) > 0)
+        {
+            yield();
         }
-        netFreebuf(pkt);
-        sleep(info->interval);
     }
 
     /* stop the clock */
-    info->stop = clktime;
+    thr->stop = pktgenMsec();
+
+    return 0;
+}
+
+/**
+ * Runs the receive side: counts pktgen packets arriving on a UDP port
+ * until the user presses enter, then prints per stream statistics.
+ */
+static int pktgenSink(char *prog, char *iface, ushort port)
+{
+    struct pktsink_info sink;
+    struct pktsink_stream *st;
+    struct netif *netptr;
+    int descrp;
+    tid_typ tid;
+    uint i, lost;
+
+    descrp = getdev(iface);
+    netptr = (SYSERR == descrp) ? NULL : netLookup(descrp);
+    if (NULL == netptr)
+    {
+        fprintf(stderr, "%s: %s is not a running interface\n", prog, iface);
+        return 1;
+    }
+
+    bzero(&sink, sizeof(sink));
+    sink.dev_id = udpAlloc();
+    if (SYSERR == sink.dev_id)
+    {
+        fprintf(stderr, "%s: failed to allocate UDP device\n", prog);
+        return 1;
+    }
+    if (SYSERR == open(sink.dev_id, &netptr->ip, NULL, port, 0))
+    {
+        udptab[sink.dev_id - UDP0].state = UDP_FREE;
+        fprintf(stderr, "%s: failed to open UDP port %u\n", prog, port);
+        return 1;
+    }
+
+    tid = create(pktsink, SHELL_CMDSTK, INITPRIO, "pktsink", 1, &sink);
+    if (isbadtid(tid))
+    {
+        close(sink.dev_id);
+        fprintf(stderr, "%s: failed to create sink thread\n", prog);
+        return 1;
+    }
+    ready(tid, RESCHED_NO);
+
+    printf("Listening on UDP port %u.  Press enter/return to stop.\n",
+           port);
+    getchar();
+    kill(tid);
+    close(sink.dev_id);
+
+    printf("%-8s%12s%12s%12s\n", "Stream", "Received", "Lost",
+           "Reordered");
+    for (i = 0; i < PKTGEN_MAXTHR; i++)
+    {
+        st = &sink.stream[i];
+        if (0 == st->nrecv)
+        {
+            continue;
+        }
+        lost = (st->next > st->nrecv) ? st->next - st->nrecv : 0;
+        printf("%-8u%12u%12u%12u\n", i, st->nrecv, lost, st->nreorder);
+    }
+    if (0 != sink.nbad)
+    {
+        printf("%u packets were not from pktgen.\n", sink.nbad);
+    }
+    if (0 != sink.nlat)
+    {
+        printf("One-way latency (us): min %ld avg %ld max %ld\n",
+               sink.latmin, sink.latavg, sink.latmax);
+    }
 
     return 0;
 }
+
+/**
+ * Sink thread.  Reads pktgen payloads and tracks, per stream, the packets
+ * received, the sequence numbers skipped and those that arrived late, and
+ * the one-way latency from the embedded send time.
+ */
+thread pktsink(struct pktsink_info *sink)
+{
+    struct pktgen_hdr hdr;
+    struct pktsink_stream *st;
+    uint seq, stream, sec, usec;
+    long lat;
+
+    while (TRUE)
+    {
+        if (sizeof(hdr) != read(sink->dev_id, &hdr, sizeof(hdr)))
+        {
+            sink->nbad++;
+            continue;
+        }
+        pktgenStamp(&sec, &usec);
+
+        stream = net2hl(hdr.stream);
+        if ((PKTGEN_MAGIC != net2hl(hdr.magic))
+            || (stream >= PKTGEN_MAXTHR))
+        {
+            sink->nbad++;
+            continue;
+        }
+
+        /* sequence numbers below the highest seen arrived out of order */
+        st = &sink->stream[stream];
+        seq = net2hl(hdr.seq);
+        st->nrecv++;
+        if (seq < st->next)
+        {
+            st->nreorder++;
+        }
+        else
+        {
+            st->next = seq + 1;
+        }
+
+        /* running mean avoids overflowing a sum */
+        lat = (long)(sec - net2hl(hdr.sec)) * 1000000
+            + (long)(usec - net2hl(hdr.usec));
+        sink->nlat++;
+        if ((1 == sink->nlat) || (lat < sink->latmin))
+        {
+            sink->latmin = lat;
+        }
+        if ((1 == sink->nlat) || (lat > sink->latmax))
+        {
+            sink->latmax = lat;
+        }
+        sink->latavg += (lat - sink->latavg) / (long)sink->nlat;
+    }
+
+    return 0;
+}
+
+/**
+ * Reads the wall clock set by rdate, or the time since boot without a
+ * real-time clock, with microsecond fields.
+ */
+static void pktgenStamp(uint *sec, uint *usec)
+{
+    irqmask im;
+
+    im = disable();
+#if RTCLOCK
+    *sec = get_datetime();
+#else
+    *sec = clktime;
+#endif
+
+    *usec = clkticks * (1000000 / CLKTICKS_PER_SEC);
+    restore(im);
+}
+
+/**
+ * Milliseconds since boot.
+ */
+static ulong pktgenMsec(void)
+{
+    irqmask im;
+    ulong msec;
+
+    im = disable();
+    msec = clktime * 1000 + clkticks * (1000 / CLKTICKS_PER_SEC);
+    restore(im);
+    return msec;
+}
 #endif /* NETHER */
@@ -47,7 +47,7 @@ shellcmd xsh_route(int nargs, char *args[])
         printf("[add <DESTINATION> <GATEWAY> <MASK> <INTERFACE>] ");
         printf("[del <DESTINATION>]\n\n");
         printf("Description:\n");
-        printf("\tDisplays routing table\n");
+        printf("\tDisplays routing table and flow cache counters\n");
         printf("Options:\n");
         printf("\tadd <DESTINATION> <GATEWAY> <MASK> <INTERFACE>\n");
         printf("\t\t\t\tadd route entry into table.\n");
@@ -158,6 +158,9 @@ shellcmd xsh_route(int nargs, char *args[])
         }
     }
 
+    printf("\r\nFlow cache: %lu hits, %lu misses\r\n", rtcachehits,
+           rtcachemisses);
+
     return 0;
 }
 #endif /* NETHER */
@@ -5,8 +5,11 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <bpf.h>
 #include <conf.h>
+#include <device.h>
 #include <ipv4.h>
+#include <route.h>
 #include <shell.h>
 #include <snoop.h>
 #include <stdio.h>
@@ -14,6 +17,8 @@
 #include <string.h>
 
 #if NETHER
+static int snoopConnect(struct netaddr *, ushort, bool);
+
 static void usage(char *command)
 {
     printf("Usage:\n");
@@ -21,6 +26,7 @@ static void usage(char *command)
     printf("\t%s [-c COUNT] [-i NETIF] [-s CAPLEN]\n", command);
     printf("\t      [-d] [-dd] [-v] [-vv] [-t TYPE]\n");
     printf("\t      [-da ADDR] [-dp PORT] [-sa ADDR] [-sp PORT]\n");
+    printf("\t      [-e ADDR PORT] [-et ADDR PORT] [EXPRESSION]\n");
     printf("Description:\n");
     printf
         ("\tSnoop prints out a description and contents of packets on\n");
@@ -28,10 +34,17 @@ static void usage(char *command)
         ("\ta network interface. By default it lists all all inbound\n");
     printf
         ("\tand outbound traffic on all active network interfaces.  It\n");
-    printf("\tcan also be used to read a PCAP trace file.\n");
+    printf("\tcan also be used to read a PCAP trace file, or stream\n");
+    printf("\tthe capture as a PCAP file to a collector.\n");
     printf("Output Options:\n");
     printf("\t-d\tDump the packet in hex.\n");
     printf("\t-dd\tDump the packet in hex and ASCII.\n");
+    printf("\t-e\tInstead of printing packets, stream them as a PCAP\n");
+    printf("\t\tfile in UDP datagrams to port PORT at ADDR.  Packets\n");
+    printf("\t\tare held in a ring of %d slots of CAPLEN bytes;\n",
+           SNOOP_RING_NSLOT);
+    printf("\t\tdefault caplen is %d bytes.\n", SNOOP_RING_SNAPLEN);
+    printf("\t-et\tLike -e, but stream over a TCP connection.\n");
     printf("\t--help\tDisplay this help and exit.\n");
     printf("\t-v\tPrint details on the network and transport layer\n");
     printf("\t\theader in each packet.\n");
@@ -56,6 +69,12 @@ static void usage(char *command)
     printf
         ("\t-t\tCapture only packets of type TYPE.  Valid values for\n");
     printf("\t\ttype are: ARP, ICMP, IPv4, TCP, UDP.\n");
+    printf("\tEXPRESSION\n");
+    printf("\t\tCapture only packets matching a tcpdump style filter\n");
+    printf("\t\texpression, which replaces the options above.  It is\n");
+    printf("\t\tbuilt from arp, ip, icmp, tcp, udp, [src|dst] host ADDR,\n");
+    printf("\t\t[src|dst] net ADDR/LEN and [tcp|udp] [src|dst] port PORT\n");
+    printf("\t\tjoined with and, or, not and parentheses.\n");
 }
 
 static void error(char *arg)
@@ -111,9 +130,19 @@ shellcmd xsh_snoop(int nargs, char *args[])
     ushort srcport = 0;
     struct snoop cap;
     char devname[DEVMAXNAME];
+    char expr[BPF_MAXEXPR];
+    char full[BPF_MAXEXPR];
+    uint len;
+    bool caplenset = FALSE;
+    char *export = NULL;
+    ushort exportport = 0;
+    bool exporttcp = FALSE;
+    struct netaddr exporthost;
+    int exportdev = SYSERR;
     tid_typ tid;
 
     strlcpy(devname, "ALL", DEVMAXNAME);
+    expr[0] = '\0';
 
     /* Output help, if '--help' argument was supplied */
     if (nargs == 2 && strcmp(args[1], "--help") == 0)
@@ -125,10 +154,21 @@ shellcmd xsh_snoop(int nargs, char *args[])
     /* Parse arguments */
     for (a = 1; a < nargs; a++)
     {
+        /* Remaining arguments are a filter expression */
         if (args[a][0] != '-')
         {
-            error(args[a]);
-            return 1;
+            for (len = 0; a < nargs; a++)
+            {
+                if (len + strnlen(args[a], BPF_MAXEXPR) + 1 >= BPF_MAXEXPR)
+                {
+                    fprintf(stderr, "Filter expression too long\n");
+                    return 1;
+                }
+                len += strlcpy(expr + len, args[a], BPF_MAXEXPR - len);
+                expr[len++] = ' ';
+                expr[len] = '\0';
+            }
+            break;
         }
 
         switch (args[a][1])
@@ -143,6 +183,25 @@ shellcmd xsh_snoop(int nargs, char *args[])
             }
             count = atoi(args[a]);
             break;
+            /* Export capture */
+        case 'e':
+            if ((('\0' != args[a][2]) && (0 != strcmp(args[a], "-et")))
+                || (a + 2 >= nargs))
+            {
+                error(args[a]);
+                return 1;
+            }
+            exporttcp = ('t' == args[a][2]);
+            export = args[a + 1];
+            exportport = atoi(args[a + 2]);
+            if ((SYSERR == dot2ipv4(export, &exporthost))
+                || (0 == exportport))
+            {
+                error(args[a]);
+                return 1;
+            }
+            a += 2;
+            break;
             /* Output dump OR Filter dst addr OR Filter dst port */
         case 'd':
             switch (args[a][2])
@@ -223,6 +282,7 @@ shellcmd xsh_snoop(int nargs, char *args[])
                     return 1;
                 }
                 caplen = atoi(args[a]);
+                caplenset = TRUE;
                 break;
             default:
                 error(args[a]);
@@ -310,21 +370,98 @@ shellcmd xsh_snoop(int nargs, char *args[])
         dot2ipv4(dstaddr, &cap.dstaddr);
     }
     cap.dstport = dstport;
+    cap.filter.bf_len = 0;
+    cap.filter.bf_insns = NULL;
+    cap.ring = NULL;
+
+    /* Keep the exported stream itself out of the capture */
+    if (NULL != export)
+    {
+        if ((NULL != type) || (NULL != srcaddr) || (NULL != dstaddr)
+            || (0 != srcport) || (0 != dstport))
+        {
+            fprintf(stderr, "Use a filter expression with -e\n");
+            return 1;
+        }
+        if (!caplenset)
+        {
+            caplen = SNOOP_RING_SNAPLEN;
+        }
+        if (strnlen(expr, BPF_MAXEXPR) + strnlen(export, BPF_MAXEXPR)
+            + 40 >= BPF_MAXEXPR)
+        {
+            fprintf(stderr, "Filter expression too long\n");
+            return 1;
+        }
+        sprintf(full, "not (host %s and port %d)", export, exportport);
+        if ('\0' != expr[0])
+        {
+            strncat(full, " and (", BPF_MAXEXPR);
+            strncat(full, expr, BPF_MAXEXPR);
+            strncat(full, ")", BPF_MAXEXPR);
+        }
+        strlcpy(expr, full, BPF_MAXEXPR);
+    }
+    if (('\0' != expr[0])
+        && (SYSERR == bpfCompile(&cap.filter, expr, ETH_HDR_LEN, caplen)))
+    {
+        fprintf(stderr, "Invalid filter expression '%s'\n", expr);
+        return 1;
+    }
+    cap.caplen = caplen;
+
+    /* Connect to collector and allocate the capture ring */
+    if (NULL != export)
+    {
+        exportdev = snoopConnect(&exporthost, exportport, exporttcp);
+        if (SYSERR == exportdev)
+        {
+            fprintf(stderr, "Failed to connect to %s\n", export);
+            bpfFree(&cap.filter);
+            return 1;
+        }
+        if (SYSERR == snoopRingAlloc(&cap, SNOOP_RING_NSLOT, caplen))
+        {
+            fprintf(stderr, "Failed to allocate capture ring\n");
+            close(exportdev);
+            bpfFree(&cap.filter);
+            return 1;
+        }
+    }
 
     /* Open snoop */
     if (SYSERR == snoopOpen(&cap, devname))
     {
         fprintf(stderr, "Failed to open capture on network device '%s'\n",
                 devname);
+        if (NULL != export)
+        {
+            snoopRingFree(&cap);
+            close(exportdev);
+        }
+        bpfFree(&cap.filter);
         return 1;
     }
 
-    /* Spawn output thread */
-    tid = create((void *)snoop, SHELL_CMDSTK, SHELL_CMDPRIO, "snoop",
-                 4, &cap, count, dump, verbose);
+    /* Spawn output or export thread */
+    if (NULL == export)
+    {
+        tid = create((void *)snoop, SHELL_CMDSTK, SHELL_CMDPRIO, "snoop",
+                     4, &cap, count, dump, verbose);
+    }
+    else
+    {
+        tid = create((void *)snoopExport, SHELL_CMDSTK, SHELL_CMDPRIO,
+                     "snoopExport", 3, &cap, exportdev, count);
+    }
     if (SYSERR == tid)
     {
         snoopClose(&cap);
+        if (NULL != export)
+        {
+            close(exportdev);
+        }
+        bpfFree(&cap.filter);
         fprintf(stderr, "Failed to start capture\n");
         return 1;
     }
@@ -344,7 +481,17 @@ shellcmd xsh_snoop(int nargs, char *args[])
         /* Stop snooping when enter is hit */
         fprintf(stdout, "Snooping... Press <Enter> to stop.\n");
         getchar();
-        kill(tid);
+        if (NULL == export)
+        {
+            kill(tid);
+        }
+        else
+        {
+            /* Exporter may be inside a socket write, let it finish */
+            cap.stop = TRUE;
+            signal(cap.rsema);
+            while (receive() != tid);
+        }
     }
     else
     {
@@ -356,17 +503,66 @@ shellcmd xsh_snoop(int nargs, char *args[])
     /* Print out statistics */
     printf("%d packets captured\n", cap.ncap);
     printf("%d packets matched filter\n", cap.nmatch);
-    printf("%d packets printed\n", cap.nprint);
+    printf("%d packets %s\n", cap.nprint,
+           (NULL == export) ? "printed" : "exported");
     printf("%d packets overrun\n", cap.novrn);
 
     /* Close interface */
     if (SYSERR == snoopClose(&cap))
     {
         fprintf(stderr, "Failed to stop capture\n");
+        bpfFree(&cap.filter);
         return 1;
     }
+    bpfFree(&cap.filter);
+    if (NULL != export)
+    {
+        close(exportdev);
+    }
 
     return 0;
 
 }
+
+/**
+ * Opens a UDP or TCP socket to a collector, from the address of the
+ * interface that reaches it.
+ * @return socket device, SYSERR on failure
+ */
+static int snoopConnect(struct netaddr *host, ushort port, bool tcp)
+{
+    struct rtEntry *rtptr;
+    int dev = SYSERR;
+
+    rtptr = rtLookup(host);
+    if ((NULL == rtptr) || (SYSERR == (int)rtptr))
+    {
+        return SYSERR;
+    }
+
+    if (tcp)
+    {
+#if NTCP
+        dev = tcpAlloc();
+        if ((SYSERR != dev)
+            && (SYSERR == open(dev, &rtptr->nif->ip, host, NULL, port,
+                               TCP_ACTIVE)))
+        {
+            dev = SYSERR;
+        }
+#endif                          /* NTCP */
+        return dev;
+    }
+
+#if NUDP
+    dev = udpAlloc();
+    if ((SYSERR != dev)
+        && (SYSERR == open(dev, &rtptr->nif->ip, host, 0, port)))
+    {
+        udptab[dev - UDP0].state = UDP_FREE;
+        dev = SYSERR;
+    }
+#endif                          /* NUDP */
+    return dev;
+}
 #endif /* NETHER */
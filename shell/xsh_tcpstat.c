@@ -27,14 +27,51 @@ shellcmd xsh_tcpstat(int nargs, char *args[])
     /* Output help, if '--help' argument was supplied */
     if (nargs == 2 && strcmp(args[1], "--help") == 0)
     {
-        printf("Usage: %s\n\n", args[0]);
+        printf("Usage: %s [-c | -l on|off]\n\n", args[0]);
         printf("Description:\n");
-        printf("\tDisplays TCP socket information\n");
+        printf("\tDisplays TCP socket information and statistics\n");
         printf("Options:\n");
-        printf("\t--help\tdisplay this help and exit\n");
+        printf("\t-c\t\tprint the TCP event log as CSV\n");
+        printf("\t-l on|off\tstart or stop logging events of all");
+        printf(" connections\n");
+        printf("\t--help\t\tdisplay this help and exit\n");
         return OK;
     }
 
+#if NTCP
+    /* Dump the event log */
+    if (nargs == 2 && strcmp(args[1], "-c") == 0)
+    {
+        tcpLogDump();
+        return OK;
+    }
+
+    /* Turn logging on or off for current and future connections */
+    if (nargs == 3 && strcmp(args[1], "-l") == 0)
+    {
+        if (strcmp(args[2], "on") == 0)
+        {
+            tcplogall = TRUE;
+        }
+        else if (strcmp(args[2], "off") == 0)
+        {
+            tcplogall = FALSE;
+        }
+        else
+        {
+            fprintf(stderr, "%s: expected on or off\n", args[0]);
+            return SYSERR;
+        }
+        for (i = 0; i < NTCP; i++)
+        {
+            wait(tcptab[i].mutex);
+            tcptab[i].log = tcplogall;
+            signal(tcptab[i].mutex);
+        }
+        return OK;
+    }
+#endif                          /* NTCP */
+
     /* Check for correct number of arguments */
     if (nargs > 1)
     {
@@ -15,6 +15,7 @@
 #include <ipv4.h>
 #include <network.h>
 #include <ether.h>
+#include <tcp.h>
 
 #if NETHER
 static int argErr(char *command, char *arg)
@@ -36,6 +37,10 @@ shellcmd xsh_telnetserver(int nargs, char *args[])
 {
     int descrp, port, i, spawntelnet;
     struct thrent *thrptr;
+#if NTELNET
+    struct netif *nif;
+    int tcpdev;
+#endif
     char thrname[TNMLEN];
 
     bzero(thrname, TNMLEN);
@@ -75,6 +80,12 @@ shellcmd xsh_telnetserver(int nargs, char *args[])
         }
 
 #if NTELNET
+        /* Stop listening; connections not yet served are dropped */
+        if (SYSERR != telnetlisten)
+        {
+            close(telnetlisten);
+            telnetlisten = SYSERR;
+        }
         semfree(telnettab[0].killswitch);
         telnettab[0].killswitch = semcreate(0);
 #endif                          /* NTELNET */
@@ -131,16 +142,46 @@ shellcmd xsh_telnetserver(int nargs, char *args[])
         return SHELL_ERROR;
     }
 
-    /* spawn three servers */
 #if NTELNET
+    if (SYSERR != telnetlisten)
+    {
+        fprintf(stderr, "%s: server already running\n", args[0]);
+        return SHELL_ERROR;
+    }
+
+    /* Listen, returning at once since there is a backlog */
+    nif = netLookup(descrp);
+    if (NULL == nif)
+    {
+        fprintf(stderr, "%s: %s is not associated with an active network"
+                " interface.\n", args[0], devtab[descrp].name);
+        return SHELL_ERROR;
+    }
+    tcpdev = tcpAlloc();
+    if (isbadtcp(tcpdev))
+    {
+        fprintf(stderr, "%s: no TCP devices available\n", args[0]);
+        return SHELL_ERROR;
+    }
+    if ((SYSERR == control(tcpdev, TCP_CTRL_BACKLOG, TELNET_BACKLOG, 0))
+        || (SYSERR == (long)open(tcpdev, &nif->ip, NULL, port, NULL,
+                                 TCP_PASSIVE)))
+    {
+        fprintf(stderr, "%s: failed to open TCP socket %d\n", args[0],
+                tcpdev);
+        close(tcpdev);
+        return SHELL_ERROR;
+    }
+    telnetlisten = tcpdev;
+
+    /* spawn servers accepting from the listener */
     for (i = 0; i < NTELNET; i++)
     {
         spawntelnet = telnetAlloc();
         sprintf(thrname, "telnetServ_%d", (spawntelnet - TELNET0));
         TELNET_TRACE("Spawning %s on %d", thrname, spawntelnet - TELNET0);
         ready(create((void *)telnetServer, INITSTK, INITPRIO, thrname,
-                     4, descrp, port, spawntelnet, "SHELL2"),
-              RESCHED_YES);
+                     3, tcpdev, spawntelnet, "SHELL2"), RESCHED_YES);
     }
 #endif
 
@@ -47,25 +47,18 @@ shellcmd xsh_xweb(int nargs, char *args[])
     int i = 0;
     int descrp = 0;
     struct netif *interface = NULL;
-    struct thrent *thrptr = NULL;
     semaphore oldsem = 0;
 
     /* Halt XWeb thread */
     if (nargs == 2 && strcmp(args[1], "-h") == 0)
     {
-        /* Kill all main XWeb threads */
-        for (i = 0; i < NTHREAD; i++)
+        /* Stop listening; connections not yet served are dropped.  The
+         * XWeb thread waiting to accept then fails and frees its HTTP
+         * device, so it is not killed. */
+        if (SYSERR != httplisten)
         {
-            thrptr = &thrtab[i];
-            if (thrptr->state == THRFREE)
-            {
-                continue;
-            }
-
-            if (0 == strncmp(thrptr->name, "XWeb_", 5))
-            {
-                kill(i);
-            }
+            close(httplisten);
+            httplisten = SYSERR;
         }
 
         /* Signal to kill any spawned threads */
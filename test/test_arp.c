@@ -204,7 +204,7 @@ thread test_arp(bool verbose)
     /* Make first entry used */
     arptab[0].state = ARP_USED;
     arptab[0].expires = clktime + ARP_TTL_UNRESOLVED;
-    entry = arpAlloc();
+    entry = arpAlloc(&praddr);
     failif(((NULL == entry) || (entry == &arptab[0])
             || (0 == (entry->state & ARP_USED))), "");
 
@@ -218,7 +218,7 @@ thread test_arp(bool verbose)
         arptab[i].state = ARP_USED;
         arptab[i].expires = clktime + ARP_TTL_RESOLVED;
     }
-    entry = arpAlloc();
+    entry = arpAlloc(&praddr);
     failif(((NULL == entry) || (entry != &arptab[1])
             || (0 == (entry->state & ARP_USED))), "");
 
@@ -336,20 +336,19 @@ thread test_arp(bool verbose)
     }
     for (i = 1; i < nout; i++)
     {
-        entry = &arptab[i];
+        praddr.addr[3] = i + 1;
+        entry = arpAlloc(&praddr);
         entry->state = ARP_RESOLVED;
         entry->nif = netptr;
-        praddr.addr[3] = i + 1;
         hwaddr.addr[5] = ((i + 0xA) << 4) + (i + 0xA);
         netaddrcpy(&entry->hwaddr, &hwaddr);
-        netaddrcpy(&entry->praddr, &praddr);
         entry->expires = clktime + ARP_TTL_RESOLVED;
     }
     for (i = 1; i < nout; i++)
     {
         praddr.addr[3] = i + 1;
         entry = arpGetEntry(&praddr);
-        if (entry != &arptab[i])
+        if (entry != &arptab[i - 1])
         {
             break;
         }
@@ -358,16 +357,18 @@ thread test_arp(bool verbose)
 
     /* Test arpGetEntry with timeout */
     testPrint(verbose, "Get entry (timeout entries)");
-    arptab[i].expires = clktime - 1;
+    arptab[0].expires = clktime - 1;
     praddr.addr[3] = 2;
     entry = arpGetEntry(&praddr);
-    if (entry != &arptab[1])
+    if (entry != NULL)
     {
-        failif(TRUE, "Incorrect entry");
+        failif(TRUE, "Returned expired entry");
     }
     else
     {
-        failif((arptab[0].state != ARP_FREE),
+        praddr.addr[3] = 3;
+        failif((arptab[0].state != ARP_FREE)
+               || (arpGetEntry(&praddr) != &arptab[1]),
                "Did not free expired entry");
     }
     for (i = 0; i < ARP_NENTRY; i++)
@@ -708,13 +709,12 @@ thread test_arp(bool verbose)
     {
         arpFree(&arptab[i]);
     }
-    entry = &arptab[0];
-    entry->state = ARP_RESOLVED;
-    entry->nif = netptr;
     praddr.addr[3] = 1;
     hwaddr.addr[5] = 0xAA;
+    entry = arpAlloc(&praddr);
+    entry->state = ARP_RESOLVED;
+    entry->nif = netptr;
     netaddrcpy(&entry->hwaddr, &hwaddr);
-    netaddrcpy(&entry->praddr, &praddr);
     entry->expires = clktime + ARP_TTL_UNRESOLVED;
     i = arpLookup(netptr, &praddr, &addrbuf);
     if ((SYSERR == i) || (TIMEOUT == i))
@@ -729,13 +729,12 @@ thread test_arp(bool verbose)
 
     /* Test arpLookup */
     testPrint(verbose, "Lookup existing unresolved address");
-    entry = &arptab[1];
-    entry->state = ARP_UNRESOLVED;
-    entry->nif = netptr;
     praddr.addr[3] = 2;
     hwaddr.addr[5] = 0xBB;
+    entry = arpAlloc(&praddr);
+    entry->state = ARP_UNRESOLVED;
+    entry->nif = netptr;
     netaddrcpy(&entry->hwaddr, &hwaddr);
-    netaddrcpy(&entry->praddr, &praddr);
     entry->expires = clktime + ARP_TTL_UNRESOLVED;
     control(ELOOP, ELOOP_CTRL_SETFLAG, ELOOP_FLAG_HOLDNXT, NULL);
     request = data;
@@ -818,6 +817,30 @@ thread test_arp(bool verbose)
     control(ELOOP, ELOOP_CTRL_SETFLAG, ELOOP_FLAG_DROPALL, NULL);
     failif((SYSERR != arpLookup(netptr, &praddr, &addrbuf)), "");
 
+    /* Test arpResolve */
+    testPrint(verbose, "Queue packets on unresolved address");
+    praddr.addr[3] = 5;
+    pkt->nif = netptr;
+    for (i = 0; i <= ARP_NPENDING; i++)
+    {
+        if (ARP_PENDING != arpResolve(netptr, &praddr, &addrbuf, pkt,
+                                      ETHER_TYPE_ARP))
+        {
+            break;
+        }
+    }
+    entry = arpGetEntry(&praddr);
+    if ((i <= ARP_NPENDING) || (NULL == entry))
+    {
+        failif(TRUE, "Packet not queued");
+    }
+    else
+    {
+        failif((ARP_NPENDING != entry->npending)
+               || (SYSERR == arpFree(entry)) || (0 != entry->npending),
+               "Bad pending queue");
+    }
+
     /* Stop loopback ethernet and network interface */
     testPrint(verbose, "Test case cleanup");
     for (i = 0; i < ARP_NENTRY; i++)
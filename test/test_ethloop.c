@@ -76,6 +76,9 @@ static int ethloopn_test(bool verbose, int dev)
     int devminor;
     struct ethloop *pelp;
     struct netaddr addr;
+    struct packet *pkt;
+    struct packet *pkts[NET_NBURST];
+    struct netseg segs[2];
     device *pdev;
 
     pdev = (device *)&devtab[dev];
@@ -209,6 +212,74 @@ static int ethloopn_test(bool verbose, int dev)
     len = read(dev, inpkt, 700);
     failif((len != 700) || (0 != memcmp(outpkt, inpkt, 700)), "");
 
+    sprintf(str, "%s  700 byte packet (write)", pelp->dev->name);
+    testPrint(verbose, str);
+    outpkt->dst[0] += 1;
+    len = write(dev, outpkt, 700);
+    failif((len != 700), "");
+
+    sprintf(str, "%s  700 byte packet (receive packet)", pelp->dev->name);
+    testPrint(verbose, str);
+    len = control(dev, NET_RECV_PKT, (long)&pkt, 0);
+    if (SYSERR == len)
+    {
+        failif(TRUE, "Returned SYSERR");
+    }
+    else
+    {
+        failif((len != 700) || (pkt->len != 700)
+               || (pkt->curr != pkt->data) || (pkt->linkhdr != pkt->data)
+               || (0 != memcmp(outpkt, pkt->data, 700)), "");
+        netFreebuf(pkt);
+    }
+
+    /* Queue several frames and take them all in one burst */
+    sprintf(str, "%s  3 x 700 byte packets (receive burst)",
+            pelp->dev->name);
+    testPrint(verbose, str);
+    subpass = TRUE;
+    for (i = 0; i < 3; i++)
+    {
+        if (700 != write(dev, outpkt, 700))
+        {
+            subpass = FALSE;
+        }
+    }
+    len = control(dev, NET_RECV_BURST, (long)pkts, NET_NBURST);
+    if (SYSERR == len)
+    {
+        failif(TRUE, "Returned SYSERR");
+    }
+    else
+    {
+        for (i = 0; i < len; i++)
+        {
+            if ((pkts[i]->len != 700)
+                || (0 != memcmp(outpkt, pkts[i]->data, 700)))
+            {
+                subpass = FALSE;
+            }
+            netFreebuf(pkts[i]);
+        }
+        failif((len != 3) || (TRUE != subpass), "");
+    }
+
+    /* Write a frame in two segments and read it back contiguous */
+    sprintf(str, "%s  700 byte packet (gather write)", pelp->dev->name);
+    testPrint(verbose, str);
+    segs[0].data = outpkt;
+    segs[0].len = 100;
+    segs[1].data = (uchar *)outpkt + 100;
+    segs[1].len = 600;
+    len = control(dev, NET_SEND_SG, (long)segs, 2);
+    failif((len != 700), "");
+
+    sprintf(str, "%s  700 byte packet (gather read)", pelp->dev->name);
+    testPrint(verbose, str);
+    bzero(inpkt, memsize);
+    len = read(dev, inpkt, 700);
+    failif((len != 700) || (0 != memcmp(outpkt, inpkt, 700)), "");
+
     /* Free temporary buffers. */
     memfree(outpkt, memsize);
     memfree(inpkt, memsize);
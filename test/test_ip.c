@@ -8,6 +8,7 @@
 #include <device.h>
 #include <ethloop.h>
 #include <ipv4.h>
+#include <mib.h>
 #include <snoop.h>
 #include <pcap.h>
 #include <network.h>
@@ -28,6 +29,49 @@ extern int _binary_data_testip_pcap_start;
 #define NNETIF (-1)
 #endif
 
+#if NETHER
+/* Build the fragment at offset off of a test datagram whose payload byte
+ * at each offset is the offset's low 8 bits.  */
+static struct packet *ipRasmFrag(struct netif *netptr,
+                                 struct netaddr *src, struct netaddr *dst,
+                                 uint off, uint len, bool more)
+{
+    struct packet *pkt;
+    struct ipv4Pkt *ip;
+    uint i;
+
+    pkt = netGetbuf();
+    if (SYSERR == (int)pkt)
+    {
+        return NULL;
+    }
+    pkt->nif = netptr;
+    pkt->linkhdr = pkt->data;
+    pkt->nethdr = pkt->data + netptr->linkhdrlen;
+    pkt->curr = pkt->nethdr;
+    pkt->len = netptr->linkhdrlen + IPv4_HDR_LEN + len;
+    bzero(pkt->linkhdr, netptr->linkhdrlen);
+
+    ip = (struct ipv4Pkt *)pkt->nethdr;
+    ip->ver_ihl = (IPv4_VERSION << 4) | IPv4_MIN_IHL;
+    ip->tos = 0;
+    ip->len = hs2net(IPv4_HDR_LEN + len);
+    ip->id = hs2net(0x1234);
+    ip->flags_froff = hs2net((more ? IPv4_FLAG_MF : 0) | (off >> 3));
+    ip->ttl = IPv4_TTL;
+    ip->proto = IPv4_PROTO_UDP;
+    memcpy(ip->src, src->addr, IPv4_ADDR_LEN);
+    memcpy(ip->dst, dst->addr, IPv4_ADDR_LEN);
+    ip->chksum = 0;
+    ip->chksum = netChksum((uchar *)ip, IPv4_HDR_LEN);
+    for (i = 0; i < len; i++)
+    {
+        ip->opts[i] = (off + i) & 0xFF;
+    }
+    return pkt;
+}
+#endif /* NETHER */
+
 thread test_ip(bool verbose)
 {
 #if NETHER
@@ -39,10 +83,13 @@ thread test_ip(bool verbose)
     struct pcap_pkthdr phdr;
     struct packet *pktA;
     struct packet *pktB;
+    struct packet *frag;
+    struct ipv4Pkt *ip;
     uchar *data;
     uchar buf[500];
     int i;
     int nproc;
+    uint inrecv;
     int wait;
     bool passed = TRUE;
 
@@ -118,6 +165,7 @@ thread test_ip(bool verbose)
         phdr.caplen = endswap(phdr.caplen);
     }
     nproc = netptr->nproc;
+    inrecv = mib.ipv4.inReceives;
     write(ELOOP, data, phdr.caplen);
     wait = 0;
     while ((wait < MAX_WAIT) && (netptr->nproc == nproc))
@@ -163,6 +211,46 @@ thread test_ip(bool verbose)
         }
     }
 
+    /* Reassemble three fragments delivered out of order */
+    testPrint(verbose, "ipv4Rasm");
+    frag = ipRasmFrag(netptr, &dst, &src, 1000, 1000, FALSE);
+    failif((NULL == frag) || (NULL != ipv4Rasm(frag)),
+           "Incomplete datagram returned");
+    frag = ipRasmFrag(netptr, &dst, &src, 0, 504, TRUE);
+    failif((NULL == frag) || (NULL != ipv4Rasm(frag)),
+           "Incomplete datagram returned");
+    frag = ipRasmFrag(netptr, &dst, &src, 504, 496, TRUE);
+    pktA = (NULL == frag) ? NULL : ipv4Rasm(frag);
+    if (NULL == pktA)
+    {
+        failif(TRUE, "Datagram not reassembled");
+    }
+    else
+    {
+        ip = (struct ipv4Pkt *)pktA->nethdr;
+        failif((pktA->len != netptr->linkhdrlen + IPv4_HDR_LEN + 2000)
+               || (net2hs(ip->len) != IPv4_HDR_LEN + 2000)
+               || (0 != ip->flags_froff)
+               || (0 != netChksum((uchar *)ip, IPv4_HDR_LEN)),
+               "Bad reassembled header");
+        for (i = 0; i < 2000; i++)
+        {
+            if (ip->opts[i] != (i & 0xFF))
+            {
+                break;
+            }
+        }
+        failif(2000 != i, "Bad reassembled data");
+        netFreebuf(pktA);
+    }
+
+    /* The first packet was counted, and reset clears every counter */
+    testPrint(verbose, "Statistics");
+    failif((mib.ipv4.inReceives == inrecv), "Packet not counted");
+    mibReset();
+    failif((0 != mib.ipv4.inReceives) || (0 != netptr->nin)
+           || (0 != mib.ipv4.reasmOKs), "Counters not reset");
+
     /* ipv4Recv Testing */
     //TODO: Finish ipv4Recv
 /*	testPrint(verbose, "ipv4Recv");
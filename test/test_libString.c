@@ -119,6 +119,15 @@ thread test_libString(bool verbose)
     failif(((0 != memcmp(sH, "FGHIJ", 5))
             || (0 != memcmp(s1, "FGHIJ", 5))), "");
 
+    /* memmove */
+    testPrint(verbose, "Memory move (overlapping)");
+    char sM[9] = "ABCDEFGH";
+
+    s1 = memmove(sM + 2, sM, 5);
+    s2 = memmove(sM, sM + 3, 4);
+    failif(((0 != memcmp(sM, "BCDECDEH", 8))
+            || (s1 != sM + 2) || (s2 != sM)), "");
+
     /* memchr */
     testPrint(verbose, "Memory character search");
     char sI[7] = "abcdba";
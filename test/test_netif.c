@@ -5,14 +5,19 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <clock.h>
 #include <ethloop.h>
 #include <interrupt.h>
 #include <ipv4.h>
 #include <network.h>
 #include <snoop.h>
 #include <pcap.h>
+#include <platform.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <testsuite.h>
 #include <thread.h>
+#include <udp.h>
 
 #ifndef ELOOP
 #define ELOOP (-1)
@@ -22,8 +27,38 @@
 #define NNETIF (-1)
 #endif
 
+#define NETIF_BENCH_NPKT 1000     /**< packets timed by buffer benchmark */
+#define NETIF_BENCH_NRX  1024     /**< frames timed by receive benchmark  */
+#define NETIF_BENCH_NQ   32       /**< frames queued per receive burst    */
+#define NETIF_BENCH_TYPE 0x88B5   /**< local experimental ethertype       */
+#define NETIF_FLOW_NPKT  16       /**< frames sent by flow affinity test  */
+#define NETIF_FLOW_WAIT  100      /**< 10 ms waits for flow frames        */
+
 extern int _binary_data_testnetif_pcap_start;
 
+/* Writes frames to the loopback device NETIF_BENCH_NQ at a time, each
+ * batch queued before the receive threads can run, and returns the cycles
+ * taken to write and receive them all */
+static ulong netifBenchRecv(const uchar *frame, uint len)
+{
+    ulong start;
+    int prio;
+    int i, j;
+
+    start = clkcount();
+    for (i = 0; i < NETIF_BENCH_NRX; i += NETIF_BENCH_NQ)
+    {
+        prio = chprio(gettid(), NET_THR_PRIO + 1);
+        for (j = 0; j < NETIF_BENCH_NQ; j++)
+        {
+            write(ELOOP, frame, len);
+        }
+        chprio(gettid(), prio);
+        yield();
+    }
+    return clkcount() - start;
+}
+
 /**
  * Tests the network interfaces.
  * @return OK when testing is complete
@@ -42,6 +77,15 @@ thread test_netif(bool verbose)
     struct packet *pkt;
     struct netif *netptr;
     uchar *data;
+    ulong start;
+    ulong cycles;
+    ulong zcycles;
+    uchar frame[ETH_HDR_LEN + 46];
+    struct etherPkt *ether;
+    struct ipv4Pkt *iphdr;
+    struct udpPkt *udphdr;
+    uint nin;
+    int j;
 
     ip.type = NETADDR_IPv4;
     ip.len = IPv4_ADDR_LEN;
@@ -98,17 +142,106 @@ thread test_netif(bool verbose)
         {
             for (i = 0; i < NET_NTHR; i++)
             {
-                if (isbadtid(netptr->recvthr[i]))
+                if (isbadtid(netptr->worker[i].tid))
                 {
-                    failif(TRUE, "Bad recvthr");
                     break;
                 }
             }
-            if (NET_NTHR == i)
+            failif((isbadtid(netptr->recvthr) || (NET_NTHR != i)
+                    || (NET_NTHR != netptr->nworker)), "Bad recvthr");
+        }
+    }
+
+    /* Time frames through the receive threads, first taken from the driver
+     * in bursts and then one at a time by read(), as from a driver without
+     * burst receive.  Both times include writing the frames.  */
+    testPrint(verbose, "Receive throughput benchmark");
+    netptr = netLookup(ELOOP);
+    if (NULL == netptr)
+    {
+        failif(TRUE, "No network interface");
+    }
+    else
+    {
+        bzero(frame, sizeof(frame));
+        ether = (struct etherPkt *)frame;
+        memcpy(ether->dst, netptr->hwaddr.addr, ETH_ADDR_LEN);
+        memcpy(ether->src, netptr->hwaddr.addr, ETH_ADDR_LEN);
+        ether->type = hs2net(NETIF_BENCH_TYPE);
+        nin = netptr->nin;
+
+        cycles = netifBenchRecv(frame, sizeof(frame));
+
+        /* The receive thread falls back to read() on its next frame and
+         * stays there until the interface is restarted */
+        control(ELOOP, ELOOP_CTRL_SETFLAG, ELOOP_FLAG_RXREAD, 0);
+        write(ELOOP, frame, sizeof(frame));
+        yield();
+        zcycles = netifBenchRecv(frame, sizeof(frame));
+        control(ELOOP, ELOOP_CTRL_CLRFLAG, ELOOP_FLAG_RXREAD, 0);
+
+        failif((netptr->nin - nin != 2 * NETIF_BENCH_NRX + 1),
+               "Frames lost");
+        if (verbose)
+        {
+            cycles = cycles / NETIF_BENCH_NRX + 1;
+            zcycles = zcycles / NETIF_BENCH_NRX + 1;
+            printf("\t%lu pps in bursts, %lu pps by read() (%lu, %lu "
+                   "cycles/pkt)\r\n", platform.clkfreq / cycles,
+                   platform.clkfreq / zcycles, cycles, zcycles);
+        }
+    }
+
+    /* Frames of one flow must all be processed by the same worker */
+    testPrint(verbose, "Flow affinity");
+    netptr = netLookup(ELOOP);
+    if ((NULL == netptr) || (SYSERR == netRecvWorkers(netptr, 3)))
+    {
+        failif(TRUE, "Failed to set workers");
+    }
+    else
+    {
+        bzero(frame, sizeof(frame));
+        ether = (struct etherPkt *)frame;
+        memcpy(ether->dst, netptr->hwaddr.addr, ETH_ADDR_LEN);
+        memcpy(ether->src, netptr->hwaddr.addr, ETH_ADDR_LEN);
+        ether->type = hs2net(ETHER_TYPE_IPv4);
+        iphdr = (struct ipv4Pkt *)ether->data;
+        iphdr->ver_ihl = (IPv4_VERSION << 4) | (IPv4_HDR_LEN / 4);
+        iphdr->len = hs2net(IPv4_HDR_LEN + UDP_HDR_LEN);
+        iphdr->proto = IPv4_PROTO_UDP;
+        memcpy(iphdr->src, gate.addr, IPv4_ADDR_LEN);
+        memcpy(iphdr->dst, ip.addr, IPv4_ADDR_LEN);
+        udphdr = (struct udpPkt *)iphdr->opts;
+        udphdr->srcPort = hs2net(1024);
+        udphdr->dstPort = hs2net(9);
+
+        for (i = 0; i < NETIF_FLOW_NPKT; i++)
+        {
+            write(ELOOP, frame, sizeof(frame));
+        }
+        for (j = 0; j < NETIF_FLOW_WAIT; j++)
+        {
+            nin = 0;
+            for (i = 0; i < netptr->nworker; i++)
             {
-                failif(FALSE, "");
+                nin += netptr->worker[i].nproc;
+            }
+            if (NETIF_FLOW_NPKT == nin)
+            {
+                break;
+            }
+            sleep(10);
+        }
+        for (i = 0; i < netptr->nworker; i++)
+        {
+            if (NETIF_FLOW_NPKT == netptr->worker[i].nproc)
+            {
+                break;
             }
         }
+        failif((3 != netptr->nworker) || (i == netptr->nworker),
+               "Flow split across workers");
     }
 
     testPrint(verbose, "Stop network interface");
@@ -127,11 +260,9 @@ thread test_netif(bool verbose)
 
     /* Kill receiver threads */
     netptr = &netiftab[i];
-    for (i = 0; i < NET_NTHR; i++)
-    {
-        kill(netptr->recvthr[i]);
-        netptr->recvthr[i] = BADTID;
-    }
+    kill(netptr->recvthr);
+    netptr->recvthr = BADTID;
+    netRecvWorkers(netptr, 0);
 
     testPrint(verbose, "Get packet buffer");
     pkt = netGetbuf();
@@ -181,6 +312,54 @@ thread test_netif(bool verbose)
     testPrint(verbose, "Free packet buffer");
     failif((SYSERR == netFreebuf(pkt)), "");
 
+    testPrint(verbose, "Packet buffer metadata reset");
+    pkt = netGetbuf();
+    if (SYSERR == (int)pkt)
+    {
+        failif(TRUE, "Returned SYSERR");
+    }
+    else
+    {
+        failif(((pkt->nif != NULL) || (pkt->len != 0)
+                || (pkt->linkhdr != NULL) || (pkt->nethdr != NULL)
+                || (pkt->curr != pkt->data + NET_MAX_PKTLEN)),
+               "Metadata not reset");
+        netFreebuf(pkt);
+    }
+
+    /* Compare the cost of allocating a packet buffer against allocating
+     * one and zeroing the whole buffer, as netGetbuf() used to do.  */
+    testPrint(verbose, "Packet buffer allocation benchmark");
+    cycles = 0;
+    zcycles = 0;
+    for (i = 0; i < NETIF_BENCH_NPKT; i++)
+    {
+        start = clkcount();
+        pkt = netGetbuf();
+        cycles += clkcount() - start;
+        if (SYSERR == (int)pkt)
+        {
+            break;
+        }
+        netFreebuf(pkt);
+
+        start = clkcount();
+        pkt = netGetbuf();
+        if (SYSERR == (int)pkt)
+        {
+            break;
+        }
+        bzero(pkt, sizeof(struct packet) + NET_MAX_PKTLEN);
+        zcycles += clkcount() - start;
+        netFreebuf(pkt);
+    }
+    failif((i < NETIF_BENCH_NPKT), "Returned SYSERR");
+    if (verbose)
+    {
+        printf("\t%lu cycles/pkt (%lu cycles/pkt with full zeroing)\r\n",
+               cycles / NETIF_BENCH_NPKT, zcycles / NETIF_BENCH_NPKT);
+    }
+
     testPrint(verbose, "Stop network interface");
     failif(((SYSERR == netDown(ELOOP)) || (SYSERR == close(ELOOP))), "");
 
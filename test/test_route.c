@@ -0,0 +1,200 @@
+/**
+ * @file     test_route.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <ipv4.h>
+#include <network.h>
+#include <platform.h>
+#include <route.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <testsuite.h>
+
+#define ROUTE_BENCH_NROUTE  256   /**< routes added by the benchmark      */
+#define ROUTE_BENCH_NLOOKUP 4096  /**< lookups timed by the benchmark     */
+
+#if NETHER
+/* Routes are drawn from 198.18.0.0/15, reserved for benchmarking */
+static uint routeRand(uint *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return (0xC6120000 | ((*seed >> 8) & 0x1FFFF));
+}
+
+static void routeAddr(struct netaddr *addr, uint key)
+{
+    addr->type = NETADDR_IPv4;
+    addr->len = IPv4_ADDR_LEN;
+    addr->addr[0] = key >> 24;
+    addr->addr[1] = key >> 16;
+    addr->addr[2] = key >> 8;
+    addr->addr[3] = key;
+}
+
+/* Reference lookup: linear scan of the whole route table */
+static struct rtEntry *routeLinear(uint key)
+{
+    struct rtEntry *rtptr = NULL;
+    int i;
+
+    for (i = 0; i < RT_NENTRY; i++)
+    {
+        if ((RT_USED == rttab[i].state)
+            && ((key & rtKey(rttab[i].mask.addr)) ==
+                rtKey(rttab[i].dst.addr))
+            && ((NULL == rtptr) || (rtptr->masklen < rttab[i].masklen)))
+        {
+            rtptr = &rttab[i];
+        }
+    }
+    return rtptr;
+}
+
+static int routeNfree(void)
+{
+    struct rtNode *node;
+    int n = 0;
+
+    for (node = rtnodefree; NULL != node; node = node->child[0])
+    {
+        n++;
+    }
+    return n;
+}
+#endif /* NETHER */
+
+/**
+ * Tests longest prefix match routing and times route lookups.
+ * @return OK when testing is complete
+ */
+thread test_route(bool verbose)
+{
+#if NETHER
+    bool passed = TRUE;
+    struct netaddr dst;
+    struct netaddr mask;
+    struct rtEntry *rtptr;
+    ulong start, cycles, lcycles;
+    ulong gen;
+    uint seed, key, len;
+    int nfree, nused;
+    int i;
+    irqmask im;
+
+    nfree = routeNfree();
+
+    testPrint(verbose, "Add routes");
+    seed = 1;
+    for (i = 0; i < ROUTE_BENCH_NROUTE; i++)
+    {
+        key = routeRand(&seed);
+        len = 16 + (seed >> 27) % 17;
+        routeAddr(&dst, key);
+        routeAddr(&mask, rtMask(len));
+        if (SYSERR == rtAdd(&dst, NULL, &mask, &netiftab[0]))
+        {
+            break;
+        }
+    }
+    failif((i < ROUTE_BENCH_NROUTE), "rtAdd returned SYSERR");
+
+    testPrint(verbose, "Replace route");
+    routeAddr(&dst, 0xC6120000);
+    routeAddr(&mask, rtMask(15));
+    nused = 0;
+    for (i = 0; i < 2; i++)
+    {
+        rtAdd(&dst, NULL, &mask, &netiftab[0]);
+    }
+    for (i = 0; i < RT_NENTRY; i++)
+    {
+        if ((RT_USED == rttab[i].state) && (15 == rttab[i].masklen)
+            && (0xC6120000 == rtKey(rttab[i].dst.addr)))
+        {
+            nused++;
+        }
+    }
+    failif((1 != nused), "Duplicate route");
+
+    testPrint(verbose, "Flow cache invalidation");
+    gen = rtcachegen;
+    rtAdd(&dst, NULL, &mask, &netiftab[0]);
+    failif((gen == rtcachegen), "Route change left cache valid");
+
+    testPrint(verbose, "Reject non-contiguous mask");
+    routeAddr(&mask, 0xFFFF00FF);
+    failif((SYSERR != rtAdd(&dst, NULL, &mask, &netiftab[0])), "");
+
+    testPrint(verbose, "Longest prefix match");
+    seed = 2;
+    for (i = 0; i < ROUTE_BENCH_NLOOKUP; i++)
+    {
+        key = routeRand(&seed);
+        routeAddr(&dst, key);
+        if (rtLookup(&dst) != routeLinear(key))
+        {
+            break;
+        }
+    }
+    failif((i < ROUTE_BENCH_NLOOKUP), "Lookup differs from linear scan");
+
+    /* Time trie lookups against the linear scan they replace */
+    seed = 3;
+    cycles = 0;
+    lcycles = 0;
+    for (i = 0; i < ROUTE_BENCH_NLOOKUP; i++)
+    {
+        key = routeRand(&seed);
+        routeAddr(&dst, key);
+        im = disable();
+        start = clkcount();
+        rtLookup(&dst);
+        cycles += clkcount() - start;
+        start = clkcount();
+        routeLinear(key);
+        lcycles += clkcount() - start;
+        restore(im);
+    }
+    if (verbose)
+    {
+        printf("\t%d routes: %lu cycles/lookup trie, %lu linear\r\n",
+               ROUTE_BENCH_NROUTE, cycles / ROUTE_BENCH_NLOOKUP,
+               lcycles / ROUTE_BENCH_NLOOKUP);
+        printf("\t%lu lookups/sec\r\n",
+               platform.clkfreq / (cycles / ROUTE_BENCH_NLOOKUP + 1));
+    }
+
+    testPrint(verbose, "Remove routes");
+    for (i = 0; i < RT_NENTRY; i++)
+    {
+        if ((RT_USED == rttab[i].state)
+            && (0xC6120000 == (rtKey(rttab[i].dst.addr) & rtMask(15))))
+        {
+            netaddrcpy(&dst, &rttab[i].dst);
+            rtRemove(&dst);
+        }
+    }
+    routeAddr(&dst, 0xC6120001);
+    rtptr = rtLookup(&dst);
+    failif(((NULL != rtptr) && (0 != rtptr->masklen))
+           || (routeNfree() != nfree), "Routes left in trie");
+
+    /* always print out the overall tests status */
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+#else /* NETHER */
+    testSkip(TRUE, "");
+#endif /* NETHER == 0 */
+    return OK;
+}
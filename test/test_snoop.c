@@ -1,4 +1,5 @@
 #include <stddef.h>
+#include <bpf.h>
 #include <device.h>
 #include <ipv4.h>
 #include <limits.h>
@@ -71,9 +72,12 @@ thread test_snoop(bool verbose)
     struct netif *netptr;
     struct pcap_file_header pcap;
     struct pcap_pkthdr phdr;
+    struct pcap_pkthdr *rhdr;
     struct packet *pktA;
     struct packet *pktB;
+    struct bpf_insn bad[2];
     uchar *data;
+    uint nmatch;
     int i;
 
     src.len = IPv4_ADDR_LEN;
@@ -112,6 +116,51 @@ thread test_snoop(bool verbose)
     cap.type = SNOOP_FILTER_ARP;
     failif((7 != filterTest(&cap, pktA)), "");
 
+    /* Filter programs */
+    testPrint(verbose, "Filter program");
+    cap.type = SNOOP_FILTER_IPv4;
+    nmatch = filterTest(&cap, pktA);
+    cap.type = SNOOP_FILTER_ALL;
+    failif((OK != bpfCompile(&cap.filter, "ip", ETH_HDR_LEN, USHRT_MAX))
+           || (nmatch != filterTest(&cap, pktA)), "");
+    bpfFree(&cap.filter);
+
+    testPrint(verbose, "Filter program expression");
+    failif((OK != bpfCompile(&cap.filter, "not (arp or tcp port 1)",
+                             ETH_HDR_LEN, USHRT_MAX))
+           || (17 - 7 != filterTest(&cap, pktA)), "");
+    bpfFree(&cap.filter);
+    failif((OK != bpfCompile(&cap.filter,
+                             "udp src port 502 and dst port 503",
+                             ETH_HDR_LEN, USHRT_MAX))
+           || (3 != filterTest(&cap, pktA)), "Ports");
+    bpfFree(&cap.filter);
+
+    testPrint(verbose, "Filter program (bad expression)");
+    failif((SYSERR != bpfCompile(&cap.filter, "tcp port", ETH_HDR_LEN,
+                                 USHRT_MAX))
+           || (SYSERR != bpfCompile(&cap.filter, "(arp", ETH_HDR_LEN,
+                                    USHRT_MAX))
+           || (SYSERR != bpfCompile(&cap.filter, "host 10.0.0", ETH_HDR_LEN,
+                                    USHRT_MAX))
+           || (SYSERR != bpfCompile(&cap.filter, "arp", 0, USHRT_MAX)), "");
+
+    testPrint(verbose, "Validate filter program");
+    bad[0].code = BPF_JMP | BPF_JA;
+    bad[0].k = 1;
+    bad[1].code = BPF_RET | BPF_K;
+    bad[1].k = 0;
+    failif(bpfValidate(bad, 2), "Jump past end");
+    bad[0].code = BPF_ALU | BPF_DIV | BPF_K;
+    bad[0].k = 0;
+    failif(bpfValidate(bad, 2), "Divide by zero");
+    bad[0].code = BPF_ALU | BPF_LSH | BPF_K;
+    bad[0].k = 32;
+    failif(bpfValidate(bad, 2), "Shift by 32");
+    bad[0].code = BPF_LD | BPF_IMM;
+    failif(!bpfValidate(bad, 2) || bpfValidate(bad, 1), "");
+    bzero(&cap, sizeof(struct snoop));
+
     /* Test open */
     testPrint(verbose, "Open capture (bad params)");
     bzero(&cap, sizeof(struct snoop));
@@ -267,6 +316,32 @@ thread test_snoop(bool verbose)
     testPrint(verbose, "Close capture");
     failif((SYSERR == snoopClose(&cap)), "Returned SYSERR");
 
+    testPrint(verbose, "Capture ring");
+    bzero(&cap, sizeof(struct snoop));
+    cap.caplen = USHRT_MAX;
+    if (SYSERR == snoopRingAlloc(&cap, 4, 32))
+    {
+        failif(TRUE, "Returned SYSERR");
+    }
+    else
+    {
+        for (i = 0; i < 4; i++)
+        {
+            if (SYSERR == snoopCapture(&cap, pktA))
+            {
+                break;
+            }
+        }
+        rhdr = (struct pcap_pkthdr *)cap.ring;
+        failif(((i < 4) || (4 != semcount(cap.rsema))), "Not stored");
+        failif(((SYSERR != snoopCapture(&cap, pktA)) || (1 != cap.novrn)),
+               "Ring did not overrun");
+        failif(((32 != rhdr->caplen) || (pktA->len != rhdr->len)
+                || (0 != memcmp(rhdr + 1, pktA->data, 32))),
+               "Record doesn't match");
+        failif((SYSERR == snoopRingFree(&cap)), "Free returned SYSERR");
+    }
+
     /* TODO: RESUME HERE */
 
     netDown(ELOOP);
@@ -0,0 +1,1057 @@
+/**
+ * @file     test_tcp.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <arp.h>
+#include <clock.h>
+#include <device.h>
+#include <interrupt.h>
+#include <ipv4.h>
+#include <memory.h>
+#include <network.h>
+#include <platform.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <tcp.h>
+#include <testsuite.h>
+
+#define TCP_BENCH_NCONN   64    /**< connections added by the benchmark  */
+#define TCP_BENCH_PORT    7999  /**< local port of benchmark connections */
+#define TCP_BENCH_RPORT   20000 /**< first remote port                   */
+#define TCP_BENCH_SEG     1440  /**< bytes per bulk transfer segment     */
+#define TCP_BENCH_NSEG    1024  /**< segments moved each way             */
+
+#if NTCP
+static void tcpFake(struct tcb *tcbptr, uchar state, ushort remotept,
+                    struct netaddr *remoteip)
+{
+    bzero(tcbptr, sizeof(struct tcb));
+    tcbptr->state = state;
+    tcbptr->localpt = TCP_BENCH_PORT;
+    testBenchAddr(&tcbptr->localip, 1);
+    tcbptr->remotept = remotept;
+    if (NULL != remoteip)
+    {
+        netaddrcpy(&tcbptr->remoteip, remoteip);
+    }
+    tcpHashInsert(tcbptr);
+}
+
+/* Tables the demultiplexing benchmark looks up */
+struct tcpBench
+{
+    struct tcb *tab;
+    uint ntab;
+    semaphore sem;
+    struct netaddr *local;
+};
+
+static void *tcpHashed(void *ctx, uint key, struct netaddr *remote)
+{
+    struct tcpBench *bench = ctx;
+
+    return tcpDemux(TCP_BENCH_PORT, TCP_BENCH_RPORT + key, bench->local,
+                    remote);
+}
+
+/* Reference lookup: the per-TCB locked scan tcpDemux() used to do */
+static void *tcpLinear(void *ctx, uint key, struct netaddr *srcip)
+{
+    struct tcpBench *bench = ctx;
+    struct tcb *tab = bench->tab;
+    struct tcb *tcbptr = NULL;
+    ushort dstpt = TCP_BENCH_PORT;
+    ushort srcpt = TCP_BENCH_RPORT + key;
+    uint level = 0;
+    uint i;
+
+    for (i = 0; i < bench->ntab; i++)
+    {
+        wait(bench->sem);
+        if ((tab[i].state != TCP_CLOSED) && (tab[i].localpt == dstpt)
+            && netaddrequal(&tab[i].localip, bench->local))
+        {
+            if (level < 3 && (tab[i].remotept == srcpt)
+                && netaddrequal(&tab[i].remoteip, srcip))
+            {
+                tcbptr = &tab[i];
+                level = 3;
+            }
+            if (level < 2 && (tab[i].remotept == srcpt)
+                && (tab[i].remoteip.type == NULL))
+            {
+                tcbptr = &tab[i];
+                level = 2;
+            }
+            if (level < 1 && (tab[i].remotept == NULL)
+                && (tab[i].remoteip.type == NULL))
+            {
+                tcbptr = &tab[i];
+                level = 1;
+            }
+        }
+        signal(bench->sem);
+    }
+    return tcbptr;
+}
+
+/* Builds a segment for tcpRecvData() or tcpRecvAck(), in host order */
+static struct packet *tcpBenchPkt(ushort datalen)
+{
+    struct packet *pkt;
+    struct tcpPkt *tcp;
+
+    pkt = netGetbuf();
+    if (SYSERR == (int)pkt)
+    {
+        return pkt;
+    }
+    pkt->len = TCP_HDR_LEN + datalen;
+    pkt->curr -= (pkt->len + 3) & ~3;
+    pkt->linkhdr = pkt->curr;
+    tcp = (struct tcpPkt *)pkt->curr;
+    bzero(tcp, pkt->len);
+    tcp->srcpt = TCP_BENCH_RPORT;
+    tcp->dstpt = TCP_BENCH_PORT;
+    tcp->offset = octets2offset(TCP_HDR_LEN);
+    tcp->control = TCP_CTRL_ACK;
+    tcp->window = TCP_MAX_WND;
+    return pkt;
+}
+
+/**
+ * Sets up an allocated TCB as an established connection whose remote
+ * address is not IPv4, so the segments it sends are dropped by ipv4Send().
+ * @return OK, or SYSERR if the TCB could not be set up
+ */
+static int tcpBenchOpen(struct tcb *tcbptr, int dev)
+{
+    int result;
+
+    wait(tcbptr->mutex);
+    tcbptr->dev = dev;
+    tcbptr->localpt = TCP_BENCH_PORT;
+    tcbptr->remotept = TCP_BENCH_RPORT;
+    testBenchAddr(&tcbptr->localip, 1);
+    tcbptr->remoteip.type = NETADDR_ETHERNET;
+    tcbptr->remoteip.len = IPv4_ADDR_LEN;
+    result = tcpSetup(tcbptr);
+    tcbptr->state = TCP_ESTAB;
+    tcbptr->rcvnxt = 1;
+    tcbptr->rcvwnd = seqadd(tcbptr->rcvnxt, tcbptr->ilen);
+    tcbptr->sndwnd = TCP_MAX_WND;
+    signal(tcbptr->mutex);
+    return result;
+}
+
+/* Releases a TCB set up by tcpBenchOpen() */
+static void tcpBenchClose(struct tcb *tcbptr)
+{
+    wait(tcbptr->mutex);
+    if (TCP_CLOSED == tcbptr->state)
+    {
+        tcbptr->devstate = TCP_FREE;
+        signal(tcbptr->mutex);
+    }
+    else
+    {
+        tcpFree(tcbptr);
+    }
+}
+
+/* Releases what tcpBenchSetup() allocated; NULL arguments are skipped */
+static void tcpBenchTeardown(struct tcb *tcbptr, struct packet *data,
+                             struct packet *ack, uchar *buf, uint buflen)
+{
+    tcpBenchClose(tcbptr);
+    if ((NULL != data) && (SYSERR != (int)data))
+    {
+        netFreebuf(data);
+    }
+    if ((NULL != ack) && (SYSERR != (int)ack))
+    {
+        netFreebuf(ack);
+    }
+    if ((NULL != buf) && (SYSERR != (int)buf))
+    {
+        memfree(buf, buflen);
+    }
+}
+
+/**
+ * Allocates a TCB set up by tcpBenchOpen(), with segments from
+ * tcpBenchPkt() and a buffer for a test.  Any of data, ack and buf may be
+ * NULL when the test does not need it.  On failure everything already
+ * allocated is released again.
+ * @param tcbptr set to the TCB
+ * @param data set to a segment of datalen bytes
+ * @param datalen data bytes in data
+ * @param ack set to a segment of acklen bytes
+ * @param acklen data bytes in ack
+ * @param buf set to a buffer of buflen bytes
+ * @param buflen bytes in buf
+ * @return TCP device, or SYSERR if the test cannot run
+ */
+static int tcpBenchSetup(struct tcb **tcbptr, struct packet **data,
+                         ushort datalen, struct packet **ack,
+                         ushort acklen, uchar **buf, uint buflen)
+{
+    int dev;
+    bool ok = TRUE;
+
+    dev = tcpAlloc();
+    if (isbadtcp(dev))
+    {
+        return SYSERR;
+    }
+    *tcbptr = &tcptab[dev - TCP0];
+    if (SYSERR == tcpBenchOpen(*tcbptr, dev))
+    {
+        ok = FALSE;
+    }
+    if (NULL != data)
+    {
+        *data = tcpBenchPkt(datalen);
+        ok = ok && (SYSERR != (int)*data);
+    }
+    if (NULL != ack)
+    {
+        *ack = tcpBenchPkt(acklen);
+        ok = ok && (SYSERR != (int)*ack);
+    }
+    if (NULL != buf)
+    {
+        *buf = memget(buflen);
+        ok = ok && (SYSERR != (int)*buf);
+    }
+
+    if (!ok)
+    {
+        tcpBenchTeardown(*tcbptr, (NULL == data) ? NULL : *data,
+                         (NULL == ack) ? NULL : *ack,
+                         (NULL == buf) ? NULL : *buf, buflen);
+        return SYSERR;
+    }
+    return dev;
+}
+
+/**
+ * Moves bulk data through an established TCB: segments in through
+ * tcpRecvData() and out through read(), then write() and the ACKs that
+ * free the output buffer.  The remote address is not IPv4, so the
+ * segments and ACKs the TCB sends are dropped by ipv4Send().
+ * @return FALSE if the data did not come out as it went in
+ */
+static bool tcpBenchBulk(bool verbose)
+{
+    struct tcb *tcbptr;
+    struct packet *data, *ack;
+    struct tcpPkt *tcp;
+    uchar *buf;
+    ulong start, rcycles, scycles;
+    bool passed = TRUE;
+    int dev;
+    int i;
+
+    dev = tcpBenchSetup(&tcbptr, &data, TCP_BENCH_SEG, &ack, 0, &buf,
+                        TCP_BENCH_SEG);
+    if (SYSERR == dev)
+    {
+        return FALSE;
+    }
+
+    rcycles = 0;
+    scycles = 0;
+    for (i = 0; passed && (i < TCP_BENCH_NSEG); i++)
+    {
+        /* Receive a segment and read it */
+        tcp = (struct tcpPkt *)data->curr;
+        memset(tcp->data, i, TCP_BENCH_SEG);
+        start = clkcount();
+        wait(tcbptr->mutex);
+        tcp->seqnum = tcbptr->rcvnxt;
+        tcpRecvData(data, tcbptr);
+        signal(tcbptr->mutex);
+        if (TCP_BENCH_SEG != read(dev, buf, TCP_BENCH_SEG))
+        {
+            passed = FALSE;
+        }
+        rcycles += clkcount() - start;
+        if ((buf[0] != (uchar)i) || (buf[TCP_BENCH_SEG - 1] != (uchar)i))
+        {
+            passed = FALSE;
+        }
+
+        /* Write a segment and have it acknowledged */
+        start = clkcount();
+        if (TCP_BENCH_SEG != write(dev, buf, TCP_BENCH_SEG))
+        {
+            passed = FALSE;
+        }
+        wait(tcbptr->mutex);
+        tcp = (struct tcpPkt *)ack->curr;
+        tcp->seqnum = tcbptr->rcvnxt;
+        tcp->acknum = tcbptr->sndnxt;
+        tcpRecvAck(ack, tcbptr);
+        signal(tcbptr->mutex);
+        scycles += clkcount() - start;
+    }
+
+    if (verbose && passed)
+    {
+        rcycles /= TCP_BENCH_NSEG * TCP_BENCH_SEG / 1024;
+        scycles /= TCP_BENCH_NSEG * TCP_BENCH_SEG / 1024;
+        printf("\t%d byte segments: receive %lu KB/s, send %lu KB/s\r\n",
+               TCP_BENCH_SEG, platform.clkfreq / (rcycles + 1),
+               platform.clkfreq / (scycles + 1));
+    }
+
+    tcpBenchTeardown(tcbptr, data, ack, buf, TCP_BENCH_SEG);
+    return passed;
+}
+
+/**
+ * Delivers segments 2 and 3 through tcpRecvData() ahead of segment 1, then
+ * segment 1, and checks that the data reads back in sequence.
+ * @return FALSE if the hole was not filled or the data came out wrong
+ */
+static bool tcpTestReorder(void)
+{
+    struct tcb *tcbptr;
+    struct packet *pkt;
+    struct tcpPkt *tcp;
+    uchar *buf;
+    tcpseq start;
+    bool passed = TRUE;
+    int dev;
+    int i, seg;
+
+    dev = tcpBenchSetup(&tcbptr, &pkt, TCP_BENCH_SEG, NULL, 0, &buf,
+                        3 * TCP_BENCH_SEG);
+    if (SYSERR == dev)
+    {
+        return FALSE;
+    }
+
+    /* Segments 2 and 3 are held as one range past the hole */
+    tcp = (struct tcpPkt *)pkt->curr;
+    wait(tcbptr->mutex);
+    start = tcbptr->rcvnxt;
+    for (seg = 1; seg <= 2; seg++)
+    {
+        memset(tcp->data, seg, TCP_BENCH_SEG);
+        tcp->seqnum = start + seg * TCP_BENCH_SEG;
+        tcpRecvData(pkt, tcbptr);
+    }
+    if ((tcbptr->rcvnxt != start) || (1 != tcbptr->rcvnrange))
+    {
+        passed = FALSE;
+    }
+
+    /* Segment 1 fills the hole and pulls in the range */
+    memset(tcp->data, 0, TCP_BENCH_SEG);
+    tcp->seqnum = start;
+    tcpRecvData(pkt, tcbptr);
+    if ((tcbptr->rcvnxt != start + 3 * TCP_BENCH_SEG)
+        || (0 != tcbptr->rcvnrange))
+    {
+        passed = FALSE;
+    }
+    signal(tcbptr->mutex);
+
+    if (passed
+        && (3 * TCP_BENCH_SEG != read(dev, buf, 3 * TCP_BENCH_SEG)))
+    {
+        passed = FALSE;
+    }
+    for (i = 0; passed && (i < 3 * TCP_BENCH_SEG); i++)
+    {
+        if (buf[i] != i / TCP_BENCH_SEG)
+        {
+            passed = FALSE;
+        }
+    }
+
+    tcpBenchTeardown(tcbptr, pkt, NULL, buf, 3 * TCP_BENCH_SEG);
+    return passed;
+}
+
+#ifdef ELOOP
+/**
+ * Sends a SYN through tcpSend() to an unresolved address on the loopback
+ * interface, then feeds the copy queued on its ARP entry to tcpRecvOpts().
+ * @return FALSE if the SYN did not permit SACK or carry the MSS
+ */
+static bool tcpTestSynOpts(void)
+{
+    struct tcb *tcbptr;
+    struct netaddr mask;
+    struct netaddr remote;
+    struct arpEntry *entry;
+    struct packet *syn = NULL;
+    bool passed = TRUE;
+    int dev;
+    irqmask im;
+
+    dev = tcpAlloc();
+    if (isbadtcp(dev))
+    {
+        return FALSE;
+    }
+    tcbptr = &tcptab[dev - TCP0];
+    if ((SYSERR == tcpBenchOpen(tcbptr, dev)) || (SYSERR == open(ELOOP)))
+    {
+        tcpBenchClose(tcbptr);
+        return FALSE;
+    }
+    mask.type = NETADDR_IPv4;
+    mask.len = IPv4_ADDR_LEN;
+    mask.addr[0] = 255;
+    mask.addr[1] = 255;
+    mask.addr[2] = 255;
+    mask.addr[3] = 0;
+    testBenchAddr(&remote, 2);
+    if (SYSERR == netUp(ELOOP, &tcbptr->localip, &mask, NULL))
+    {
+        close(ELOOP);
+        tcpBenchClose(tcbptr);
+        return FALSE;
+    }
+
+    wait(tcbptr->mutex);
+    netaddrcpy(&tcbptr->remoteip, &remote);
+    tcpSend(tcbptr, TCP_CTRL_SYN, tcbptr->iss, 0, 0, 1);
+    signal(tcbptr->mutex);
+
+    /* Take the SYN from the ARP entry and drop the entry */
+    im = disable();
+    entry = arpGetEntry(&remote);
+    if (NULL != entry)
+    {
+        if (entry->npending > 0)
+        {
+            /* Keep the SYN from being freed with the entry */
+            syn = entry->pending[0];
+            entry->npending--;
+            entry->pending[0] = entry->pending[entry->npending];
+        }
+        arpFree(entry);
+    }
+    restore(im);
+    netDown(ELOOP);
+    close(ELOOP);
+
+    if (NULL == syn)
+    {
+        passed = FALSE;
+    }
+    else
+    {
+        syn->curr = syn->nethdr + IPv4_HDR_LEN;
+        wait(tcbptr->mutex);
+        tcbptr->sndmss = 0;
+        tcpRecvOpts(syn, tcbptr);
+        if (!(tcbptr->rcvflg & TCP_FLG_SACKOK)
+            || (tcbptr->sndmss != tcbptr->rcvmss))
+        {
+            passed = FALSE;
+        }
+        signal(tcbptr->mutex);
+        netFreebuf(syn);
+    }
+
+    tcpBenchClose(tcbptr);
+    return passed;
+}
+#endif /* ELOOP */
+
+/* Feeds tcpRecvAck() an ACK of acknum carrying nsack SACK blocks */
+static void tcpBenchAck(struct packet *pkt, struct tcb *tcbptr,
+                        tcpseq acknum, struct tcpRange *sack, uint nsack)
+{
+    struct tcpPkt *tcp;
+    uchar *opt;
+    uint i;
+
+    tcp = (struct tcpPkt *)pkt->curr;
+    opt = tcp->data;
+    pkt->len = TCP_HDR_LEN;
+    if (nsack > 0)
+    {
+        pkt->len += 2 + TCP_OPT_SACK_LEN + nsack * TCP_OPT_SACK_BLK;
+        *opt++ = TCP_OPT_NOP;
+        *opt++ = TCP_OPT_NOP;
+        *opt++ = TCP_OPT_SACK;
+        *opt++ = TCP_OPT_SACK_LEN + nsack * TCP_OPT_SACK_BLK;
+        for (i = 0; i < nsack; i++)
+        {
+            *opt++ = sack[i].start >> 24;
+            *opt++ = sack[i].start >> 16;
+            *opt++ = sack[i].start >> 8;
+            *opt++ = sack[i].start;
+            *opt++ = sack[i].end >> 24;
+            *opt++ = sack[i].end >> 16;
+            *opt++ = sack[i].end >> 8;
+            *opt++ = sack[i].end;
+        }
+    }
+    tcp->offset = octets2offset(pkt->len);
+    tcp->seqnum = tcbptr->rcvnxt;
+    tcp->acknum = acknum;
+    tcpRecvOpts(pkt, tcbptr);
+    tcpRecvAck(pkt, tcbptr);
+}
+
+/**
+ * Loses segments 2 and 5 of 8 and checks that duplicate ACKs start fast
+ * recovery, SACK picks the holes to retransmit, and a full ACK ends it.
+ * @return FALSE if recovery went wrong
+ */
+static bool tcpTestRecover(void)
+{
+    struct tcb *tcbptr;
+    struct packet *ack;
+    struct tcpRange sack[2];
+    uchar *buf;
+    tcpseq una;
+    uint mss;
+    uint logstart, nfast;
+    bool passed = TRUE;
+    int dev;
+    int i;
+
+    dev = tcpBenchSetup(&tcbptr, NULL, 0, &ack,
+                        2 + TCP_OPT_SACK_LEN + 2 * TCP_OPT_SACK_BLK, &buf,
+                        TCP_BENCH_SEG);
+    if (SYSERR == dev)
+    {
+        return FALSE;
+    }
+
+    /* Send eight segments at once */
+    wait(tcbptr->mutex);
+    mss = TCP_BENCH_SEG;
+    una = tcbptr->snduna;
+    tcbptr->sndmss = mss;
+    tcbptr->sndcwn = 8 * mss;
+    tcbptr->rcvflg |= TCP_FLG_SACKOK;
+    tcbptr->log = TRUE;
+    logstart = tcplognext;
+    signal(tcbptr->mutex);
+    for (i = 0; i < 8; i++)
+    {
+        write(dev, buf, TCP_BENCH_SEG);
+    }
+
+    wait(tcbptr->mutex);
+    if (tcbptr->sndnxt != una + 8 * mss)
+    {
+        passed = FALSE;
+    }
+
+    /* Segment 1 arrives, 2 is lost, 3 and 4 arrive */
+    tcpBenchAck(ack, tcbptr, una + mss, NULL, 0);
+    sack[0].start = una + 2 * mss;
+    sack[0].end = una + 4 * mss;
+    for (i = 0; i < TCP_RXT_DUPACKS; i++)
+    {
+        tcpBenchAck(ack, tcbptr, una + mss, sack, 1);
+    }
+    if (passed && (!(tcbptr->sndflg & TCP_FLG_RECOVER)
+                   || (tcbptr->sndrecover != una + 8 * mss)
+                   || (tcbptr->sndsst != 7 * mss / 2)
+                   || (tcbptr->sndrxtnxt != una + 2 * mss)))
+    {
+        passed = FALSE;
+    }
+
+    /* Segment 5 is lost and 6 arrives: the next hole goes out */
+    sack[1].start = una + 5 * mss;
+    sack[1].end = una + 6 * mss;
+    tcpBenchAck(ack, tcbptr, una + mss, sack, 2);
+    if (passed && ((tcbptr->sndrxtnxt != una + 5 * mss)
+                   || (2 != tcbptr->sndnsack)))
+    {
+        passed = FALSE;
+    }
+
+    /* Partial ACK: segment 5 was already resent, stay in recovery */
+    tcpBenchAck(ack, tcbptr, una + 4 * mss, &sack[1], 1);
+    if (passed && (!(tcbptr->sndflg & TCP_FLG_RECOVER)
+                   || (1 != tcbptr->sndnsack)
+                   || (tcbptr->sndsack[0].start != una + 5 * mss)))
+    {
+        passed = FALSE;
+    }
+
+    /* Full ACK ends recovery */
+    tcpBenchAck(ack, tcbptr, una + 8 * mss, NULL, 0);
+    if (passed && ((tcbptr->sndflg & TCP_FLG_RECOVER)
+                   || (tcbptr->sndcwn != tcbptr->sndsst)
+                   || (0 != tcbptr->sndnsack)))
+    {
+        passed = FALSE;
+    }
+
+    /* Statistics and the event log saw one recovery, resending 2 and 5 */
+    nfast = 0;
+    for (i = logstart; (i != tcplognext) && (i - logstart < TCP_LOG_LEN);
+         i++)
+    {
+        if ((tcplog[i % TCP_LOG_LEN].dev == dev)
+            && (TCP_LOG_FAST == tcplog[i % TCP_LOG_LEN].event))
+        {
+            nfast++;
+        }
+    }
+    if (passed && ((1 != tcbptr->recoveries) || (2 != tcbptr->fastsegs)
+                   || (TCP_RXT_DUPACKS + 1 != tcbptr->dupackcount)
+                   || (1 != nfast)
+                   || (TCP_LOG_ACK !=
+                       tcplog[(tcplognext - 1) % TCP_LOG_LEN].event)))
+    {
+        passed = FALSE;
+    }
+    signal(tcbptr->mutex);
+
+    tcpBenchTeardown(tcbptr, NULL, ack, buf, TCP_BENCH_SEG);
+    return passed;
+}
+/**
+ * Resizes the buffers of a connection holding data each way, and checks
+ * the data survives and a large buffer is advertised through the window
+ * scale.
+ * @return FALSE if resizing went wrong
+ */
+static bool tcpTestBuffers(void)
+{
+    struct tcb *tcbptr;
+    struct packet *data;
+    struct tcpPkt *tcp;
+    uchar *buf;
+    uint window;
+    bool passed = TRUE;
+    int dev;
+
+    dev = tcpBenchSetup(&tcbptr, &data, TCP_BENCH_SEG, NULL, 0, &buf,
+                        TCP_BENCH_SEG);
+    if (SYSERR == dev)
+    {
+        return FALSE;
+    }
+
+    /* Hold a segment each way */
+    tcp = (struct tcpPkt *)data->curr;
+    memset(tcp->data, 0xA5, TCP_BENCH_SEG);
+    memset(buf, 0x5A, TCP_BENCH_SEG);
+    wait(tcbptr->mutex);
+    tcp->seqnum = tcbptr->rcvnxt;
+    tcpRecvData(data, tcbptr);
+    signal(tcbptr->mutex);
+    write(dev, buf, TCP_BENCH_SEG);
+
+    if (((TCP_IBLEN != tcbptr->ilen) || (TCP_OBLEN != tcbptr->olen)
+            || (SYSERR != control(dev, TCP_CTRL_RCVBUF, TCP_BUFMIN - 1, 0))
+            || (OK != control(dev, TCP_CTRL_RCVBUF, 4 * TCP_IBLEN, 0))
+            || (OK != control(dev, TCP_CTRL_SNDBUF, 2 * TCP_OBLEN, 0))
+            || (4 * TCP_IBLEN != tcbptr->ilen) || tcbptr->iauto
+            || (2 * TCP_OBLEN != tcbptr->olen) || tcbptr->oauto
+            || (0 != tcbptr->ostart) || (TCP_BENCH_SEG != tcbptr->ocount)
+            || (0x5A != tcbptr->out[TCP_BENCH_SEG - 1])))
+    {
+        passed = FALSE;
+    }
+    if (passed
+        && ((TCP_BENCH_SEG != read(dev, buf, TCP_BENCH_SEG))
+            || (0xA5 != buf[0]) || (0xA5 != buf[TCP_BENCH_SEG - 1])))
+    {
+        passed = FALSE;
+    }
+
+    /* A window beyond 16 bits goes out in whole units of the scale */
+    if (passed)
+    {
+        wait(tcbptr->mutex);
+        tcbptr->rcvscale = TCP_WSCALE;
+        tcpBufResize(tcbptr, TCP_BUFMAX, 0);
+        window = tcpSendWindow(tcbptr);
+        signal(tcbptr->mutex);
+        if ((window <= TCP_MAX_WND)
+            || (0 != window % (1 << TCP_WSCALE)))
+        {
+            passed = FALSE;
+        }
+    }
+
+    tcpBenchTeardown(tcbptr, data, NULL, buf, TCP_BENCH_SEG);
+    return passed;
+}
+
+/**
+ * Checks that Nagle's algorithm holds a small write while data is in
+ * flight, that the opt-out and cork change that, and that an ACK for
+ * one segment is delayed until outbound data carries it.
+ * @return FALSE if coalescing went wrong
+ */
+static bool tcpTestCoalesce(void)
+{
+    struct tcb *tcbptr;
+    struct packet *data, *ack;
+    struct tcpPkt *tcp;
+    uchar *buf;
+    tcpseq una;
+    bool passed = TRUE;
+    int dev;
+
+    dev = tcpBenchSetup(&tcbptr, &data, TCP_BENCH_SEG, &ack, 0, &buf,
+                        TCP_BENCH_SEG);
+    if (SYSERR == dev)
+    {
+        return FALSE;
+    }
+
+    /* The first small write goes out, the second waits for its ACK */
+    wait(tcbptr->mutex);
+    tcbptr->sndmss = TCP_BENCH_SEG;
+    una = tcbptr->snduna;
+    signal(tcbptr->mutex);
+    write(dev, buf, 10);
+    write(dev, buf, 10);
+    if ((tcbptr->sndnxt != una + 10)
+        || (OK != control(dev, TCP_CTRL_NODELAY, TRUE, 0))
+        || (tcbptr->sndnxt != una + 20))
+    {
+        passed = FALSE;
+    }
+    wait(tcbptr->mutex);
+    tcpBenchAck(ack, tcbptr, una + 20, NULL, 0);
+    signal(tcbptr->mutex);
+
+    /* A cork holds even the first small write, but not a full segment */
+    if (passed)
+    {
+        control(dev, TCP_CTRL_NODELAY, FALSE, 0);
+        control(dev, TCP_CTRL_CORK, TRUE, 0);
+        write(dev, buf, 10);
+        if (tcbptr->sndnxt != una + 20)
+        {
+            passed = FALSE;
+        }
+        write(dev, buf, TCP_BENCH_SEG);
+        if (tcbptr->sndnxt != una + 20 + TCP_BENCH_SEG)
+        {
+            passed = FALSE;
+        }
+        wait(tcbptr->mutex);
+        tcpBenchAck(ack, tcbptr, una + 20 + TCP_BENCH_SEG, NULL, 0);
+        signal(tcbptr->mutex);
+        control(dev, TCP_CTRL_CORK, FALSE, 0);
+        if (tcbptr->sndnxt != una + 30 + TCP_BENCH_SEG)
+        {
+            passed = FALSE;
+        }
+    }
+
+    /* One segment in is not ACKed at once; data out carries the ACK */
+    if (passed)
+    {
+        tcp = (struct tcpPkt *)data->curr;
+        wait(tcbptr->mutex);
+        tcp->seqnum = tcbptr->rcvnxt;
+        tcpRecvData(data, tcbptr);
+        signal(tcbptr->mutex);
+        if (!(tcbptr->sndflg & TCP_FLG_DELACK)
+            || (tcpTimerRemain(tcbptr, TCP_EVT_DELACK) <= 0))
+        {
+            passed = FALSE;
+        }
+        wait(tcbptr->mutex);
+        tcpBenchAck(ack, tcbptr, una + 30 + TCP_BENCH_SEG, NULL, 0);
+        signal(tcbptr->mutex);
+        write(dev, buf, 10);
+        if ((tcbptr->sndflg & TCP_FLG_DELACK)
+            || (0 != tcpTimerRemain(tcbptr, TCP_EVT_DELACK)))
+        {
+            passed = FALSE;
+        }
+    }
+
+    tcpBenchTeardown(tcbptr, data, ack, buf, TCP_BENCH_SEG);
+    return passed;
+}
+
+/**
+ * Sends three SYNs to a listener with a backlog of two, and checks the
+ * third is dropped, and a handshake completed in a new TCB is accepted
+ * while the listener keeps listening.
+ * @return FALSE if the backlog went wrong
+ */
+static bool tcpTestBacklog(void)
+{
+    struct tcb *tcbptr, *child;
+    struct packet *syn, *ack;
+    struct tcpPkt *tcp;
+    struct netaddr src, local;
+    bool passed = TRUE;
+    int dev;
+    int i;
+
+    dev = tcpBenchSetup(&tcbptr, &syn, 0, &ack, 0, NULL, 0);
+    if (SYSERR == dev)
+    {
+        return FALSE;
+    }
+
+    /* Answers go to a remote address ipv4Send() drops */
+    src.type = NETADDR_ETHERNET;
+    src.len = IPv4_ADDR_LEN;
+    src.addr[0] = 2;
+
+    /* The third SYN finds the backlog full */
+    wait(tcbptr->mutex);
+    tcbptr->state = TCP_LISTEN;
+    tcbptr->remotept = NULL;
+    tcbptr->remoteip.type = NULL;
+    tcbptr->backlog = 2;
+    tcp = (struct tcpPkt *)syn->curr;
+    tcp->control = TCP_CTRL_SYN;
+    tcp->seqnum = 1000;
+    for (i = 0; i < 3; i++)
+    {
+        tcp->srcpt = TCP_BENCH_RPORT + i;
+        tcpRecvListen(syn, tcbptr, &src);
+    }
+    signal(tcbptr->mutex);
+    if ((TCP_LISTEN != tcbptr->state) || (2 != tcbptr->qlen)
+        || (NULL != tcpDemux(TCP_BENCH_PORT, TCP_BENCH_RPORT + 2,
+                             &tcbptr->localip, &src)))
+    {
+        passed = FALSE;
+    }
+
+    /* Complete the first handshake and accept it */
+    child = NULL;
+    if (passed)
+    {
+        child = tcpDemux(TCP_BENCH_PORT, TCP_BENCH_RPORT,
+                         &tcbptr->localip, &src);
+        if ((NULL == child) || (TCP_SYNRECV != child->state))
+        {
+            passed = FALSE;
+        }
+    }
+    if (passed)
+    {
+        tcp = (struct tcpPkt *)ack->curr;
+        wait(child->mutex);
+        tcp->srcpt = TCP_BENCH_RPORT;
+        tcp->seqnum = child->rcvnxt;
+        tcp->acknum = child->sndnxt;
+        tcpRecvOther(ack, child);
+        signal(child->mutex);
+        if ((TCP_ESTAB != child->state) || (child != tcbptr->acceptq)
+            || (child->dev != tcpAccept(tcbptr))
+            || (1 != tcbptr->qlen) || (NULL != child->listener))
+        {
+            passed = FALSE;
+        }
+    }
+
+    if (NULL != child)
+    {
+        tcpBenchClose(child);
+    }
+    /* Closing the listener frees the handshake still held */
+    netaddrcpy(&local, &tcbptr->localip);
+    tcpBenchTeardown(tcbptr, syn, ack, NULL, 0);
+    if (passed && (NULL != tcpDemux(TCP_BENCH_PORT, TCP_BENCH_RPORT + 1,
+                                    &local, &src)))
+    {
+        passed = FALSE;
+    }
+    return passed;
+}
+#endif /* NTCP */
+
+/**
+ * Tests TCP demultiplexing, reassembly, timers, loss recovery, buffer
+ * sizing, segment coalescing and the listen backlog, and times lookups
+ * and bulk transfer.
+ * @return OK when testing is complete
+ */
+thread test_tcp(bool verbose)
+{
+#if NTCP
+    bool passed = TRUE;
+    struct tcb *tab;
+    struct netaddr local;
+    struct netaddr remote;
+    struct tcpBench bench;
+    uint ntab;
+    struct tcpRange *range;
+    uint *nrange;
+    semaphore sem;
+    int i;
+
+    /* Connections, then a partial match and two listeners at the end */
+    ntab = TCP_BENCH_NCONN + 3;
+    tab = memget(ntab * sizeof(struct tcb));
+    sem = semcreate(1);
+    if ((SYSERR == (int)tab) || (SYSERR == (int)sem))
+    {
+        if (SYSERR != (int)tab)
+        {
+            memfree(tab, ntab * sizeof(struct tcb));
+        }
+        if (SYSERR != (int)sem)
+        {
+            semfree(sem);
+        }
+        testSkip(TRUE, "");
+        return OK;
+    }
+
+    testPrint(verbose, "Add connections");
+    for (i = 0; i < TCP_BENCH_NCONN; i++)
+    {
+        testBenchAddr(&remote, 0x100 + i);
+        tcpFake(&tab[i], TCP_ESTAB, TCP_BENCH_RPORT + i, &remote);
+    }
+    tcpFake(&tab[TCP_BENCH_NCONN], TCP_LISTEN, TCP_BENCH_RPORT - 1, NULL);
+    tcpFake(&tab[TCP_BENCH_NCONN + 1], TCP_LISTEN, NULL, NULL);
+    tcpFake(&tab[TCP_BENCH_NCONN + 2], TCP_LISTEN, NULL, NULL);
+    testBenchAddr(&local, 1);
+    failif((!tab[0].hashed || !tab[TCP_BENCH_NCONN + 1].hashed), "");
+
+    testPrint(verbose, "Full match");
+    for (i = 0; i < TCP_BENCH_NCONN; i++)
+    {
+        testBenchAddr(&remote, 0x100 + i);
+        if (tcpDemux(TCP_BENCH_PORT, TCP_BENCH_RPORT + i, &local, &remote)
+            != &tab[i])
+        {
+            break;
+        }
+    }
+    failif((i < TCP_BENCH_NCONN), "Connection not found");
+
+    testPrint(verbose, "Port match before listener");
+    testBenchAddr(&remote, 0x42);
+    failif((tcpDemux(TCP_BENCH_PORT, TCP_BENCH_RPORT - 1, &local, &remote)
+            != &tab[TCP_BENCH_NCONN]), "");
+
+    /* The earlier of two equal listeners wins, though later in the chain */
+    testPrint(verbose, "Listener match");
+    failif((tcpDemux(TCP_BENCH_PORT, TCP_BENCH_RPORT + TCP_BENCH_NCONN,
+                     &local, &remote) != &tab[TCP_BENCH_NCONN + 1]), "");
+
+    testPrint(verbose, "No match");
+    failif((NULL != tcpDemux(TCP_BENCH_PORT + 1, TCP_BENCH_RPORT, &local,
+                             &remote)), "");
+
+    /* Time hashed lookups against the locked scan they replace */
+    testPrint(verbose, "Match linear scan");
+    bench.tab = tab;
+    bench.ntab = ntab;
+    bench.sem = sem;
+    bench.local = &local;
+    failif(!testBenchDemux(verbose, ntab, TCP_BENCH_NCONN + 4, tcpHashed,
+                           tcpLinear, &bench),
+           "Lookup differs from linear scan");
+
+    testPrint(verbose, "Remove connections");
+    for (i = 0; i < ntab; i++)
+    {
+        tcpHashRemove(&tab[i]);
+    }
+    testBenchAddr(&remote, 0x100);
+    failif((NULL != tcpDemux(TCP_BENCH_PORT, TCP_BENCH_RPORT, &local,
+                             &remote)), "Connection left in table");
+
+    testPrint(verbose, "Out-of-order ranges");
+    range = tab[0].rcvrange;
+    nrange = &tab[0].rcvnrange;
+    *nrange = 0;
+    tcpRangeAdd(range, nrange, 100, 200);
+    tcpRangeAdd(range, nrange, 300, 400);
+    tcpRangeAdd(range, nrange, 500, 600);
+    tcpRangeAdd(range, nrange, 200, 300);
+    tcpRangeAdd(range, nrange, 50, 150);
+    failif((2 != tab[0].rcvnrange)
+           || (50 != tab[0].rcvrange[0].start)
+           || (400 != tab[0].rcvrange[0].end)
+           || (500 != tab[0].rcvrange[1].start)
+           || (600 != tab[0].rcvrange[1].end), "Ranges not merged");
+
+    testPrint(verbose, "Out-of-order range limit");
+    for (i = 2; i < TCP_NRANGE; i++)
+    {
+        tcpRangeAdd(range, nrange, 1000 * i, 1000 * i + 10);
+    }
+    failif((SYSERR != tcpRangeAdd(range, nrange, 700, 800))
+           || (OK != tcpRangeAdd(range, nrange, 600, 800))
+           || (TCP_NRANGE != tab[0].rcvnrange)
+           || (800 != tab[0].rcvrange[1].end)
+           || (seqlte(tab[0].rcvrange[TCP_NRANGE - 1].start,
+                      tab[0].rcvrange[TCP_NRANGE - 2].end)), "");
+
+    testPrint(verbose, "Timer schedule and purge");
+    memset(tab[0].events, 0, sizeof(tab[0].events));
+    i = tcptimercount;
+    tcpTimerSched(TCP_TWOMSL, &tab[0], TCP_EVT_TIMEWT);
+    tcpTimerSched(TCP_TWOMSL, &tab[0], TCP_EVT_RXT);
+    tcpTimerSched(TCP_TWOMSL / 2, &tab[0], TCP_EVT_RXT);
+    failif((i + 2 != tcptimercount)
+           || (tcpTimerRemain(&tab[0], TCP_EVT_RXT) > TCP_TWOMSL / 2)
+           || (tcpTimerRemain(&tab[0], TCP_EVT_TIMEWT) <= TCP_TWOMSL / 2)
+           || (0 != tcpTimerRemain(&tab[0], TCP_EVT_PERSIST))
+           || (SYSERR == tcpTimerPurge(&tab[0], TCP_EVT_RXT))
+           || (SYSERR != tcpTimerPurge(&tab[0], TCP_EVT_RXT))
+           || (SYSERR == tcpTimerPurge(&tab[0], NULL))
+           || (0 != tcpTimerRemain(&tab[0], TCP_EVT_TIMEWT))
+           || (i != tcptimercount), "");
+
+    semfree(sem);
+    memfree(tab, ntab * sizeof(struct tcb));
+
+    testPrint(verbose, "Out-of-order segments");
+    failif(!tcpTestReorder(), "");
+
+    testPrint(verbose, "Fast retransmit and SACK recovery");
+    failif(!tcpTestRecover(), "");
+
+#ifdef ELOOP
+    testPrint(verbose, "MSS and SACK permitted on SYN");
+    failif(!tcpTestSynOpts(), "");
+#endif
+
+    testPrint(verbose, "Buffer resize and window scale");
+    failif(!tcpTestBuffers(), "");
+
+    testPrint(verbose, "Nagle, cork and delayed ACK");
+    failif(!tcpTestCoalesce(), "");
+
+    testPrint(verbose, "Listen backlog and accept");
+    failif(!tcpTestBacklog(), "");
+
+    testPrint(verbose, "Bulk transfer");
+    failif(!tcpBenchBulk(verbose), "Data corrupted");
+
+    /* always print out the overall tests status */
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+#else /* NTCP */
+    testSkip(TRUE, "");
+#endif /* NTCP == 0 */
+    return OK;
+}
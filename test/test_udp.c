@@ -24,6 +24,12 @@ static struct packet *makePkt(ushort, ushort, struct netaddr *,
 
 #define MAX_WAIT 10
 
+#define UDP_BENCH_NSOCK   64    /**< sockets added by the benchmark      */
+#define UDP_BENCH_PORT    40000 /**< first local port of the benchmark   */
+#define UDP_BENCH_RPORT   50000 /**< first remote port of the benchmark  */
+
+static bool benchDemux(bool, struct netaddr *);
+
 #endif
 
 /**
@@ -425,6 +431,10 @@ thread test_udp(bool verbose)
            || (udppkt->len != UDP_HDR_LEN + 7)
            || (0 != strncmp((char *)udppkt->data, "passive", 7)), "");
 
+    /* Time hashed demultiplexing against the scan it replaces */
+    testPrint(verbose, "UDP Demux (64 sockets)");
+    failif(!benchDemux(verbose, &ipl), "Lookup differs from linear scan");
+
     /* Done testing, attempt to close all UDP devices (MAKE SURE BOTH
      * DEVICES ARE OPEN BEFORE YOU CLOSE THEM!!!) */
     close(UDP0);
@@ -485,4 +495,104 @@ static struct packet *makePkt(ushort localpt, ushort remotept,
 
     return pkt;
 }
+
+/* Sockets the benchmark looks up, and the local address they are on */
+struct udpBench
+{
+    struct udp *tab;
+    struct netaddr *local;
+};
+
+/* Benchmark keys map to ports: odd keys to a listener of their own, even
+ * ones to a socket connected on the shared local port */
+#define udpBenchPort(key) \
+    (((key) & 1) ? UDP_BENCH_PORT + (key) : UDP_BENCH_PORT)
+
+static void *benchHashed(void *ctx, uint key, struct netaddr *remote)
+{
+    struct udpBench *bench = ctx;
+
+    return udpDemux(udpBenchPort(key), UDP_BENCH_RPORT + key, bench->local,
+                    remote);
+}
+
+/* Reference lookup: the linear scan udpDemux() used to do */
+static void *benchLinear(void *ctx, uint key, struct netaddr *remote)
+{
+    struct udpBench *bench = ctx;
+    struct udp *tab = bench->tab;
+    struct udp *udpptr = NULL;
+    ushort dstpt = udpBenchPort(key);
+    ushort srcpt = UDP_BENCH_RPORT + key;
+    uint i;
+    uint match = 0;
+
+    for (i = 0; i < UDP_BENCH_NSOCK; i++)
+    {
+        if ((tab[i].state == UDP_FREE)
+            || !netaddrequal(&tab[i].localip, bench->local))
+        {
+            continue;
+        }
+        if ((tab[i].localpt == dstpt) && (tab[i].remotept == srcpt)
+            && netaddrequal(&tab[i].remoteip, remote))
+        {
+            return &tab[i];
+        }
+        if (match < 2 && (tab[i].localpt == dstpt)
+            && (tab[i].remotept == srcpt) && (tab[i].remoteip.type == NULL))
+        {
+            udpptr = &tab[i];
+            match = 2;
+        }
+        if (match < 1 && (tab[i].localpt == dstpt)
+            && (tab[i].remotept == NULL) && (tab[i].remoteip.type == NULL))
+        {
+            udpptr = &tab[i];
+            match = 1;
+        }
+    }
+    return udpptr;
+}
+
+/* Half the sockets are connected to one remote endpoint on a shared local
+ * port, the rest listen on a port of their own */
+static bool benchDemux(bool verbose, struct netaddr *local)
+{
+    struct udpBench bench;
+    struct udp *tab;
+    bool match;
+    int i;
+
+    tab = memget(UDP_BENCH_NSOCK * sizeof(struct udp));
+    if (SYSERR == (int)tab)
+    {
+        return FALSE;
+    }
+    for (i = 0; i < UDP_BENCH_NSOCK; i++)
+    {
+        bzero(&tab[i], sizeof(struct udp));
+        tab[i].state = UDP_OPEN;
+        netaddrcpy(&tab[i].localip, local);
+        tab[i].localpt = udpBenchPort(i);
+        if (!(i & 1))
+        {
+            tab[i].remotept = UDP_BENCH_RPORT + i;
+            testBenchAddr(&tab[i].remoteip, 0x100 + i);
+        }
+        udpHashInsert(&tab[i]);
+    }
+
+    bench.tab = tab;
+    bench.local = local;
+    match = testBenchDemux(verbose, UDP_BENCH_NSOCK, UDP_BENCH_NSOCK + 2,
+                           benchHashed, benchLinear, &bench);
+
+    for (i = 0; i < UDP_BENCH_NSOCK; i++)
+    {
+        udpHashRemove(&tab[i]);
+    }
+    memfree(tab, UDP_BENCH_NSOCK * sizeof(struct udp));
+    return match;
+}
 #endif  /* UDP1 */
@@ -0,0 +1,89 @@
+/**
+ * @file testbench.c
+ * Helpers shared by the demultiplexing benchmarks of the network tests.
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
+
+#include <stddef.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <ipv4.h>
+#include <network.h>
+#include <platform.h>
+#include <stdio.h>
+#include <testsuite.h>
+
+#define TEST_BENCH_NLOOKUP 4096 /**< lookups timed by testBenchDemux()   */
+
+/**
+ * Builds a benchmark address.  Addresses are drawn from 198.18.0.0/15,
+ * reserved for benchmarking.
+ * @param addr address to fill in
+ * @param key low 16 bits of the address
+ */
+void testBenchAddr(struct netaddr *addr, uint key)
+{
+    addr->type = NETADDR_IPv4;
+    addr->len = IPv4_ADDR_LEN;
+    addr->addr[0] = 198;
+    addr->addr[1] = 18;
+    addr->addr[2] = key >> 8;
+    addr->addr[3] = key;
+}
+
+/**
+ * Times a hashed demultiplexing lookup against the linear scan it
+ * replaced.  Keys are drawn at random below nkey; each key is looked up
+ * both ways, from the remote address testBenchAddr() builds for 0x100 plus
+ * the key.
+ * @param verbose print the timings
+ * @param nentry number of entries in the tables, for the report
+ * @param nkey number of keys
+ * @param hashed hashed lookup
+ * @param linear linear scan
+ * @param ctx passed to both lookups
+ * @return FALSE if the lookups ever returned different entries
+ */
+bool testBenchDemux(bool verbose, uint nentry, uint nkey,
+                    testlookup hashed, testlookup linear, void *ctx)
+{
+    struct netaddr remote;
+    ulong start, cycles, lcycles;
+    uint seed, key;
+    bool match = TRUE;
+    int i;
+    irqmask im;
+
+    cycles = 0;
+    lcycles = 0;
+    seed = 1;
+    for (i = 0; i < TEST_BENCH_NLOOKUP; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        key = (seed >> 16) % nkey;
+        testBenchAddr(&remote, 0x100 + key);
+
+        im = disable();
+        if ((*hashed) (ctx, key, &remote) != (*linear) (ctx, key, &remote))
+        {
+            match = FALSE;
+        }
+        start = clkcount();
+        (*hashed) (ctx, key, &remote);
+        cycles += clkcount() - start;
+        start = clkcount();
+        (*linear) (ctx, key, &remote);
+        lcycles += clkcount() - start;
+        restore(im);
+    }
+    if (verbose)
+    {
+        printf("\t%u sockets: %lu cycles/lookup hashed, %lu linear\r\n",
+               nentry, cycles / TEST_BENCH_NLOOKUP,
+               lcycles / TEST_BENCH_NLOOKUP);
+        printf("\t%lu lookups/sec\r\n",
+               platform.clkfreq / (cycles / TEST_BENCH_NLOOKUP + 1));
+    }
+    return match;
+}
@@ -35,6 +35,8 @@ struct testcase testtab[] = {
     {"UDP Sockets", test_udp},
     {"Raw Sockets", test_raw},
     {"IP", test_ip},
+    {"Routing", test_route},
+    {"TCP", test_tcp},
     {"User Memory", test_umemory},
     {"Simple TLB", test_tlb},
 };